@@ -0,0 +1,53 @@
+// Table-driven CRC-16 (one lookup per byte) against the bit-serial form it
+// replaced, at the telegram lengths the receiver sees.
+
+#include "bench_util.h"
+#include "crc_reference.h"
+#include "wmbus_crypto.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::report_per_telegram;
+
+namespace {
+
+std::vector<uint8_t> make_data(size_t length) {
+  std::vector<uint8_t> data(length);
+  for (size_t i = 0; i < length; i++) {
+    data[i] = static_cast<uint8_t>(i * 73 + 5);
+  }
+  return data;
+}
+
+void BM_CrcTable(benchmark::State &state) {
+  std::vector<uint8_t> data = make_data(state.range(0));
+  auto step = [&] {
+    benchmark::DoNotOptimize(data.data());
+    benchmark::DoNotOptimize(WMBusCrypto::calculate_crc(data.data(), static_cast<uint8_t>(data.size())));
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+void BM_CrcBitSerial(benchmark::State &state) {
+  std::vector<uint8_t> data = make_data(state.range(0));
+  auto step = [&] {
+    benchmark::DoNotOptimize(data.data());
+    benchmark::DoNotOptimize(wmbus_host::crc_bit_serial(data.data(), data.size()));
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+// CRC'd bytes of a compact and a long telegram, and the largest frame
+BENCHMARK(BM_CrcTable)->ArgName("bytes")->Arg(36)->Arg(43)->Arg(254);
+BENCHMARK(BM_CrcBitSerial)->ArgName("bytes")->Arg(36)->Arg(43)->Arg(254);
+
+}  // namespace
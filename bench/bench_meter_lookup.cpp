@@ -0,0 +1,63 @@
+// Meter ID lookup as find_meter_() does it, for the table size this
+// executable was built with (MULTICAL21_WMBUS_METER_COUNT/_IDS, set by
+// CMake; one executable per size since the table is a compile-time constant).
+
+#include "bench_util.h"
+#include "wmbus_meter_table.h"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::report_per_telegram;
+
+namespace {
+
+// A-fields in telegram byte order: every configured meter, then a foreign one
+struct AField {
+  uint8_t bytes[4];
+};
+
+AField a_field(uint32_t meter_id) {
+  return {{static_cast<uint8_t>(meter_id), static_cast<uint8_t>(meter_id >> 8), static_cast<uint8_t>(meter_id >> 16),
+           static_cast<uint8_t>(meter_id >> 24)}};
+}
+
+void BM_MeterLookupHit(benchmark::State &state) {
+  AField fields[METER_COUNT];
+  for (size_t i = 0; i < METER_COUNT; i++) {
+    fields[i] = a_field(METER_IDS[i]);
+  }
+  size_t next = 0;
+  auto step = [&] {
+    benchmark::DoNotOptimize(fields);
+    int index = find_meter_index(meter_id_from_le(fields[next].bytes));
+    benchmark::DoNotOptimize(index);
+    next = next + 1 == METER_COUNT ? 0 : next + 1;
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.counters["meters"] = METER_COUNT;
+}
+
+void BM_MeterLookupMiss(benchmark::State &state) {
+  // Between the first two IDs, or above the only one
+  AField field = a_field(METER_IDS[0] + 1);
+  auto step = [&] {
+    benchmark::DoNotOptimize(field);
+    int index = find_meter_index(meter_id_from_le(field.bytes));
+    benchmark::DoNotOptimize(index);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.counters["meters"] = METER_COUNT;
+}
+
+const std::string SUFFIX = "/meters:" + std::to_string(METER_COUNT);
+const auto *hit = benchmark::RegisterBenchmark(("BM_MeterLookupHit" + SUFFIX).c_str(), BM_MeterLookupHit);
+const auto *miss = benchmark::RegisterBenchmark(("BM_MeterLookupMiss" + SUFFIX).c_str(), BM_MeterLookupMiss);
+
+}  // namespace
@@ -0,0 +1,70 @@
+// Packet ring hand-over with copies (fill a local packet, push(), pop() into
+// another) against the in-place path the receiver uses (reserve()/commit(),
+// peek()/release()). The "FIFO" is a plain array standing in for the SPI read.
+
+#include "bench_util.h"
+#include "wmbus_packet_buffer.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::report_per_telegram;
+
+namespace {
+
+uint8_t fifo[MAX_PACKET_SIZE + 1];
+
+uint32_t consume(const PacketBuffer &packet) { return packet.data[0] + packet.data[packet.length - 1]; }
+
+void BM_RingCopy(benchmark::State &state) {
+  uint16_t length = static_cast<uint16_t>(state.range(0));
+  WMBusPacketBuffer<> ring;
+  auto step = [&] {
+    PacketBuffer in;
+    memcpy(in.data, fifo, length);
+    in.length = length;
+    in.timestamp = 0;
+    in.rssi_dbm = -70;
+    in.lqi = 10;
+    in.radio_crc_ok = true;
+    in.verdict = DecodeVerdict::NONE;
+    in.valid = true;
+    ring.push(in);
+
+    PacketBuffer out;
+    ring.pop(out);
+    benchmark::DoNotOptimize(consume(out));
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+
+void BM_RingInPlace(benchmark::State &state) {
+  uint16_t length = static_cast<uint16_t>(state.range(0));
+  WMBusPacketBuffer<> ring;
+  auto step = [&] {
+    PacketBuffer *slot = ring.reserve();
+    memcpy(slot->data, fifo, length);
+    slot->rssi_dbm = -70;
+    slot->lqi = 10;
+    slot->radio_crc_ok = true;
+    slot->verdict = DecodeVerdict::NONE;
+    ring.commit(length, 0);
+
+    const PacketBuffer *packet = ring.peek();
+    benchmark::DoNotOptimize(consume(*packet));
+    ring.release();
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+
+// Compact and long telegrams, and a full-size slot
+BENCHMARK(BM_RingCopy)->ArgName("bytes")->Arg(38)->Arg(45)->Arg(MAX_PACKET_SIZE + 1);
+BENCHMARK(BM_RingInPlace)->ArgName("bytes")->Arg(38)->Arg(45)->Arg(MAX_PACKET_SIZE + 1);
+
+}  // namespace
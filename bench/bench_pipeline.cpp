@@ -0,0 +1,159 @@
+// Per-telegram cost of each receive stage on the host: CRC, AES-CTR
+// decryption, parsing, the packet ring, and all of them in a row.
+
+#include "bench_util.h"
+#include "test_telegram.h"
+#include "wmbus_crypto.h"
+#include "wmbus_packet_buffer.h"
+#include "wmbus_packet_parser.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::report_per_telegram;
+
+namespace {
+
+struct Telegram {
+  uint8_t frame[MAX_PACKET_SIZE + 1];
+  uint8_t l_field;
+};
+
+Telegram make_telegram(bool long_frame, uint8_t access_number = 0x42) {
+  Telegram telegram{};
+  wmbus_host::TestReading reading;
+  reading.long_frame = long_frame;
+  telegram.l_field = static_cast<uint8_t>(
+      wmbus_host::build_telegram(telegram.frame, wmbus_host::TEST_METER_ID, access_number, reading) - 1);
+  return telegram;
+}
+
+void BM_Crc(benchmark::State &state) {
+  Telegram telegram = make_telegram(state.range(0) != 0);
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.frame);
+    benchmark::DoNotOptimize(WMBusCrypto::calculate_crc(telegram.frame, telegram.l_field - 1));
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+BENCHMARK(BM_Crc)->ArgName("long")->Arg(0)->Arg(1);
+
+void BM_DecryptCtr(benchmark::State &state) {
+  Telegram telegram = make_telegram(state.range(0) != 0);
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length = 0;
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.frame);
+    crypto.decrypt_packet(telegram.frame, telegram.l_field, plaintext, plaintext_length);
+    benchmark::DoNotOptimize(plaintext);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+BENCHMARK(BM_DecryptCtr)->ArgName("long")->Arg(0)->Arg(1);
+
+// Decrypt from a keystream predicted and precomputed from the previous telegram
+void BM_DecryptKeystreamHit(benchmark::State &state) {
+  Telegram previous = make_telegram(false, 0x41);
+  Telegram telegram = make_telegram(false, 0x42);
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  crypto.predict_next(previous.frame);
+  crypto.precompute_keystream();
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length = 0;
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.frame);
+    crypto.decrypt_packet(telegram.frame, telegram.l_field, plaintext, plaintext_length);
+    benchmark::DoNotOptimize(plaintext);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  if (crypto.get_keystream_misses() != 0) {
+    state.SkipWithError("telegram missed the precomputed keystream");
+  }
+}
+BENCHMARK(BM_DecryptKeystreamHit);
+
+void BM_Parse(benchmark::State &state) {
+  Telegram telegram = make_telegram(state.range(0) != 0);
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length = 0;
+  crypto.decrypt_packet(telegram.frame, telegram.l_field, plaintext, plaintext_length);
+  WMBusPacketParser parser;
+  auto step = [&] {
+    benchmark::DoNotOptimize(plaintext);
+    WMBusMeterData data = parser.parse(plaintext, plaintext_length);
+    benchmark::DoNotOptimize(data);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+BENCHMARK(BM_Parse)->ArgName("long")->Arg(0)->Arg(1);
+
+void BM_RingPushPop(benchmark::State &state) {
+  Telegram telegram = make_telegram(false);
+  PacketBuffer in{};
+  memcpy(in.data, telegram.frame, telegram.l_field + 1);
+  in.length = telegram.l_field + 1;
+  in.valid = true;
+  PacketBuffer out{};
+  WMBusPacketBuffer<> ring;
+  auto step = [&] {
+    ring.push(in);
+    ring.pop(out);
+    benchmark::DoNotOptimize(out);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+BENCHMARK(BM_RingPushPop);
+
+// The loop() path for one telegram: ring, CRC, decrypt, parse
+void BM_Telegram(benchmark::State &state) {
+  Telegram telegram = make_telegram(state.range(0) != 0);
+  PacketBuffer in{};
+  memcpy(in.data, telegram.frame, telegram.l_field + 1);
+  in.length = telegram.l_field + 1;
+  in.valid = true;
+  WMBusPacketBuffer<> ring;
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  WMBusPacketParser parser;
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length = 0;
+  auto step = [&] {
+    ring.push(in);
+    const PacketBuffer *pkt = ring.peek();
+    uint8_t length = pkt->data[0];
+    uint16_t crc = (pkt->data[length - 1] << 8) | pkt->data[length];
+    bool ok = WMBusCrypto::calculate_crc(pkt->data, length - 1) == crc &&
+              crypto.decrypt_packet(pkt->data, length, plaintext, plaintext_length);
+    WMBusMeterData data = parser.parse(plaintext, plaintext_length);
+    ring.release();
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(data);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+}
+BENCHMARK(BM_Telegram)->ArgName("long")->Arg(0)->Arg(1);
+
+}  // namespace
@@ -0,0 +1,89 @@
+// Mode T1 decoding throughput: the 4096-entry table decoder against the
+// per-symbol bit-serial reference, and Frame Format A checking. Line rate
+// is 100 kcps / 12 chips per byte = 8.3 kB/s of decoded data.
+
+#include "bench_util.h"
+#include "test_telegram.h"
+#include "three_of_six_reference.h"
+#include "wmbus_t1_decoder.h"
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::report_per_telegram;
+
+namespace {
+
+// A long Multical21 telegram sent in T1: Frame Format A blocks, then chips
+struct T1Telegram {
+  uint8_t frame[WMBusT1Decoder::frame_size(MAX_PACKET_SIZE)];
+  uint8_t raw[WMBusT1Decoder::encoded_size(sizeof(frame))];
+  uint16_t size;
+};
+
+T1Telegram make_t1_telegram() {
+  T1Telegram telegram{};
+  wmbus_host::TestReading reading;
+  reading.long_frame = true;
+  uint8_t data[MAX_PACKET_SIZE + 1];
+  wmbus_host::build_telegram(data, wmbus_host::TEST_METER_ID, 0x21, reading);
+  data[0] = static_cast<uint8_t>(data[0] - CRC_SIZE);
+  wmbus_host::build_frame_a(data, telegram.frame);
+  telegram.size = WMBusT1Decoder::frame_size(data[0]);
+  wmbus_host::encode_3of6(telegram.frame, telegram.size, telegram.raw);
+  return telegram;
+}
+
+void BM_T1DecodeTable(benchmark::State &state) {
+  T1Telegram telegram = make_t1_telegram();
+  uint8_t out[sizeof(telegram.frame)];
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.raw);
+    benchmark::DoNotOptimize(WMBusT1Decoder::decode(telegram.raw, out, telegram.size));
+    benchmark::DoNotOptimize(out);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.SetBytesProcessed(state.iterations() * telegram.size);
+}
+BENCHMARK(BM_T1DecodeTable);
+
+void BM_T1DecodeBitSerial(benchmark::State &state) {
+  T1Telegram telegram = make_t1_telegram();
+  uint8_t out[sizeof(telegram.frame)];
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.raw);
+    benchmark::DoNotOptimize(wmbus_host::decode_3of6_bit_serial(telegram.raw, out, telegram.size));
+    benchmark::DoNotOptimize(out);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.SetBytesProcessed(state.iterations() * telegram.size);
+}
+BENCHMARK(BM_T1DecodeBitSerial);
+
+// What decode_t1_packet_() does: decode, check every block CRC, re-pack
+void BM_T1Telegram(benchmark::State &state) {
+  T1Telegram telegram = make_t1_telegram();
+  uint8_t decoded[sizeof(telegram.frame)];
+  uint8_t packet[MAX_PACKET_SIZE + 1];
+  auto step = [&] {
+    benchmark::DoNotOptimize(telegram.raw);
+    bool ok = WMBusT1Decoder::decode(telegram.raw, decoded, telegram.size) &&
+              WMBusT1Decoder::check_frame_a(decoded, packet, sizeof(packet));
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(packet);
+  };
+  for (auto _ : state) {
+    step();
+  }
+  report_per_telegram(state, step);
+  state.SetBytesProcessed(state.iterations() * telegram.size);
+}
+BENCHMARK(BM_T1Telegram);
+
+}  // namespace
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "alloc_counter.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+namespace wmbus_host {
+
+/// Extra runs after the timing loop that heap allocations are counted over
+constexpr int ALLOCATION_PROBE_RUNS = 1000;
+
+/**
+ * @brief Per-telegram counters for a benchmark whose iterations each handle one telegram
+ *
+ * Time per iteration is then ns/telegram. Adds telegrams/s and
+ * allocs_per_telegram; the latter is counted over separate runs of step so
+ * the framework's own allocations do not show up.
+ *
+ * @param state Benchmark state after the timing loop
+ * @param step The work of one iteration
+ */
+template<typename Step> void report_per_telegram(benchmark::State &state, Step &&step) {
+  state.SetItemsProcessed(state.iterations());
+  uint64_t before = allocation_count();
+  for (int i = 0; i < ALLOCATION_PROBE_RUNS; i++) {
+    step();
+  }
+  state.counters["allocs_per_telegram"] =
+      static_cast<double>(allocation_count() - before) / ALLOCATION_PROBE_RUNS;
+}
+
+}  // namespace wmbus_host
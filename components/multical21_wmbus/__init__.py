@@ -7,3 +7,4 @@ multical21_wmbus_ns = cg.esphome_ns.namespace("multical21_wmbus")
 Multical21WMBusComponent = multical21_wmbus_ns.class_(
     "Multical21WMBusComponent", cg.PollingComponent, spi.SPIDevice
 )
+WMBusMeter = multical21_wmbus_ns.class_("WMBusMeter")
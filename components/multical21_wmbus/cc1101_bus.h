@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief SPI transport used by CC1101Radio
+ *
+ * The radio driver only needs chip select and byte/array transfers. Keeping
+ * that behind this interface decouples CC1101Radio from the ESPHome component
+ * and lets a simulated CC1101 (register file, MARCSTATE, RX FIFO) stand in for
+ * the real chip.
+ *
+ * Implemented by Multical21WMBusComponent on top of spi::SPIDevice.
+ */
+class CC1101Bus {
+ public:
+  virtual ~CC1101Bus() = default;
+
+  /// Assert CS (start of one SPI transaction)
+  virtual void cc1101_select() = 0;
+
+  /// Release CS (end of transaction)
+  virtual void cc1101_deselect() = 0;
+
+  /// Send one byte (header, register value or strobe)
+  virtual void cc1101_write_byte(uint8_t data) = 0;
+
+  /// Clock in one byte
+  virtual uint8_t cc1101_read_byte() = 0;
+
+  /// Clock in a burst of bytes
+  virtual void cc1101_read_array(uint8_t *data, size_t length) = 0;
+
+  /// Send a burst of bytes
+  virtual void cc1101_write_array(const uint8_t *data, size_t length) = 0;
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
@@ -1,7 +1,7 @@
 #include "cc1101_radio.h"
-#include "multical21_wmbus.h"
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
+#include <cstring>
 
 namespace esphome {
 namespace multical21_wmbus {
@@ -58,13 +58,57 @@ static const CC1101Config CC1101_REGISTERS[] = {
     {0x2E, 0x09},  // TEST0: Various test settings
 };
 
+// Power-on values of all configuration registers (CC1101 datasheet table 43).
+// The profile is laid over these so registers it does not set are restored
+// too when the whole image is burst-written without a reset.
+static const uint8_t CC1101_RESET_VALUES[CC1101_CONFIG_REGISTER_COUNT] = {
+    0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04,  // 0x00-0x07
+    0x45, 0x00, 0x00, 0x0F, 0x00, 0x1E, 0xC4, 0xEC,  // 0x08-0x0F
+    0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,  // 0x10-0x17
+    0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B,  // 0x18-0x1F
+    0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41,  // 0x20-0x27
+    0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B,        // 0x28-0x2E
+};
+
 // ============================================================================
 // Initialization
 // ============================================================================
 
-void CC1101Radio::init(Multical21WMBusComponent *component) {
-  this->component_ = component;
-  ESP_LOGD(RADIO_TAG, "CC1101Radio initialized with parent component");
+void CC1101Radio::init(CC1101Bus *bus) {
+  this->bus_ = bus;
+  ESP_LOGD(RADIO_TAG, "CC1101Radio initialized with SPI bus");
+}
+
+bool CC1101Radio::begin() {
+  this->boot_started_us_ = micros();
+  this->build_profile_();
+
+  uint8_t registers[CC1101_CONFIG_REGISTER_COUNT];
+  this->read_registers_burst(0x00, registers, sizeof(registers));
+  if (this->profile_hash_of_(registers) != this->profile_hash_) {
+    ESP_LOGD(RADIO_TAG, "Register profile not present, configuring from scratch");
+    this->recover(true);
+    return false;
+  }
+
+  // Chip kept power and configuration: its calibration is still valid
+  this->cache_calibration_(&registers[CC1101_FSCAL3]);
+  this->fast_boot_ = true;
+  // A reboot mid-telegram may have left the length switched to fixed
+  this->length_override_ = this->fifo_streaming_;
+  ESP_LOGI(RADIO_TAG, "Register profile already in place, skipping reset and configuration");
+  this->start_rx();
+  return true;
+}
+
+bool CC1101Radio::verify_registers() {
+  uint8_t registers[CC1101_CONFIG_REGISTER_COUNT];
+  this->read_registers_burst(0x00, registers, sizeof(registers));
+  if (this->profile_hash_of_(registers) == this->profile_hash_) {
+    return true;
+  }
+  this->register_mismatches_++;
+  return false;
 }
 
 // ============================================================================
@@ -84,31 +128,44 @@ void CC1101Radio::wait_for_miso_low_() {
 }
 
 void CC1101Radio::send_strobe_(uint8_t strobe) {
-  this->component_->enable();
+  this->bus_->cc1101_select();
   delayMicroseconds(5);
   this->wait_for_miso_low_();
-  this->component_->write_byte(strobe);
+  this->bus_->cc1101_write_byte(strobe);
   delayMicroseconds(5);
-  this->component_->disable();
+  this->bus_->cc1101_deselect();
 }
 
 // ============================================================================
 // Public Hardware Interface
 // ============================================================================
 
-void CC1101Radio::reset() {
+void CC1101Radio::reset_() {
   ESP_LOGD(RADIO_TAG, "Resetting CC1101...");
 
   // Software reset - simpler and works with ESPHome's SPI abstraction
   // The hardware reset sequence requires direct pin manipulation which
   // conflicts with ESPHome's SPI driver
   this->send_strobe_(CC1101_SRES);
-  delay(10);  // Give chip time to reset
 
-  ESP_LOGD(RADIO_TAG, "CC1101 reset complete");
+  // After SRES GDO0 outputs CLK_XOSC/192 (~135 kHz). With the GDO0
+  // interrupt attached that is an interrupt storm until configure_(), so
+  // put the GDO functions back as soon as the chip takes writes again
+  // (profile_ is built by begin()). The chip ignores SPI until its reset
+  // is done, which only SO going low tells and the SPI driver does not
+  // show, so rewrite until IOCFG0 reads back.
+  const uint8_t *iocfg = &this->profile_[CC1101_IOCFG2];
+  for (uint8_t attempt = 0; attempt < RADIO_RESET_POLL_LIMIT; attempt++) {
+    delayMicroseconds(RADIO_RESET_POLL_US);
+    this->write_registers_burst(CC1101_IOCFG2, iocfg, CC1101_IOCFG0 - CC1101_IOCFG2 + 1);
+    if (this->read_register(CC1101_IOCFG0) == iocfg[CC1101_IOCFG0 - CC1101_IOCFG2]) {
+      return;
+    }
+  }
+  ESP_LOGW(RADIO_TAG, "GDO config not accepted after reset");
 }
 
-void CC1101Radio::configure() {
+void CC1101Radio::configure_() {
   ESP_LOGD(RADIO_TAG, "Configuring CC1101 registers...");
 
   // Check if CC1101 is responding by reading VERSION register
@@ -117,113 +174,451 @@ void CC1101Radio::configure() {
   ESP_LOGCONFIG(RADIO_TAG, "CC1101 PARTNUM=0x%02X, VERSION=0x%02X (expected PARTNUM=0x00, VERSION=0x04 or 0x14)",
                 partnum, version);
 
-  // Write all configuration registers
-  for (const auto &config : CC1101_REGISTERS) {
-    this->write_register(config.reg, config.value);
+  // Whole profile in one burst, verified by one burst read
+  this->build_profile_();
+  if (!this->write_profile_(this->profile_)) {
+    ESP_LOGW(RADIO_TAG, "Register profile read-back does not match");
   }
 
-  // Read back a few key registers to verify write
-  uint8_t freq2 = this->read_register(0x0D);
-  uint8_t mdmcfg2 = this->read_register(0x12);
-  ESP_LOGD(RADIO_TAG, "Verify: FREQ2=0x%02X (expect 0x21), MDMCFG2=0x%02X (expect 0x06)", freq2, mdmcfg2);
-
-  // Calibrate
+  // Calibrate - chip returns to IDLE when done, which IDLE_PENDING waits for
   this->send_strobe_(CC1101_SCAL);
-  delay(1);
 
   ESP_LOGD(RADIO_TAG, "CC1101 configuration complete");
 }
 
-void CC1101Radio::start_rx() {
-  // Note: This is called frequently (after every packet), so we keep logging minimal
-  // Only log errors, not normal operation
+void CC1101Radio::build_profile_() {
+  memcpy(this->profile_, CC1101_RESET_VALUES, sizeof(this->profile_));
+  for (const auto &config : CC1101_REGISTERS) {
+    this->profile_[config.reg] = config.value;
+  }
 
-  // Check current state before trying to change it
-  uint8_t current_state = this->read_status_register(CC1101_MARCSTATE);
-
-  // If already in overflow state (0x11), handle it specially
-  if (current_state == MARCSTATE_RXFIFO_OVERFLOW) {
-    ESP_LOGW(RADIO_TAG, "Radio in OVERFLOW state (0x11), performing IDLE->FLUSH->RX sequence");
-    // Enter IDLE first to clear overflow condition
-    this->send_strobe_(CC1101_SIDLE);
-    delay(2);
-    // Flush both RX and TX FIFOs
-    this->send_strobe_(CC1101_SFRX);
-    delay(1);
-    this->send_strobe_(CC1101_SFTX);
-    delay(1);
-    // Now can safely enter RX
-    this->send_strobe_(CC1101_SRX);
-    delay(10);
-
-    uint8_t final_state = this->read_status_register(CC1101_MARCSTATE);
-    if (final_state != MARCSTATE_RX) {
-      ESP_LOGE(RADIO_TAG, "Failed to recover from overflow! State=0x%02X", final_state);
-      this->reset();
-      this->configure();
-    }
+  if (this->continuous_rx_) {
+    // Fixed-length frames spanning the FIFO; stay in RX after each one.
+    // The chip appends RSSI and LQI to each frame, so they arrive with the
+    // FIFO burst instead of costing status register reads. GDO0 fires at
+    // the FIFO threshold, so draining starts while the frame still arrives.
+    this->profile_[CC1101_IOCFG0] = IOCFG0_RX_THRESHOLD_OR_END_INVERTED;
+    this->profile_[CC1101_FIFOTHR] = FIFOTHR_RX_32_BYTES;
+    this->profile_[CC1101_PKTLEN] = CONTINUOUS_RX_FRAME_SIZE;
+    this->profile_[CC1101_PKTCTRL1] = PKTCTRL1_APPEND_STATUS;
+    this->profile_[CC1101_PKTCTRL0] = PKTCTRL0_FIXED_LENGTH;
+    this->profile_[CC1101_MCSM1] = MCSM1_RXOFF_STAY_IN_RX;
+  }
+
+  if (this->mode_ == RadioMode::T1) {
+    // Same chip rate and sync word; the 3-out-of-6 coding is undone in software
+    this->profile_[CC1101_FREQ2] = T1_FREQ2;
+    this->profile_[CC1101_FREQ1] = T1_FREQ1;
+    this->profile_[CC1101_FREQ0] = T1_FREQ0;
+  }
+
+  if (this->fifo_streaming_) {
+    // Threshold interrupt on GDO2; packets start in infinite length mode
+    // and are switched to fixed length once the L-field is read
+    this->profile_[CC1101_IOCFG2] = IOCFG2_RX_FIFO_THRESHOLD;
+    this->profile_[CC1101_FIFOTHR] = FIFOTHR_RX_32_BYTES;
+  }
+
+  this->profile_hash_ = this->profile_hash_of_(this->profile_);
+}
+
+uint32_t CC1101Radio::profile_hash_of_(const uint8_t *registers) const {
+  uint8_t image[CC1101_CONFIG_REGISTER_COUNT];
+  memcpy(image, registers, sizeof(image));
+  image[CC1101_FSCAL3] = 0;
+  image[CC1101_FSCAL2] = 0;
+  image[CC1101_FSCAL1] = 0;
+  if (this->autocal_restore_pending_ &&
+      image[CC1101_MCSM0] == (this->profile_[CC1101_MCSM0] & ~MCSM0_FS_AUTOCAL_MASK)) {
+    image[CC1101_MCSM0] = this->profile_[CC1101_MCSM0];
+  }
+  if (this->fifo_streaming_) {
+    // Packet length is set per telegram while streaming
+    image[CC1101_PKTLEN] = this->profile_[CC1101_PKTLEN];
+    image[CC1101_PKTCTRL0] = this->profile_[CC1101_PKTCTRL0];
+  }
+  return hash_registers(image, sizeof(image));
+}
+
+bool CC1101Radio::write_profile_(const uint8_t *image) {
+  this->write_registers_burst(0x00, image, CC1101_CONFIG_REGISTER_COUNT);
+
+  uint8_t readback[CC1101_CONFIG_REGISTER_COUNT];
+  this->read_registers_burst(0x00, readback, sizeof(readback));
+  if (hash_registers(readback, sizeof(readback)) != hash_registers(image, CC1101_CONFIG_REGISTER_COUNT)) {
+    this->verify_failures_++;
+    return false;
+  }
+  return true;
+}
+
+uint32_t CC1101Radio::hash_registers(const uint8_t *registers, size_t count) {
+  uint32_t hash = 2166136261u;  // FNV-1a offset basis
+  for (size_t i = 0; i < count; i++) {
+    hash ^= registers[i];
+    hash *= 16777619u;  // FNV prime
+  }
+  return hash;
+}
+
+// ============================================================================
+// Recovery
+// ============================================================================
+
+const char *CC1101Radio::recovery_kind_to_string(RecoveryKind kind) {
+  switch (kind) {
+    case RecoveryKind::WARM:
+      return "warm";
+    case RecoveryKind::COLD:
+      return "cold";
+    default:
+      return "none";
+  }
+}
+
+bool CC1101Radio::warm_restart_() {
+  uint32_t start_us = micros();
+
+  // Registers may only be written in IDLE
+  if (!this->enter_idle()) {
+    return false;
+  }
+
+  // Profile with the calibration results instead of the SCAL start values.
+  // Auto-calibration is off for the SRX that follows, so RX starts on the
+  // restored values; the profile's MCSM0 is written back at the next IDLE.
+  uint8_t image[CC1101_CONFIG_REGISTER_COUNT];
+  memcpy(image, this->profile_, sizeof(image));
+  const uint8_t *fscal = this->fscal_cache_[static_cast<uint8_t>(this->mode_)];
+  image[CC1101_FSCAL3] = fscal[0];
+  image[CC1101_FSCAL2] = fscal[1];
+  image[CC1101_FSCAL1] = fscal[2];
+  image[CC1101_MCSM0] &= ~MCSM0_FS_AUTOCAL_MASK;
+  if (!this->write_profile_(image)) {
+    return false;
+  }
+
+  this->last_warm_config_us_ = micros() - start_us;
+  return true;
+}
+
+void CC1101Radio::cache_calibration_(const uint8_t *fscal) {
+  uint8_t mode = static_cast<uint8_t>(this->mode_);
+  memcpy(this->fscal_cache_[mode], fscal, sizeof(this->fscal_cache_[mode]));
+  this->calibration_cached_[mode] = true;
+}
+
+void CC1101Radio::finish_recovery_() {
+  if (this->recovery_kind_ == RecoveryKind::NONE) {
     return;
   }
+  RecoveryKind kind = this->recovery_kind_;
+  this->recovery_kind_ = RecoveryKind::NONE;
+  this->last_recovery_kind_ = kind;
+  this->last_recovery_us_[static_cast<uint8_t>(kind)] = this->last_rx_start_us_;
+
+  if (kind == RecoveryKind::COLD) {
+    // Fresh calibration from SCAL and the SRX auto-calibration
+    uint8_t fscal[3];
+    this->read_registers_burst(CC1101_FSCAL3, fscal, sizeof(fscal));
+    this->cache_calibration_(fscal);
+    ESP_LOGD(RADIO_TAG, "Calibration cached: FSCAL3=0x%02X, FSCAL2=0x%02X, FSCAL1=0x%02X", fscal[0], fscal[1],
+             fscal[2]);
+    ESP_LOGI(RADIO_TAG, "Radio recovered (cold) in %u us", (unsigned) this->last_rx_start_us_);
+  } else {
+    this->autocal_restore_pending_ = true;
+    ESP_LOGI(RADIO_TAG, "Radio recovered (warm) in %u us (profile write + verify %u us)",
+             (unsigned) this->last_rx_start_us_, (unsigned) this->last_warm_config_us_);
+  }
+}
+
+// ============================================================================
+// State Machine
+// ============================================================================
+
+const char *CC1101Radio::state_to_string(RadioState state) {
+  switch (state) {
+    case RadioState::IDLE_PENDING:
+      return "IDLE_PENDING";
+    case RadioState::FLUSHING:
+      return "FLUSHING";
+    case RadioState::RX_PENDING:
+      return "RX_PENDING";
+    case RadioState::RX:
+      return "RX";
+    case RadioState::RECOVERING:
+      return "RECOVERING";
+    case RadioState::SLEEP:
+      return "SLEEP";
+    case RadioState::WAKING:
+      return "WAKING";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+void CC1101Radio::transition_to_(RadioState state) {
+  uint32_t now = micros();
+  this->state_duration_us_[static_cast<uint8_t>(this->state_)] = now - this->state_entered_us_;
+  ESP_LOGV(RADIO_TAG, "%s -> %s after %u us", state_to_string(this->state_), state_to_string(state),
+           (unsigned) (now - this->state_entered_us_));
+
+  this->state_ = state;
+  this->state_entered_us_ = now;
+  this->state_entered_ms_ = millis();
+
+  if (state == RadioState::RX) {
+    this->last_rx_start_us_ = now - this->sequence_started_us_;
+  }
+}
+
+uint32_t CC1101Radio::state_elapsed_ms_() const {
+  return millis() - this->state_entered_ms_;
+}
 
-  // Enter IDLE state
+void CC1101Radio::start_rx() {
+  // Note: This is called frequently (after every packet), so we keep logging minimal
+  // Only log errors, not normal operation
+  //
+  // SIDLE also clears RXFIFO_OVERFLOW (0x11), so overflow needs no special case
+  this->sequence_started_us_ = micros();
   this->send_strobe_(CC1101_SIDLE);
+  this->transition_to_(RadioState::IDLE_PENDING);
+  this->tick();
+}
+
+void CC1101Radio::recover(bool force_cold) {
+  this->recovery_count_++;
+  uint32_t started_us = micros();
 
-  // Wait for IDLE state (matching working code logic)
-  uint8_t regCount = 0;
-  while (this->read_status_register(CC1101_MARCSTATE) != MARCSTATE_IDLE) {
-    if (regCount++ > 100) {
-      uint8_t stuck_state = this->read_status_register(CC1101_MARCSTATE);
-      ESP_LOGE(RADIO_TAG, "Failed to enter IDLE state! Stuck in state 0x%02X (was 0x%02X)", stuck_state, current_state);
-      // Reset and try again
-      this->reset();
-      this->configure();
+  // A recovery that did not make it back to RX escalates to a reset
+  if (this->has_calibration_cache() && !force_cold && this->recovery_kind_ == RecoveryKind::NONE) {
+    if (this->warm_restart_()) {
+      this->recovery_kind_ = RecoveryKind::WARM;
+      this->warm_recovery_count_++;
+      this->sequence_started_us_ = started_us;
       return;
     }
-    delay(1);
+    ESP_LOGW(RADIO_TAG, "Warm restart failed, resetting radio");
   }
 
-  // Flush RX FIFO - CRITICAL: Must wait for flush to complete!
-  this->send_strobe_(CC1101_SFRX);
-  delay(5);  // Give FIFO time to flush completely
-
-  // Verify FIFO is actually empty
-  uint8_t rxbytes_after_flush = this->read_status_register(CC1101_RXBYTES);
-  if ((rxbytes_after_flush & 0x7F) != 0) {
-    ESP_LOGW(RADIO_TAG, "FIFO not empty after flush! RXbytes=%u, attempting second flush", rxbytes_after_flush & 0x7F);
-    this->send_strobe_(CC1101_SFRX);
-    delay(5);
+  this->recovery_kind_ = RecoveryKind::COLD;
+  this->sequence_started_us_ = started_us;
+  this->reset_();
+  this->transition_to_(RadioState::RECOVERING);
+}
+
+void CC1101Radio::tick() {
+  while (this->step_()) {
   }
+}
 
-  // Enter RX state
-  regCount = 0;
-  this->send_strobe_(CC1101_SRX);
-  delay(10);  // Give time to enter RX mode
+bool CC1101Radio::step_() {
+  switch (this->state_) {
+    case RadioState::RX:
+    case RadioState::SLEEP:
+      return false;
 
-  // Wait for RX state with timeout
-  while (this->read_status_register(CC1101_MARCSTATE) != MARCSTATE_RX) {
-    if (regCount++ > 100) {
-      uint8_t stuck_state = this->read_status_register(CC1101_MARCSTATE);
-      ESP_LOGE(RADIO_TAG, "Failed to enter RX state! Stuck in state 0x%02X", stuck_state);
+    case RadioState::WAKING:
+      if (micros() - this->state_entered_us_ < RADIO_WAKE_SETTLE_US) {
+        return false;
+      }
+      this->send_strobe_(CC1101_SIDLE);
+      this->transition_to_(RadioState::IDLE_PENDING);
+      return true;
+
+    case RadioState::RECOVERING:
+      if (this->state_elapsed_ms_() < RADIO_RESET_SETTLE_MS) {
+        return false;
+      }
+      this->configure_();
+      this->transition_to_(RadioState::IDLE_PENDING);
+      return true;
+
+    case RadioState::IDLE_PENDING: {
+      uint8_t marcstate = this->get_marcstate();
+      if (marcstate == MARCSTATE_IDLE) {
+        if (this->waking_) {
+          // SLEEP lost the test settings; the rest of the profile survived
+          this->write_registers_burst(CC1101_TEST2, &this->profile_[CC1101_TEST2], 3);
+        }
+        if (this->autocal_restore_pending_) {
+          // First IDLE after a warm restart: calibrate on IDLE -> RX again
+          this->autocal_restore_pending_ = false;
+          this->write_register(CC1101_MCSM0, this->profile_[CC1101_MCSM0]);
+        }
+        if (this->length_override_) {
+          // Back to the profile's length mode for the next packet
+          this->length_override_ = false;
+          this->write_registers_burst(CC1101_PKTLEN, &this->profile_[CC1101_PKTLEN], 3);
+        }
+        if (this->mode_switch_pending_) {
+          this->mode_switch_pending_ = false;
+          this->apply_mode_switch_();
+        }
+        this->send_strobe_(CC1101_SFRX);
+        this->transition_to_(RadioState::FLUSHING);
+        return true;
+      }
+      if (this->state_elapsed_ms_() > RADIO_STATE_TIMEOUT_MS) {
+        ESP_LOGE(RADIO_TAG, "Failed to enter IDLE state! Stuck in state 0x%02X", marcstate);
+        this->recover();
+        return false;
+      }
+      return false;
+    }
 
-      // Check if it's an overflow condition
-      if (stuck_state == MARCSTATE_RXFIFO_OVERFLOW) {
-        ESP_LOGW(RADIO_TAG, "Detected overflow (0x11) while entering RX - need full reset");
+    case RadioState::FLUSHING: {
+      // Verify FIFO is actually empty before entering RX
+      uint8_t rxbytes = this->get_rx_bytes();
+      if (rxbytes == 0) {
+        this->send_strobe_(CC1101_SRX);
+        this->transition_to_(RadioState::RX_PENDING);
+        return true;
+      }
+      if (this->state_elapsed_ms_() > RADIO_STATE_TIMEOUT_MS) {
+        ESP_LOGE(RADIO_TAG, "FIFO not empty after flush! RXbytes=0x%02X", rxbytes);
+        this->recover();
+        return false;
       }
+      this->send_strobe_(CC1101_SFRX);
+      return false;
+    }
 
-      // Reset and try again
-      this->reset();
-      this->configure();
-      return;
+    case RadioState::RX_PENDING: {
+      // SRX includes auto-calibration (MCSM0), so this usually takes a tick or two.
+      // RXFIFO_OVERFLOW means RX was reached and a packet has already filled
+      // the FIFO (in infinite length mode the end of every packet): the
+      // component reads it like any other.
+      uint8_t marcstate = this->get_marcstate();
+      if (marcstate == MARCSTATE_RX || marcstate == MARCSTATE_RXFIFO_OVERFLOW) {
+        this->transition_to_(RadioState::RX);
+        if (this->time_to_first_rx_us_ == 0) {
+          this->time_to_first_rx_us_ = micros() - this->boot_started_us_;
+          ESP_LOGI(RADIO_TAG, "First RX %u us after bring-up (%s boot)", (unsigned) this->time_to_first_rx_us_,
+                   this->fast_boot_ ? "fast" : "cold");
+        }
+        if (this->waking_) {
+          this->waking_ = false;
+          this->last_wake_us_ = this->last_rx_start_us_;
+        }
+        if (this->calibrate_on_rx_) {
+          // First RX on this mode's frequency: keep what SRX calibrated
+          this->calibrate_on_rx_ = false;
+          uint8_t fscal[3];
+          this->read_registers_burst(CC1101_FSCAL3, fscal, sizeof(fscal));
+          this->cache_calibration_(fscal);
+        }
+        this->finish_recovery_();
+        return false;
+      }
+      if (this->state_elapsed_ms_() > RADIO_STATE_TIMEOUT_MS) {
+        ESP_LOGE(RADIO_TAG, "Failed to enter RX state! Stuck in state 0x%02X", marcstate);
+        if (marcstate == MARCSTATE_RXFIFO_OVERFLOW) {
+          ESP_LOGW(RADIO_TAG, "Detected overflow (0x11) while entering RX - need full reset");
+        }
+        this->recover();
+        return false;
+      }
+      return false;
     }
-    delay(1);
   }
-
-  // No logging here - this runs after every packet, would spam logs
+  return false;
 }
 
-void CC1101Radio::enter_idle() {
+bool CC1101Radio::enter_idle() {
+  this->sequence_started_us_ = micros();
   this->send_strobe_(CC1101_SIDLE);
-  delay(2);
+  this->transition_to_(RadioState::IDLE_PENDING);
+
+  // RX -> IDLE takes a few microseconds; bound the poll instead of sleeping
+  for (uint8_t i = 0; i < RADIO_IDLE_POLL_LIMIT; i++) {
+    if (this->get_marcstate() == MARCSTATE_IDLE) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CC1101Radio::power_down() {
+  // SPWD is only taken from IDLE
+  if (!this->enter_idle()) {
+    ESP_LOGW(RADIO_TAG, "Radio did not confirm IDLE before power-down");
+    return;  // IDLE_PENDING carries on back into RX
+  }
+  this->send_strobe_(CC1101_SPWD);
+  this->transition_to_(RadioState::SLEEP);
+  this->power_downs_++;
+}
+
+void CC1101Radio::wake() {
+  if (this->state_ != RadioState::SLEEP) {
+    return;
+  }
+  // CSn low starts the crystal; SIDLE waits until it has settled
+  this->sequence_started_us_ = micros();
+  this->waking_ = true;
+  this->bus_->cc1101_select();
+  this->bus_->cc1101_deselect();
+  this->transition_to_(RadioState::WAKING);
+}
+
+void CC1101Radio::switch_mode(RadioMode mode) {
+  if (mode == this->mode_ && !this->mode_switch_pending_) {
+    return;
+  }
+  this->pending_mode_ = mode;
+  this->mode_switch_pending_ = true;
+  this->start_rx();  // Delta is written at the IDLE on the way
+}
+
+void CC1101Radio::apply_mode_switch_() {
+  uint8_t previous[CC1101_CONFIG_REGISTER_COUNT];
+  memcpy(previous, this->profile_, sizeof(previous));
+  this->mode_ = this->pending_mode_;
+  this->build_profile_();
+
+  // One burst from the first to the last register that differs (for C1/T1
+  // FREQ2..FREQ0). Calibration registers are handled below.
+  uint8_t first = CC1101_CONFIG_REGISTER_COUNT;
+  uint8_t last = 0;
+  for (uint8_t reg = 0; reg < CC1101_CONFIG_REGISTER_COUNT; reg++) {
+    if (reg >= CC1101_FSCAL3 && reg <= CC1101_FSCAL1) {
+      continue;
+    }
+    if (previous[reg] != this->profile_[reg]) {
+      first = first < reg ? first : reg;
+      last = reg;
+    }
+  }
+  this->last_mode_delta_bytes_ = 0;
+  if (first <= last) {
+    this->last_mode_delta_bytes_ = last - first + 1;
+    this->write_registers_burst(first, &this->profile_[first], this->last_mode_delta_bytes_);
+  }
+
+  uint8_t mode = static_cast<uint8_t>(this->mode_);
+  if (this->calibration_cached_[mode]) {
+    // This frequency was calibrated before: restore it and skip the SRX
+    // calibration, as after a warm restart
+    this->write_registers_burst(CC1101_FSCAL3, this->fscal_cache_[mode], sizeof(this->fscal_cache_[mode]));
+    this->write_register(CC1101_MCSM0, this->profile_[CC1101_MCSM0] & ~MCSM0_FS_AUTOCAL_MASK);
+    this->autocal_restore_pending_ = true;
+  } else {
+    this->calibrate_on_rx_ = true;
+  }
+  this->mode_switches_++;
+}
+
+void CC1101Radio::set_fixed_length(uint8_t length) {
+  // PKTLEN, PKTCTRL1 and PKTCTRL0 are adjacent: one burst
+  uint8_t registers[3] = {
+      length,
+      this->profile_[CC1101_PKTCTRL1],
+      static_cast<uint8_t>((this->profile_[CC1101_PKTCTRL0] & ~PKTCTRL0_LENGTH_CONFIG_MASK) | PKTCTRL0_FIXED_LENGTH),
+  };
+  this->write_registers_burst(CC1101_PKTLEN, registers, sizeof(registers));
+  this->length_override_ = true;
 }
 
 void CC1101Radio::flush_rx_fifo() {
@@ -231,40 +626,68 @@ void CC1101Radio::flush_rx_fifo() {
 }
 
 void CC1101Radio::write_register(uint8_t reg, uint8_t value) {
-  this->component_->enable();
+  this->bus_->cc1101_select();
   this->wait_for_miso_low_();
-  this->component_->write_byte(reg);
-  this->component_->write_byte(value);
-  this->component_->disable();
+  this->bus_->cc1101_write_byte(reg);
+  this->bus_->cc1101_write_byte(value);
+  this->bus_->cc1101_deselect();
 }
 
 uint8_t CC1101Radio::read_register(uint8_t reg) {
-  this->component_->enable();
+  this->bus_->cc1101_select();
   this->wait_for_miso_low_();
-  this->component_->write_byte(reg | CC1101_READ_SINGLE);
-  uint8_t value = this->component_->read_byte();
-  this->component_->disable();
+  this->bus_->cc1101_write_byte(reg | CC1101_READ_SINGLE);
+  uint8_t value = this->bus_->cc1101_read_byte();
+  this->bus_->cc1101_deselect();
   return value;
 }
 
+void CC1101Radio::write_registers_burst(uint8_t reg, const uint8_t *src, uint8_t n) {
+  this->bus_->cc1101_select();
+  this->wait_for_miso_low_();
+  this->bus_->cc1101_write_byte(reg | CC1101_WRITE_BURST);
+  this->bus_->cc1101_write_array(src, n);
+  this->bus_->cc1101_deselect();
+}
+
+void CC1101Radio::read_registers_burst(uint8_t reg, uint8_t *dst, uint8_t n) {
+  this->bus_->cc1101_select();
+  this->wait_for_miso_low_();
+  this->bus_->cc1101_write_byte(reg | CC1101_READ_BURST);
+  this->bus_->cc1101_read_array(dst, n);
+  this->bus_->cc1101_deselect();
+}
+
 uint8_t CC1101Radio::read_status_register(uint8_t reg) {
-  this->component_->enable();
+  this->bus_->cc1101_select();
   this->wait_for_miso_low_();
-  this->component_->write_byte(reg | CC1101_READ_BURST);
-  uint8_t value = this->component_->read_byte();
-  this->component_->disable();
+  this->bus_->cc1101_write_byte(reg | CC1101_READ_BURST);
+  uint8_t value = this->bus_->cc1101_read_byte();
+  this->bus_->cc1101_deselect();
   return value;
 }
 
 uint8_t CC1101Radio::read_fifo_byte() {
-  this->component_->enable();
+  this->bus_->cc1101_select();
   this->wait_for_miso_low_();
-  this->component_->write_byte(CC1101_RXFIFO | CC1101_READ_SINGLE);
-  uint8_t value = this->component_->read_byte();
-  this->component_->disable();
+  this->bus_->cc1101_write_byte(CC1101_RXFIFO | CC1101_READ_SINGLE);
+  uint8_t value = this->bus_->cc1101_read_byte();
+  this->bus_->cc1101_deselect();
   return value;
 }
 
+void CC1101Radio::read_fifo_burst(uint8_t *dst, uint8_t n) {
+  if (n == 0) {
+    return;
+  }
+
+  this->bus_->cc1101_select();
+  this->wait_for_miso_low_();
+  this->bus_->cc1101_write_byte(CC1101_RXFIFO | CC1101_READ_BURST);
+  this->bus_->cc1101_read_array(dst, n);
+  this->bus_->cc1101_deselect();
+}
+
 uint8_t CC1101Radio::get_rx_bytes() {
   return this->read_status_register(CC1101_RXBYTES);
 }
@@ -278,5 +701,17 @@ bool CC1101Radio::is_overflow() {
   return (rxbytes & 0x80) != 0;  // Bit 7 indicates overflow
 }
 
+int16_t CC1101Radio::read_rssi_dbm() {
+  return rssi_to_dbm(this->read_status_register(CC1101_RSSI));
+}
+
+uint8_t CC1101Radio::read_lqi() {
+  return this->read_status_register(CC1101_LQI);
+}
+
+int16_t CC1101Radio::rssi_to_dbm(uint8_t rssi_raw) {
+  return static_cast<int8_t>(rssi_raw) / 2 - 74;
+}
+
 }  // namespace multical21_wmbus
 }  // namespace esphome
@@ -1,62 +1,337 @@
 #pragma once
 
 #include "wmbus_types.h"
+#include "cc1101_bus.h"
+#include <cstddef>
 
 namespace esphome {
 namespace multical21_wmbus {
 
-// Forward declaration to avoid circular dependency
-class Multical21WMBusComponent;
+/**
+ * @brief Driver-level radio state (not the chip's MARCSTATE)
+ *
+ * Every transition is taken from tick() once the chip reports the expected
+ * MARCSTATE/RXBYTES, or on timeout. Nothing in the driver sleeps.
+ */
+enum class RadioState : uint8_t {
+  IDLE_PENDING,  // SIDLE sent, waiting for MARCSTATE IDLE
+  FLUSHING,      // SFRX sent, waiting for empty RX FIFO
+  RX_PENDING,    // SRX sent, waiting for MARCSTATE RX
+  RX,            // Receiving (steady state)
+  RECOVERING,    // SRES sent, waiting for chip before reconfiguring
+  SLEEP,         // Powered down (SPWD) until wake()
+  WAKING,        // CSn pulsed, waiting for the crystal before SIDLE
+};
+
+constexpr uint8_t RADIO_STATE_COUNT = 7;
+
+/**
+ * @brief How the radio is being brought back after a fault
+ */
+enum class RecoveryKind : uint8_t {
+  WARM,  // Burst-write profile + cached calibration, no reset
+  COLD,  // SRES, settle, profile + SCAL calibration
+  NONE,  // No recovery in progress
+};
+
+constexpr uint8_t RECOVERY_KIND_COUNT = 2;
 
 /**
  * @brief CC1101 radio hardware abstraction layer
  *
- * Complete encapsulation of CC1101 SPI hardware interface for wMBUS Mode C reception.
+ * Complete encapsulation of CC1101 SPI hardware interface for wMBUS Mode C1/T1 reception.
  * Handles initialization, configuration, state management, and FIFO operations.
  *
+ * State changes (RX restart, recovery) are requested with start_rx()/recover()
+ * and advanced by tick() from the component's loop(), so no call blocks the
+ * ESPHome main loop for more than a few SPI transactions.
+ *
  * Responsibility: Pure hardware abstraction - no packet processing or crypto.
  * Extracted from: multical21_wmbus.cpp lines 351-482 (hardware interface section)
  */
 class CC1101Radio {
  public:
   /**
-   * @brief Initialize radio with parent component reference
+   * @brief Initialize radio with its SPI transport
    *
    * Must be called before any other operations.
    *
-   * @param component Pointer to parent Multical21WMBusComponent for SPI access
+   * @param bus SPI transport (the parent component, or a simulated device)
    */
-  void init(Multical21WMBusComponent *component);
+  void init(CC1101Bus *bus);
 
   /**
-   * @brief Reset CC1101 chip via software command
+   * @brief Bring the radio up at boot
+   *
+   * After an OTA or soft reboot the CC1101 keeps power and its registers. One
+   * burst read is hashed and compared with the profile; if it matches, the
+   * calibration found on the chip is cached and RX is started right away
+   * (IDLE → flush → RX). Only on a mismatch does a cold recovery (reset,
+   * configure, calibrate) run.
+   *
+   * @return true if the register profile was already in place
+   */
+  bool begin();
+
+  /**
+   * @brief Check that the chip still holds the register profile
+   *
+   * One burst read, hashed and compared with the profile hash. FSCAL1-3
+   * hold calibration results and are left out. Catches registers lost to a
+   * brown-out without a full rewrite.
+   *
+   * @return true if the registers match
+   */
+  bool verify_registers();
+
+  /**
+   * @brief Select continuous (stay-in-RX) reception
+   *
+   * When enabled, the register profile uses fixed-length frames of
+   * CONTINUOUS_RX_FRAME_SIZE bytes with appended RSSI/LQI status and MCSM1
+   * RXOFF_MODE=RX, so the chip returns to sync search after every telegram
+   * without IDLE, flush or recalibration. GDO0 signals the RX FIFO threshold
+   * or end of packet instead of sync/end of packet.
+   *
+   * @param continuous_rx true to stay in RX across telegrams
+   */
+  void set_continuous_rx(bool continuous_rx) { this->continuous_rx_ = continuous_rx; }
+
+  /**
+   * @brief Drive reception from the RX FIFO threshold on GDO2
    *
-   * Sends SRES strobe command and waits for chip to stabilize.
+   * GDO2 is set to assert at the FIFOTHR threshold so the FIFO can be
+   * drained while a telegram is still arriving. Takes effect at the next
+   * configuration (set before setup()).
+   */
+  void set_fifo_streaming(bool fifo_streaming) { this->fifo_streaming_ = fifo_streaming; }
+
+  /**
+   * @brief Select the wM-Bus mode (carrier frequency) of the register profile
+   *
+   * Takes effect at the next configuration (set before setup()).
+   */
+  void set_mode(RadioMode mode) { this->mode_ = mode; }
+
+  RadioMode get_mode() const { return this->mode_; }
+
+  /**
+   * @brief Move to the register profile of another mode while running
+   *
+   * Restarts reception (SIDLE → IDLE → flush → RX). At the IDLE only the
+   * registers that differ between the two profiles are written, in one
+   * burst. If the target frequency has been calibrated before, its cached
+   * FSCAL1-3 are written too and the SRX skips calibration; otherwise the
+   * SRX calibrates and the result is cached once RX is reached.
+   *
+   * @param mode Mode to receive in
+   */
+  void switch_mode(RadioMode mode);
+
+  /**
+   * @brief Number of switch_mode() calls that changed the profile
+   */
+  uint32_t get_mode_switch_count() const { return this->mode_switches_; }
+
+  /**
+   * @brief Registers written by the last mode switch, calibration excluded
    */
-  void reset();
+  uint8_t get_last_mode_delta_bytes() const { return this->last_mode_delta_bytes_; }
 
   /**
-   * @brief Configure CC1101 registers for wMBUS Mode C reception
+   * @brief End the packet being received after a given number of bytes
    *
-   * Writes all required register values for 868.95 MHz, 100 kbps, 2-FSK modulation.
-   * Performs calibration after configuration.
+   * Switches from infinite to fixed packet length mid-packet, so the radio
+   * stops (and goes IDLE) right after the last byte. Legal in RX. The
+   * profile's length mode is restored at the next IDLE.
+   *
+   * @param length Bytes after the sync word, 1..MAX_FIXED_PACKET_LENGTH
    */
-  void configure();
+  void set_fixed_length(uint8_t length);
 
   /**
    * @brief Start receiver (enter RX mode)
    *
-   * Sequence: IDLE → flush FIFO → RX mode
+   * Sequence: IDLE → flush FIFO → RX mode, driven by tick().
    * Called after every packet reception and during initialization.
+   * In continuous RX mode only used for initialization and error recovery.
    */
   void start_rx();
 
+  /**
+   * @brief Recovery: reconfigure, then start receiver
+   *
+   * Once a cold recovery has cached the FSCAL1-3 calibration results, a warm
+   * restart is tried first: SIDLE → one burst write of the register profile
+   * with the cached calibration → burst read-back verified by hash → IDLE →
+   * flush → RX. There is no reset, settle delay or calibration (SCAL, and the
+   * MCSM0 auto-calibration is held off until the next IDLE).
+   *
+   * The cold path is SRES → settle → register profile + SCAL → IDLE → flush
+   * → RX, driven by tick(). It is used for initial bring-up, when
+   * verification fails, when a warm restart does not reach RX, and when
+   * force_cold is set.
+   *
+   * @param force_cold Skip the warm restart (e.g. the last one did not help)
+   */
+  void recover(bool force_cold = false);
+
+  /**
+   * @brief Power the chip down until wake()
+   *
+   * SIDLE, then SPWD: the chip sleeps once CSn goes high, drawing about
+   * 200 nA. Registers are kept except TEST2..TEST0, which wake() restores.
+   * The calibration (FSCAL1-3) is kept, but the SRX after waking still
+   * auto-calibrates, so temperature drift during sleep is corrected.
+   */
+  void power_down();
+
+  /**
+   * @brief Bring a powered-down chip back into RX
+   *
+   * Pulses CSn to start the crystal, then continues like start_rx() once it
+   * has settled (RADIO_WAKE_SETTLE_US). The lost TEST registers are written
+   * at the IDLE on the way.
+   */
+  void wake();
+
+  /**
+   * @brief Whether the chip is powered down or waking up
+   */
+  bool is_sleeping() const { return this->state_ == RadioState::SLEEP || this->state_ == RadioState::WAKING; }
+
+  /**
+   * @brief Number of power_down() calls since boot
+   */
+  uint32_t get_power_down_count() const { return this->power_downs_; }
+
+  /**
+   * @brief Time from the last wake() until RX was confirmed
+   *
+   * @return Duration in microseconds (0 until the first wake)
+   */
+  uint32_t get_last_wake_us() const { return this->last_wake_us_; }
+
+  /**
+   * @brief Advance the radio state machine
+   *
+   * Call from every loop(). Moves through as many states as the chip allows
+   * right now and returns; waits are handled by re-checking on the next tick.
+   */
+  void tick();
+
   /**
    * @brief Enter IDLE state
    *
-   * Stops reception and allows safe register/FIFO access.
+   * Stops reception and allows safe register/FIFO access. Polls MARCSTATE a
+   * bounded number of times instead of sleeping.
+   *
+   * @return true if the chip confirmed IDLE
+   */
+  bool enter_idle();
+
+  /**
+   * @brief Get current driver state
    */
-  void enter_idle();
+  RadioState get_state() const { return this->state_; }
+
+  /**
+   * @brief Check if the receiver is confirmed in RX
+   */
+  bool is_receiving() const { return this->state_ == RadioState::RX; }
+
+  /**
+   * @brief Time spent in a state on its most recent visit
+   *
+   * @param state State to query
+   * @return Duration in microseconds
+   */
+  uint32_t get_state_duration_us(RadioState state) const {
+    return this->state_duration_us_[static_cast<uint8_t>(state)];
+  }
+
+  /**
+   * @brief Time from the last start_rx()/recover() request until RX was confirmed
+   *
+   * @return Duration in microseconds
+   */
+  uint32_t get_last_rx_start_us() const { return this->last_rx_start_us_; }
+
+  /**
+   * @brief Number of recoveries (warm and cold) since boot
+   */
+  uint32_t get_recovery_count() const { return this->recovery_count_; }
+
+  /**
+   * @brief Number of recoveries that took the warm path
+   */
+  uint32_t get_warm_recovery_count() const { return this->warm_recovery_count_; }
+
+  /**
+   * @brief Time from the most recent recovery request of a kind until RX was confirmed
+   *
+   * @param kind WARM or COLD
+   * @return Duration in microseconds (0 if none yet)
+   */
+  uint32_t get_last_recovery_us(RecoveryKind kind) const {
+    return this->last_recovery_us_[static_cast<uint8_t>(kind)];
+  }
+
+  /**
+   * @brief Profile write and verification time of the last warm restart
+   *
+   * @return Duration in microseconds (0 if none yet)
+   */
+  uint32_t get_last_warm_config_us() const { return this->last_warm_config_us_; }
+
+  /**
+   * @brief Time from begin() until RX was first confirmed
+   *
+   * @return Duration in microseconds (0 until RX is reached)
+   */
+  uint32_t get_time_to_first_rx_us() const { return this->time_to_first_rx_us_; }
+
+  /**
+   * @brief Whether begin() found the register profile already in place
+   */
+  bool is_fast_boot() const { return this->fast_boot_; }
+
+  /**
+   * @brief Number of verify_registers() calls that found a mismatch
+   */
+  uint32_t get_register_mismatch_count() const { return this->register_mismatches_; }
+
+  /**
+   * @brief Kind of the most recently completed recovery (NONE before the first)
+   */
+  RecoveryKind get_last_recovery_kind() const { return this->last_recovery_kind_; }
+
+  /**
+   * @brief Whether FSCAL1-3 from a completed calibration are cached
+   */
+  bool has_calibration_cache() const { return this->calibration_cached_[static_cast<uint8_t>(this->mode_)]; }
+
+  /**
+   * @brief Number of profile writes whose read-back hash did not match
+   */
+  uint32_t get_verify_failure_count() const { return this->verify_failures_; }
+
+  /**
+   * @brief Human-readable recovery kind for logging
+   */
+  static const char *recovery_kind_to_string(RecoveryKind kind);
+
+  /**
+   * @brief FNV-1a hash of a register image
+   *
+   * Used to verify a burst read-back against the profile in one comparison.
+   */
+  static uint32_t hash_registers(const uint8_t *registers, size_t count);
+
+  /**
+   * @brief Human-readable state name for logging
+   */
+  static const char *state_to_string(RadioState state);
 
   /**
    * @brief Flush RX FIFO buffer
@@ -81,6 +356,24 @@ class CC1101Radio {
    */
   uint8_t read_register(uint8_t reg);
 
+  /**
+   * @brief Write consecutive configuration registers in one SPI transaction
+   *
+   * @param reg First register address
+   * @param src Values for reg, reg+1, ...
+   * @param n Number of registers
+   */
+  void write_registers_burst(uint8_t reg, const uint8_t *src, uint8_t n);
+
+  /**
+   * @brief Read consecutive configuration registers in one SPI transaction
+   *
+   * @param reg First register address
+   * @param dst Output buffer (must hold at least n bytes)
+   * @param n Number of registers
+   */
+  void read_registers_burst(uint8_t reg, uint8_t *dst, uint8_t n);
+
   /**
    * @brief Read CC1101 status register
    *
@@ -100,6 +393,19 @@ class CC1101Radio {
    */
   uint8_t read_fifo_byte();
 
+  /**
+   * @brief Read multiple bytes from RX FIFO in a single SPI transaction
+   *
+   * Uses RXFIFO burst access (0xFF) so n bytes cost one CS window instead of
+   * paying CS setup and header byte per byte. A telegram takes at least two
+   * calls, since the payload size is only known once the L-field is in.
+   * Must be called while in IDLE state.
+   *
+   * @param dst Output buffer (must hold at least n bytes)
+   * @param n Number of bytes to read (0 is a no-op)
+   */
+  void read_fifo_burst(uint8_t *dst, uint8_t n);
+
   /**
    * @brief Get number of bytes in RX FIFO
    *
@@ -123,8 +429,154 @@ class CC1101Radio {
    */
   bool is_overflow();
 
+  /**
+   * @brief Read the current RSSI in dBm
+   *
+   * The value is live while in RX and holds the last reading otherwise.
+   */
+  int16_t read_rssi_dbm();
+
+  /**
+   * @brief Read the LQI status register
+   *
+   * @return Bit 7 = CRC_OK, bits [6:0] = link quality of the last telegram
+   */
+  uint8_t read_lqi();
+
+  /**
+   * @brief Convert a raw RSSI byte (register or appended status) to dBm
+   *
+   * Two's complement in 0.5 dB steps, minus the 74 dB offset at 868 MHz
+   * (CC1101 datasheet section 17.3).
+   */
+  static int16_t rssi_to_dbm(uint8_t rssi_raw);
+
  private:
-  Multical21WMBusComponent *component_{nullptr};
+  CC1101Bus *bus_{nullptr};
+  bool continuous_rx_{false};
+  bool fifo_streaming_{false};
+  RadioMode mode_{RadioMode::C1};
+  bool length_override_{false};  // PKTLEN/PKTCTRL0 changed for the current packet
+
+  // State machine
+  RadioState state_{RadioState::RECOVERING};
+  uint32_t state_entered_us_{0};
+  uint32_t state_entered_ms_{0};
+  uint32_t sequence_started_us_{0};
+  uint32_t state_duration_us_[RADIO_STATE_COUNT]{};
+  uint32_t last_rx_start_us_{0};
+  uint32_t recovery_count_{0};
+
+  // Register profile (CC1101_REGISTERS over reset defaults, plus mode overrides)
+  uint8_t profile_[CC1101_CONFIG_REGISTER_COUNT]{};
+  uint32_t profile_hash_{0};  // Hash of profile_ without the calibration registers
+
+  // Boot
+  uint32_t boot_started_us_{0};
+  uint32_t time_to_first_rx_us_{0};
+  bool fast_boot_{false};
+  uint32_t register_mismatches_{0};
+
+  // Recovery
+  RecoveryKind recovery_kind_{RecoveryKind::NONE};  // Recovery in progress
+  RecoveryKind last_recovery_kind_{RecoveryKind::NONE};
+  uint8_t fscal_cache_[RADIO_MODE_COUNT][3]{};  // FSCAL3, FSCAL2, FSCAL1 per mode (frequency)
+  bool calibration_cached_[RADIO_MODE_COUNT]{};
+  bool calibrate_on_rx_{false};  // Cache what the next SRX calibrates
+
+  // Mode switching
+  RadioMode pending_mode_{RadioMode::C1};
+  bool mode_switch_pending_{false};
+  uint32_t mode_switches_{0};
+  uint8_t last_mode_delta_bytes_{0};
+  bool autocal_restore_pending_{false};  // MCSM0 auto-calibration off since a warm restart
+
+  // Power-down between RX windows
+  bool waking_{false};  // TEST registers to restore, wake time to record
+  uint32_t power_downs_{0};
+  uint32_t last_wake_us_{0};
+  uint32_t warm_recovery_count_{0};
+  uint32_t last_recovery_us_[RECOVERY_KIND_COUNT]{};
+  uint32_t last_warm_config_us_{0};
+  uint32_t verify_failures_{0};
+
+  /**
+   * @brief Reset CC1101 chip via software command
+   *
+   * Sends the SRES strobe and restores IOCFG2..IOCFG0 from the profile, so
+   * GDO0 does not carry the reset-default clock output; the RECOVERING
+   * state waits for the chip to settle before the rest of the profile.
+   */
+  void reset_();
+
+  /**
+   * @brief Configure CC1101 registers for wMBUS Mode C1 (or T1) reception
+   *
+   * Writes all required register values for 868.95 MHz (T1: 868.3 MHz), 100 kbps, 2-FSK modulation
+   * and strobes SCAL. Calibration finishes asynchronously (chip returns to IDLE).
+   */
+  void configure_();
+
+  /**
+   * @brief Fill profile_ from CC1101_REGISTERS and the reception mode
+   */
+  void build_profile_();
+
+  /**
+   * @brief Hash a register image with the calibration registers cleared
+   *
+   * FSCAL1-3 are overwritten by every calibration, so they are not part of
+   * the profile comparison. MCSM0 is taken as the profile value while
+   * auto-calibration is held off after a warm restart.
+   */
+  uint32_t profile_hash_of_(const uint8_t *registers) const;
+
+  /**
+   * @brief Burst-write a full register image and verify it by read-back hash
+   *
+   * @param image CC1101_CONFIG_REGISTER_COUNT register values from 0x00
+   * @return true if the chip holds exactly the image
+   */
+  bool write_profile_(const uint8_t *image);
+
+  /**
+   * @brief Restore profile and cached calibration without a reset
+   *
+   * @return true if the chip is in IDLE with the verified profile
+   */
+  bool warm_restart_();
+
+  /**
+   * @brief Store FSCAL3, FSCAL2, FSCAL1 as the current mode's calibration
+   */
+  void cache_calibration_(const uint8_t *fscal);
+
+  /**
+   * @brief Write the register delta to pending_mode_'s profile (chip in IDLE)
+   */
+  void apply_mode_switch_();
+
+  /**
+   * @brief Record timing once a recovery reaches RX; cache calibration after a cold one
+   */
+  void finish_recovery_();
+
+  /**
+   * @brief Move to a new state, recording time spent in the previous one
+   */
+  void transition_to_(RadioState state);
+
+  /**
+   * @brief Run one state step
+   *
+   * @return true if the state changed and the next step can run immediately
+   */
+  bool step_();
+
+  /**
+   * @brief Milliseconds spent in the current state
+   */
+  uint32_t state_elapsed_ms_() const;
 
   /**
    * @brief Send command strobe to CC1101
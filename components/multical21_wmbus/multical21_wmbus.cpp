@@ -1,7 +1,13 @@
 #include "multical21_wmbus.h"
-#include "esphome/core/log.h"
+#include "wmbus_log.h"
 #include "esphome/core/hal.h"
-#include <mbedtls/aes.h>
+#include "esphome/core/helpers.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+#include <esp_sleep.h>
+#endif
 
 namespace esphome {
 namespace multical21_wmbus {
@@ -19,11 +25,12 @@ void Multical21WMBusComponent::setup() {
   // Small delay to let SPI settle
   delay(10);
 
-  // Initialize and configure CC1101 radio via helper class
-  radio_.init(this);  // Pass SPI interface
-  radio_.reset();
-  radio_.configure();
-  radio_.start_rx();
+  // Initialize CC1101 radio via helper class. If the chip kept its
+  // configuration across a soft reboot RX starts directly; otherwise reset,
+  // configuration and RX entry are driven by radio_.tick() from loop() so
+  // setup() does not block.
+  radio_.init(this);  // Component is the radio's SPI bus
+  radio_.begin();
 
   // Setup GDO0 interrupt (packet ready signal)
   // Store instance pointer for ISR access
@@ -47,115 +54,159 @@ void Multical21WMBusComponent::setup() {
                   FALLING);
   ESP_LOGD(TAG, "GDO0 interrupt attached to GPIO%u (FALLING edge)", this->gdo0_pin_);
 
-  this->last_packet_time_ = millis();
-  this->last_health_check_ = millis();
+  // GDO2 rises when the RX FIFO reaches the FIFOTHR threshold: drain it
+  // while the telegram is still arriving
+  if (this->fifo_streaming_) {
+    pinMode(this->gdo2_pin_, INPUT);
+    attachInterrupt(digitalPinToInterrupt(this->gdo2_pin_),
+                    []() {
+                      if (isr_instance_ != nullptr) {
+                        Multical21WMBusComponent::fifo_isr_(isr_instance_);
+                      }
+                    },
+                    RISING);
+    ESP_LOGD(TAG, "GDO2 interrupt attached to GPIO%u (RISING edge, FIFO threshold)", this->gdo2_pin_);
+  }
 
-  // Setup periodic health check using ESPHome's set_interval()
-  // This is more efficient than checking in loop() every 7ms
-  this->set_interval("health_check", HEALTH_CHECK_INTERVAL_MS, [this]() {
-    this->log_radio_status_();
+  // Supervision driven by the packet stream: telegrams feed the watchdog,
+  // and the radio is only probed over SPI once the stream goes quiet
+  this->watchdog_.start(millis());
+  this->set_interval("supervision", HEALTH_CHECK_INTERVAL_MS, [this]() {
+    this->supervise_radio_();
+  });
+  this->set_interval("register_check", REGISTER_CHECK_INTERVAL_MS, [this]() {
+    this->check_radio_registers_();
   });
+  if (this->dual_mode_) {
+    this->set_interval("mode_schedule", MODE_SCHEDULE_INTERVAL_MS, [this]() {
+      this->schedule_mode_();
+    });
+  }
 
-  // Setup timeout check
-  this->set_interval("timeout_check", 30000, [this]() {  // Check every 30 seconds
-    uint32_t now = millis();
-    if (now - this->last_packet_time_ > RECEIVE_TIMEOUT_MS) {
-      ESP_LOGW(TAG, "No packets received for 5 minutes, restarting radio");
-      radio_.reset();
-      radio_.configure();
-      radio_.start_rx();
-      this->last_packet_time_ = now;
+  // Platform-level info_codes text sensor belongs to the single-meter setup
+  if (this->info_codes_sensor_ != nullptr) {
+    if (METER_COUNT == 1 && this->meters_[0] != nullptr && !this->meters_[0]->has_info_codes_sensor()) {
+      this->meters_[0]->set_info_codes_sensor(this->info_codes_sensor_);
+    } else {
+      ESP_LOGW(TAG, "text_sensor info_codes is ignored with several meters; set info_codes per meter");
     }
-  });
+  }
 
   ESP_LOGCONFIG(TAG, "Multical21 wMBUS receiver setup complete");
 }
 
+void Multical21WMBusComponent::add_meter(WMBusMeter *meter) {
+  // Codegen emits METER_IDS from the same list, so every meter has a slot
+  int index = find_meter_index(meter->get_meter_id());
+  if (index < 0) {
+    ESP_LOGE(TAG, "Meter %08X missing from meter table", (unsigned) meter->get_meter_id());
+    return;
+  }
+  this->meters_[index] = meter;
+  this->mode_scheduler_.set_meter_mode(index, meter->get_mode());
+}
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
 
-void Multical21WMBusComponent::update_meter_stats_(uint32_t meter_id_uint, const std::string &frame_type) {
+void Multical21WMBusComponent::update_meter_stats_(WMBusMeter *meter, FrameType frame_type) {
   uint32_t now = millis();
-
-  for (auto &stats : this->meter_stats_) {
-    if (stats.meter_id == meter_id_uint) {
-      if (stats.packet_count > 0) {
-        uint32_t interval_ms = now - stats.last_seen_ms;
-        stats.total_interval_ms += interval_ms;
-        uint32_t avg_interval_sec = (stats.total_interval_ms / stats.packet_count) / 1000;
-        ESP_LOGI(TAG, "Interval: %u.%u sec (avg: %u sec, count: %u, frame: %s)",
-                 interval_ms / 1000, (interval_ms % 1000) / 100,
-                 avg_interval_sec, stats.packet_count + 1, frame_type.c_str());
-      }
-      stats.last_seen_ms = now;
-      stats.packet_count++;
-
-      // Track frame types
-      if (frame_type == "long") {
-        stats.long_frame_count++;
-      } else if (frame_type == "compact") {
-        stats.compact_frame_count++;
-      }
-      stats.last_frame_type = frame_type;
-      return;
-    }
+  MeterStats &stats = meter->get_stats();
+
+  if (stats.packet_count > 0) {
+    uint32_t interval_ms = now - stats.last_seen_ms;
+    stats.total_interval_ms += interval_ms;
+    uint32_t avg_interval_sec = (stats.total_interval_ms / stats.packet_count) / 1000;
+    WMBUS_HOT_LOGI(TAG, "Interval: %u.%u sec (avg: %u sec, count: %u, frame: %s)",
+             interval_ms / 1000, (interval_ms % 1000) / 100,
+             avg_interval_sec, stats.packet_count + 1, frame_type_to_string(frame_type));
+  } else {
+    ESP_LOGI(TAG, "First packet from meter %08X (frame type: %s)", (unsigned) stats.meter_id,
+             frame_type_to_string(frame_type));
   }
-
-  // New meter detected
-  MeterStats new_stats;
-  new_stats.meter_id = meter_id_uint;
-  new_stats.last_seen_ms = now;
-  new_stats.packet_count = 1;
-  new_stats.total_interval_ms = 0;
-  new_stats.compact_frame_count = (frame_type == "compact") ? 1 : 0;
-  new_stats.long_frame_count = (frame_type == "long") ? 1 : 0;
-  new_stats.last_frame_type = frame_type;
-  this->meter_stats_.push_back(new_stats);
-  ESP_LOGI(TAG, "First packet from this meter (frame type: %s)", frame_type.c_str());
+  stats.last_seen_ms = now;
+  stats.packet_count++;
+
+  // Track frame types
+  if (frame_type == FrameType::LONG) {
+    stats.long_frame_count++;
+  } else if (frame_type == FrameType::COMPACT) {
+    stats.compact_frame_count++;
+  }
+  stats.last_frame_type = frame_type;
 }
 
-bool Multical21WMBusComponent::is_our_meter_id_(const uint8_t *meter_id_le) {
-  // meter_id_le is little-endian from packet
-  // this->meter_id_ is big-endian from config
-  return (meter_id_le[0] == this->meter_id_[3] &&
-          meter_id_le[1] == this->meter_id_[2] &&
-          meter_id_le[2] == this->meter_id_[1] &&
-          meter_id_le[3] == this->meter_id_[0]);
+WMBusMeter *Multical21WMBusComponent::find_meter_(const uint8_t *meter_id_le) {
+  // meter_id_le is little-endian from packet; METER_IDS is sorted at codegen
+  int index = find_meter_index(meter_id_from_le(meter_id_le));
+  return index < 0 ? nullptr : this->meters_[index];
 }
 
 bool Multical21WMBusComponent::read_packet_from_fifo_(uint8_t *buffer, uint8_t &length) {
   // CRITICAL: Read ALL bytes from FIFO even if L-field is invalid
   // This prevents FIFO corruption by ensuring garbage packets are fully cleared
+  //
+  // All reads use RXFIFO burst access: one CS window for the header and one
+  // for the payload, instead of one SPI transaction per byte.
 
-  // Read preamble (2 bytes, discard)
-  this->radio_.read_fifo_byte();
-  this->radio_.read_fifo_byte();
-
-  // Read L-field
-  length = this->radio_.read_fifo_byte();
+  // Read preamble (2 bytes, discard) and L-field in one burst
+  uint8_t header[3];
+  this->radio_.read_fifo_burst(header, sizeof(header));
+  length = header[2];
 
   // Log every packet attempt for debugging
-  ESP_LOGI(TAG, "Packet received: L-field=%u", length);
+  WMBUS_HOT_LOGI(TAG, "Packet received: L-field=%u", length);
 
   // Basic sanity check to prevent crazy reads (but still read bytes after)
   if (length < 255 && length > 0) {
     // Store L-field in buffer
     buffer[0] = length;
 
+    // Decode while reading; a telegram longer than the buffer is only drained
+    if (this->pipelined_decode_ && length >= MIN_WMBUS_PACKET_LENGTH && length <= MAX_PACKET_SIZE) {
+      this->stream_decoder_.begin(buffer);
+    }
+
     // Read ALL payload bytes from FIFO (capped at MAX_PACKET_SIZE to prevent buffer overflow)
     uint8_t bytes_to_read = (length < MAX_PACKET_SIZE) ? length : MAX_PACKET_SIZE;
-    for (uint8_t i = 0; i < bytes_to_read; i++) {
-      buffer[i + 1] = this->radio_.read_fifo_byte();
+    uint8_t bytes_read = 0;
+
+    // Early reject: read only C, M and A, and drop foreign telegrams with SFRX
+    // instead of pulling the rest over SPI. Radio is IDLE here, so the flush is legal.
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+    const uint8_t header_bytes = CENSUS_READ_BYTES;  // Census also wants version and device type
+#else
+    const uint8_t header_bytes = EARLY_REJECT_READ_BYTES;
+#endif
+    if (this->early_reject_ && bytes_to_read >= header_bytes) {
+      this->read_fifo_decoded_(buffer, 1, header_bytes);
+      bytes_read = header_bytes;
+      if (this->find_meter_(&buffer[OFFSET_METER_ID]) == nullptr) {
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+        // No CRC to check yet; the header is recorded as read
+        this->record_census_(buffer, this->rx_rssi_dbm_);
+#endif
+        this->watchdog_.feed(millis());  // A foreign telegram still proves the radio receives
+        // Only telegram bytes SFRX discards count: a long L-field reaches past
+        // what the FIFO holds, and past the telegram it holds noise
+        uint8_t in_fifo = this->radio_.get_rx_bytes() & 0x7F;
+        uint8_t rest = length - bytes_read;
+        this->early_reject_bytes_skipped_ += in_fifo < rest ? in_fifo : rest;
+        this->radio_.flush_rx_fifo();
+        this->frames_rejected_early_++;
+        return false;
+      }
     }
 
+    this->read_fifo_decoded_(buffer, 1 + bytes_read, bytes_to_read - bytes_read);
+    this->frames_read_fully_++;
+
     // If L-field was larger than MAX_PACKET_SIZE, drain excess bytes
     if (length > MAX_PACKET_SIZE) {
       uint8_t excess = length - MAX_PACKET_SIZE;
       ESP_LOGW(TAG, "Draining %u excess bytes (L-field=%u exceeds MAX=%u)", excess, length, MAX_PACKET_SIZE);
-      for (uint8_t i = 0; i < excess; i++) {
-        this->radio_.read_fifo_byte();
-      }
+      this->drain_fifo_(excess);
     }
 
     // NOW validate the L-field for wMBUS protocol (AFTER reading all bytes)
@@ -174,54 +225,273 @@ bool Multical21WMBusComponent::read_packet_from_fifo_(uint8_t *buffer, uint8_t &
   // We already read 3 bytes (2 preamble + 1 L-field)
   if (remaining > 0) {
     ESP_LOGW(TAG, "Draining %u remaining bytes from FIFO after bad L-field", remaining);
-    for (uint8_t i = 0; i < remaining && i < 64; i++) {  // Safety limit
-      this->radio_.read_fifo_byte();
-    }
+    this->drain_fifo_(remaining < 64 ? remaining : 64);  // Safety limit
   }
   return false;
 }
 
+void Multical21WMBusComponent::drain_fifo_(uint8_t count) {
+  // Discard bytes in FIFO-sized bursts
+  uint8_t scratch[MAX_PACKET_SIZE];
+  while (count > 0) {
+    uint8_t chunk = (count < sizeof(scratch)) ? count : sizeof(scratch);
+    this->radio_.read_fifo_burst(scratch, chunk);
+    count -= chunk;
+  }
+}
+
+void Multical21WMBusComponent::read_fifo_decoded_(uint8_t *packet, uint16_t offset, uint8_t count) {
+  if (!this->stream_decoder_.is_active()) {
+    this->radio_.read_fifo_burst(&packet[offset], count);
+    return;
+  }
+
+  // One AES block per burst: CRC and decryption of a chunk run before the
+  // next one is read, so both are done when the last byte arrives
+  while (count > 0) {
+    uint8_t chunk = count < STREAM_DECODE_CHUNK ? count : STREAM_DECODE_CHUNK;
+    // Stop at the cipher start so the key is chosen before any ciphertext is fed
+    if (offset < OFFSET_CIPHER_START && offset + chunk > OFFSET_CIPHER_START) {
+      chunk = OFFSET_CIPHER_START - offset;
+    }
+    this->radio_.read_fifo_burst(&packet[offset], chunk);
+    uint32_t start_us = micros();
+    this->stream_decoder_.feed(packet, chunk);
+    if (this->stream_meter_ != nullptr) {
+      this->stream_decrypt_us_ += micros() - start_us;
+    }
+    offset += chunk;
+    count -= chunk;
+
+    if (offset == OFFSET_CIPHER_START) {
+      WMBusMeter *meter = this->find_meter_(&packet[OFFSET_METER_ID]);
+      if (meter != nullptr && meter->get_crypto().has_key()) {
+        this->stream_meter_ = meter;
+        this->stream_decoder_.set_crypto(&meter->get_crypto());
+      }
+    }
+  }
+}
+
+void Multical21WMBusComponent::finish_stream_decode_(PacketBuffer *pkt) {
+  pkt->verdict = this->stream_decoder_.finish(pkt->data);
+  if (pkt->verdict == DecodeVerdict::DECRYPTED) {
+    WMBUS_LATENCY_END(this->latency_, LatencyStage::PLAINTEXT_READY, this->isr_cycles_);
+    // Same split as decrypt_packet_payload_(), for the keystream saving
+    if (this->stream_meter_->get_crypto().last_decrypt_was_hit()) {
+      this->decrypt_hit_us_total_ += this->stream_decrypt_us_;
+    } else {
+      this->decrypt_full_us_total_ += this->stream_decrypt_us_;
+      this->decrypt_full_count_++;
+    }
+  }
+  this->stream_meter_ = nullptr;
+  this->stream_decrypt_us_ = 0;
+}
+
 bool Multical21WMBusComponent::read_fifo_into_packet_buffer_() {
+  // FIFO bytes go straight into the ring slot; no intermediate copy
+  WMBUS_LATENCY_BEGIN(drain_start);
+  PacketBuffer *pkt = this->packet_buffer_.reserve();
+  uint8_t length;
+  this->stream_decoder_.reset();
+  this->stream_meter_ = nullptr;
+  this->stream_decrypt_us_ = 0;
+
   // Check if packet buffer has space
-  if (this->packet_buffer_.is_full()) {
-    ESP_LOGW(TAG, "Packet buffer full - dropping packet");
+  if (pkt == nullptr) {
+    ESP_LOGW(TAG, "Packet buffer full - dropping packet (%u dropped)", (unsigned) this->packet_buffer_.get_drop_count());
     return false;
   }
 
+  // Infinite packet length has no end of packet, so the chip appends no
+  // status here. GDO0 falls when the FIFO overflows, which takes the radio
+  // out of RX; by then a shorter telegram has long ended and the status
+  // registers hold the noise after it. Nothing reliable to store.
+  pkt->rssi_dbm = RSSI_UNKNOWN_DBM;
+  pkt->lqi = LQI_UNKNOWN;
+  pkt->radio_crc_ok = false;
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  this->rx_rssi_dbm_ = RSSI_UNKNOWN_DBM;
+#endif
+
   // CRITICAL: Enter IDLE state BEFORE reading FIFO to prevent overflow condition!
   // Reading FIFO while in RX state can cause MARCSTATE 0x0D (RX_FIFO_OVERFLOW)
   // The FIFO contents are preserved when entering IDLE state.
-  this->radio_.enter_idle();
-
-  // Small delay to ensure state transition completes
-  delayMicroseconds(100);
+  if (!this->radio_.enter_idle()) {
+    ESP_LOGW(TAG, "Radio did not confirm IDLE before FIFO read");
+  }
 
   // Read packet from FIFO (while radio is in IDLE state)
-  PacketBuffer pkt;
-  uint8_t length;
-  if (!this->read_packet_from_fifo_(pkt.data, length)) {
+  if (this->mode_ == RadioMode::T1) {
+    if (!this->read_t1_packet_from_fifo_(pkt, length)) {
+      return false;  // Invalid packet
+    }
+  } else if (!this->read_packet_from_fifo_(pkt->data, length)) {
     return false;  // Invalid packet
   }
 
-  // Store packet in buffer
-  pkt.length = length + 1;
-  pkt.timestamp = millis();
-  pkt.valid = true;
-  return this->packet_buffer_.push(pkt);
+  // Publish slot to the consumer; a T1 telegram has its block CRC verdict already
+  if (this->mode_ != RadioMode::T1) {
+    this->finish_stream_decode_(pkt);
+  }
+  this->packet_buffer_.commit(length + 1, millis());
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::FIFO_DRAIN, drain_start);
+  return true;
 }
 
-void Multical21WMBusComponent::process_buffered_packets_() {
-  PacketBuffer pkt;
-  while (this->packet_buffer_.pop(pkt)) {
-    // Update last packet time
-    this->last_packet_time_ = pkt.timestamp;
+bool Multical21WMBusComponent::read_t1_packet_from_fifo_(PacketBuffer *pkt, uint8_t &length) {
+  // The radio went IDLE when the FIFO overflowed, so the telegram's first
+  // CC1101_FIFO_SIZE coded bytes are all there is; longer ones need gdo2_pin
+  uint8_t raw[CC1101_FIFO_SIZE];
+  this->radio_.read_fifo_burst(raw, STREAM_HEADER_BYTES);
+  uint8_t header[2];
+  if (!WMBusT1Decoder::decode(raw, header, sizeof(header))) {
+    return false;  // Noise that happened to match the sync word
+  }
+  length = header[0];
+  WMBUS_HOT_LOGI(TAG, "Packet received: L-field=%u (T1)", length);
+  if (length < MIN_WMBUS_PACKET_LENGTH) {
+    return false;
+  }
+
+  uint16_t raw_size = WMBusT1Decoder::encoded_size(WMBusT1Decoder::frame_size(length));
+  if (raw_size > sizeof(raw)) {
+    this->t1_too_long_++;
+    ESP_LOGW(TAG, "T1 telegram of %u coded bytes (L-field=%u) does not fit the FIFO; set gdo2_pin to receive it",
+             (unsigned) raw_size, length);
+    return false;  // start_rx() flushes the rest
+  }
+  this->radio_.read_fifo_burst(&raw[STREAM_HEADER_BYTES], raw_size - STREAM_HEADER_BYTES);
+  this->frames_read_fully_++;
+
+  if (!this->decode_t1_packet_(raw, length, pkt)) {
+    return false;
+  }
+  length = pkt->data[0];
+  return true;
+}
+
+bool Multical21WMBusComponent::decode_t1_packet_(const uint8_t *raw, uint8_t l_field, PacketBuffer *pkt) {
+  // Decode everything, then check and strip the block CRCs into the slot
+  uint8_t frame[WMBusT1Decoder::frame_size(UINT8_MAX)];
+  if (!WMBusT1Decoder::decode(raw, frame, WMBusT1Decoder::frame_size(l_field))) {
+    this->t1_symbol_errors_++;
+    WMBUS_HOT_LOGD(TAG, "T1 telegram dropped: invalid 3-out-of-6 symbol");
+    return false;
+  }
+  if (!WMBusT1Decoder::check_frame_a(frame, pkt->data, sizeof(pkt->data))) {
+    this->t1_block_crc_errors_++;
+    WMBUS_HOT_LOGD(TAG, "T1 telegram dropped: block CRC failed");
+    return false;
+  }
+  pkt->verdict = DecodeVerdict::CRC_OK;
+  return true;
+}
+
+void Multical21WMBusComponent::read_continuous_frame_(uint8_t count) {
+  // Continuous RX: the radio ends every frame after exactly CONTINUOUS_RX_FRAME_SIZE
+  // bytes plus the appended status and goes straight back to sync search.
+  // FIFO byte n of the frame is packet byte n - 2: the 2 preamble bytes go to
+  // scratch, the L-field onwards and the RSSI/LQI bytes into the ring slot.
+  static_assert(CONTINUOUS_RX_FRAME_BYTES - 2 <= MAX_PACKET_SIZE + 1, "Frame and status must fit a packet slot");
+  if (count == 0) {
+    return;
+  }
+  if (this->fifo_read_ == 0) {
+    // Ring full: the frame is still drained, otherwise it blocks the FIFO
+    // for the next telegram
+    this->fifo_pkt_ = this->packet_buffer_.reserve();
+    if (this->fifo_pkt_ == nullptr) {
+      ESP_LOGW(TAG, "Packet buffer full - dropping packet (%u dropped)", (unsigned) this->packet_buffer_.get_drop_count());
+    }
+    this->stream_decoder_.reset();
+    this->stream_meter_ = nullptr;
+    this->stream_decrypt_us_ = 0;
+    this->continuous_end_seen_ = false;
+    this->packets_received_++;
+  }
+  if (this->fifo_pkt_ == nullptr) {
+    this->drain_fifo_(count);
+    this->fifo_read_ += count;
+    return;
+  }
+
+  uint8_t *data = this->fifo_pkt_->data;
+  if (this->fifo_read_ < 2) {
+    uint8_t preamble[2];
+    uint8_t skip = 2 - this->fifo_read_ < count ? 2 - this->fifo_read_ : count;
+    this->radio_.read_fifo_burst(preamble, skip);
+    this->fifo_read_ += skip;
+    count -= skip;
+  }
+  if (count > 0 && this->fifo_read_ == 2) {
+    // L-field first, so the telegram can be decoded chunk by chunk
+    this->radio_.read_fifo_burst(data, 1);
+    this->fifo_read_++;
+    count--;
+    WMBUS_HOT_LOGI(TAG, "Packet received: L-field=%u", data[0]);
+    if (this->pipelined_decode_ && data[0] >= MIN_WMBUS_PACKET_LENGTH && data[0] <= CONTINUOUS_RX_MAX_L_FIELD) {
+      this->stream_decoder_.begin(data);
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+
+  // Telegram bytes through the decoder, then padding and status as they are
+  uint16_t telegram_end = STREAM_HEADER_BYTES + (data[0] <= CONTINUOUS_RX_MAX_L_FIELD ? data[0] : 0);
+  if (this->fifo_read_ < telegram_end) {
+    uint8_t chunk = telegram_end - this->fifo_read_ < count ? telegram_end - this->fifo_read_ : count;
+    this->read_fifo_decoded_(data, this->fifo_read_ - 2, chunk);
+    this->fifo_read_ += chunk;
+    count -= chunk;
+  }
+  if (count > 0) {
+    this->radio_.read_fifo_burst(&data[this->fifo_read_ - 2], count);
+    this->fifo_read_ += count;
+  }
+}
+
+void Multical21WMBusComponent::finish_continuous_frame_() {
+  PacketBuffer *pkt = this->fifo_pkt_;
+  this->fifo_pkt_ = nullptr;
+  this->fifo_read_ = 0;
+  if (pkt == nullptr) {
+    return;  // Dropped: the ring was full
+  }
 
+  this->store_rx_status_(pkt, pkt->data[CONTINUOUS_RX_FRAME_SIZE - 2], pkt->data[CONTINUOUS_RX_FRAME_SIZE - 1]);
+  uint8_t length = pkt->data[0];
+  if (length < MIN_WMBUS_PACKET_LENGTH || length > CONTINUOUS_RX_MAX_L_FIELD) {
+    return;  // Noise that happened to match the sync word; slot is reused
+  }
+  this->finish_stream_decode_(pkt);
+  this->packet_buffer_.commit(length + 1, millis());
+}
+
+void Multical21WMBusComponent::store_rx_status_(PacketBuffer *pkt, uint8_t rssi_raw, uint8_t lqi_raw) {
+  pkt->rssi_dbm = CC1101Radio::rssi_to_dbm(rssi_raw);
+  pkt->lqi = lqi_raw & LQI_VALUE_MASK;
+  pkt->radio_crc_ok = (lqi_raw & LQI_CRC_OK) != 0;
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  // Early reject records the census before the slot is committed
+  this->rx_rssi_dbm_ = pkt->rssi_dbm;
+#endif
+}
+
+void Multical21WMBusComponent::process_buffered_packets_() {
+  // Parse each telegram in place in its ring slot
+  while (const PacketBuffer *pkt = this->packet_buffer_.peek()) {
     // Process packet
-    this->process_packet_(pkt.data, pkt.length);
+    WMBUS_HOT_LOGV(TAG, "Signal: RSSI=%ddBm, LQI=%u, radio CRC_OK=%s", pkt->rssi_dbm, pkt->lqi,
+                   YESNO(pkt->radio_crc_ok));
+    this->process_packet_(pkt->data, pkt->length, pkt->rssi_dbm, pkt->lqi, pkt->verdict);
+    this->packet_buffer_.release();
   }
 }
 
-bool Multical21WMBusComponent::validate_packet_structure_(const uint8_t *packet_data, uint8_t length, uint8_t packet_length) {
+bool Multical21WMBusComponent::validate_packet_structure_(uint8_t length, uint16_t packet_length) {
   // Guard clause: check length validity
   if (length > MAX_PACKET_SIZE || length < MIN_WMBUS_PACKET_LENGTH) {
     ESP_LOGW(TAG, "Invalid packet length: %u", length);
@@ -238,7 +508,9 @@ bool Multical21WMBusComponent::validate_packet_structure_(const uint8_t *packet_
 }
 
 bool Multical21WMBusComponent::verify_packet_crc_(const uint8_t *packet_data, uint8_t length) {
+  WMBUS_LATENCY_BEGIN(crc_start);
   uint16_t calculated_crc = WMBusCrypto::calculate_crc(packet_data, length - 1);
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::CRC, crc_start);
   uint16_t packet_crc = (packet_data[length - 1] << 8) | packet_data[length];
 
   if (calculated_crc != packet_crc) {
@@ -248,18 +520,28 @@ bool Multical21WMBusComponent::verify_packet_crc_(const uint8_t *packet_data, ui
     return false;
   }
 
-  ESP_LOGI(TAG, "CRC verification PASSED (0x%04X)", calculated_crc);
+  WMBUS_HOT_LOGI(TAG, "CRC verification PASSED (0x%04X)", calculated_crc);
   return true;
 }
 
-bool Multical21WMBusComponent::decrypt_packet_payload_(const uint8_t *packet_data, uint8_t length,
+bool Multical21WMBusComponent::decrypt_packet_payload_(WMBusMeter *meter, const uint8_t *packet_data, uint8_t length,
                                                         uint8_t *plaintext, uint8_t &plaintext_length) {
-  // Convert vector to array for crypto API
-  std::array<uint8_t, 16> aes_key_array;
-  std::copy(this->aes_key_.begin(), this->aes_key_.end(), aes_key_array.begin());
-
-  // Decrypt using crypto helper
-  return this->crypto_.decrypt_packet(packet_data, length, aes_key_array, plaintext, plaintext_length);
+  // Decrypt with the meter's own key schedule (expanded once by set_aes_key)
+  uint32_t start_us = micros();
+  WMBUS_LATENCY_BEGIN(aes_start);
+  bool ok = meter->get_crypto().decrypt_packet(packet_data, length, plaintext, plaintext_length);
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::AES, aes_start);
+  uint32_t elapsed_us = micros() - start_us;
+  WMBUS_HOT_LOGV(TAG, "Decrypt took %u us", (unsigned) elapsed_us);
+
+  // Split timing by path so the keystream prediction saving can be reported
+  if (ok && meter->get_crypto().last_decrypt_was_hit()) {
+    this->decrypt_hit_us_total_ += elapsed_us;
+  } else if (ok) {
+    this->decrypt_full_us_total_ += elapsed_us;
+    this->decrypt_full_count_++;
+  }
+  return ok;
 }
 
 // ============================================================================
@@ -267,8 +549,51 @@ bool Multical21WMBusComponent::decrypt_packet_payload_(const uint8_t *packet_dat
 // ============================================================================
 
 void Multical21WMBusComponent::loop() {
-  // Guard clause: only process if interrupt fired
-  if (!this->packet_ready_) {
+  // Advance radio restarts/recovery without blocking other components
+  this->radio_.tick();
+  if (this->rx_windowing_) {
+    this->update_rx_window_();
+  }
+  this->track_radio_restart_();
+
+  // Nothing to read: generate the keystream for the next expected telegram now
+  if (!this->packet_ready_ && this->keystream_precompute_pending_) {
+    this->keystream_precompute_pending_ = false;
+    for (WMBusMeter *meter : this->meters_) {
+      if (meter != nullptr && meter->get_crypto().is_precompute_pending()) {
+        meter->get_crypto().precompute_keystream();
+      }
+    }
+  }
+
+  // Guard clause: only process if interrupt fired (or a continuous RX frame
+  // is still being drained)
+  if (!this->packet_ready_ && !this->fifo_ready_ && !this->continuous_draining_) {
+    return;
+  }
+
+  // GDO0 edges while the radio is being restarted are not telegrams
+  // (e.g. SIDLE mid-packet, or the clock output in the microseconds between
+  // SRES and the IOCFG rewrite in CC1101Radio::reset_())
+  if (!this->radio_.is_receiving()) {
+    this->packet_ready_ = false;
+    this->fifo_ready_ = false;
+    this->fifo_pkt_ = nullptr;
+    this->fifo_read_ = 0;
+    this->continuous_draining_ = false;
+    return;
+  }
+
+  // Time from the GDO0 edge until we got here: other components' loop() share
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::LOOP_WAKE, this->isr_cycles_);
+
+  if (this->continuous_rx_) {
+    this->loop_continuous_rx_();
+    return;
+  }
+
+  if (this->fifo_streaming_) {
+    this->loop_fifo_streaming_();
     return;
   }
 
@@ -279,22 +604,16 @@ void Multical21WMBusComponent::loop() {
   this->packet_ready_ = false;
   this->packets_received_++;
 
+  // Radio is deaf from entering IDLE until the state machine confirms RX
+  this->restart_started_us_ = micros();
+  this->restart_pending_ = true;
+
   // Process the packet
-  if (!this->read_fifo_into_packet_buffer_()) {
-    this->radio_.start_rx();
-    // Re-attach interrupt before returning
-    attachInterrupt(digitalPinToInterrupt(this->gdo0_pin_),
-                    []() {
-                      if (isr_instance_ != nullptr) {
-                        Multical21WMBusComponent::packet_isr_(isr_instance_);
-                      }
-                    },
-                    FALLING);
-    return;
-  }
+  bool buffered = this->read_fifo_into_packet_buffer_();
 
-  // Restart receiver for next packet
+  // Restart receiver for next packet (completes over the next loop() ticks)
   this->radio_.start_rx();
+  this->high_freq_loop_.start();
 
   // Re-attach interrupt
   attachInterrupt(digitalPinToInterrupt(this->gdo0_pin_),
@@ -305,102 +624,672 @@ void Multical21WMBusComponent::loop() {
                   },
                   FALLING);
 
+  if (!buffered) {
+    return;
+  }
+
   // Process all packets in buffer
   this->process_buffered_packets_();
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::TOTAL, this->isr_cycles_);
+}
+
+void Multical21WMBusComponent::loop_continuous_rx_() {
+  // Radio never leaves RX here, so the interrupt stays attached. GDO0 fires
+  // once the FIFO reaches the threshold, but only deasserts when it is
+  // empty: until then loop() polls and drains whatever has arrived.
+  this->packet_ready_ = false;
+
+  WMBUS_LATENCY_BEGIN(drain_start);
+  uint8_t rxbytes = this->radio_.get_rx_bytes();
+  uint32_t now_us = micros();
+  if (rxbytes & 0x80) {
+    // Error recovery only: the one path that leaves RX and flushes
+    ESP_LOGW(TAG, "RX FIFO overflow in continuous mode - recovering");
+    this->fifo_overflows_++;
+    this->fifo_pkt_ = nullptr;  // Slot is reused, never committed
+    this->fifo_read_ = 0;
+    this->continuous_draining_ = false;
+    this->restart_fifo_rx_();
+    return;
+  }
+
+  uint8_t available = rxbytes & 0x7F;
+  bool finished = false;
+  while (available > 0) {
+    uint8_t missing = CONTINUOUS_RX_FRAME_BYTES - this->fifo_read_;
+    bool complete = available >= missing;
+    // Still receiving this frame: reading the FIFO empty can return the last
+    // byte twice (CC1101 errata), so one byte stays behind until the next pass
+    uint8_t count = complete ? missing : available - 1;
+    uint16_t arrived = this->fifo_read_ + (complete ? missing : available);
+    this->read_continuous_frame_(count);
+
+    // Deaf time: after the telegram's last byte the chip keeps receiving
+    // padding until the fixed-length frame ends, and only then re-arms for
+    // the next sync word. Both moments are seen here by polling; when they
+    // fall into the same pass, the padding's air time is the best bound.
+    if (this->fifo_read_ >= STREAM_HEADER_BYTES && !this->continuous_end_seen_) {
+      // A dropped frame's L-field was not kept: assume the longest telegram
+      uint8_t length = this->fifo_pkt_ != nullptr ? this->fifo_pkt_->data[0] : CONTINUOUS_RX_MAX_L_FIELD;
+      uint16_t telegram_end = STREAM_HEADER_BYTES + (length <= CONTINUOUS_RX_MAX_L_FIELD ? length : 0);
+      if (arrived >= telegram_end) {
+        this->continuous_end_seen_ = true;
+        this->continuous_end_us_ = now_us;
+        if (complete) {
+          this->continuous_end_us_ -= (CONTINUOUS_RX_FRAME_SIZE - telegram_end) * C1_BYTE_US;
+        }
+      }
+    }
+    if (!complete) {
+      available = 1;
+      break;
+    }
+    this->record_deaf_time_(now_us - this->continuous_end_us_);
+    this->finish_continuous_frame_();
+    finished = true;
+    available -= missing;
+  }
+
+  // Drained empty: GDO0 deasserted and the next threshold is a new edge.
+  // Bytes behind the last frame mean it may never have been empty.
+  this->continuous_draining_ = available > 0 || (this->radio_.get_rx_bytes() & 0x7F) != 0;
+  if (this->continuous_draining_) {
+    this->high_freq_loop_.start();
+  }
+  if (!finished) {
+    return;
+  }
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::FIFO_DRAIN, drain_start);
+
+  this->process_buffered_packets_();
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::TOTAL, this->isr_cycles_);
+}
+
+void Multical21WMBusComponent::loop_fifo_streaming_() {
+  // GDO0 falls when the fixed length is reached (radio goes IDLE) or on overflow
+  bool rx_ended = this->packet_ready_;
+  this->packet_ready_ = false;
+  this->fifo_ready_ = false;
+  this->fifo_wakes_++;
+
+  uint8_t rxbytes = this->radio_.get_rx_bytes();
+  bool overflow = (rxbytes & 0x80) != 0;
+  uint8_t available = rxbytes & 0x7F;
+  if (!rx_ended && !overflow && available > 0) {
+    // Still receiving: reading the FIFO empty can return the last byte twice
+    // (CC1101 errata), so one byte stays behind until the next wake
+    available--;
+  }
+
+  if (this->fifo_pkt_ == nullptr) {
+    if (available < STREAM_HEADER_BYTES) {
+      if (rx_ended || overflow) {
+        this->restart_fifo_rx_();  // Radio stopped without a usable header
+      }
+      return;
+    }
+    if (!this->begin_fifo_packet_()) {
+      this->restart_fifo_rx_();
+      return;
+    }
+    available -= STREAM_HEADER_BYTES;
+  }
+
+  // An overflow only costs the telegram if its own bytes did not fit; bytes
+  // after its end (length switched too late) are simply dropped
+  uint16_t missing = this->fifo_total_ - this->fifo_read_;
+  if ((overflow || rx_ended) && available < missing) {
+    this->fifo_overflows_ += overflow ? 1 : 0;
+    ESP_LOGW(TAG, "Telegram lost: %u of %u bytes read when the radio stopped (%s)", (unsigned) this->fifo_read_,
+             (unsigned) this->fifo_total_, overflow ? "RX FIFO overflow" : "end of packet");
+    this->fifo_pkt_ = nullptr;  // Slot is reused, never committed
+    this->restart_fifo_rx_();
+    return;
+  }
+
+  uint8_t count = available < missing ? available : static_cast<uint8_t>(missing);
+  if (this->mode_ == RadioMode::T1) {
+    // Coded bytes are collected and decoded once the telegram is complete
+    this->radio_.read_fifo_burst(&this->t1_raw_[this->fifo_read_], count);
+  } else {
+    // FIFO byte n is packet byte n - 2 (the two bytes after the sync word come first)
+    this->read_fifo_decoded_(this->fifo_pkt_->data, this->fifo_read_ - 2, count);
+  }
+  this->fifo_read_ += count;
+
+  // Early reject once the A-field is in: the rest of a foreign telegram,
+  // up to 252 more bytes, is never read
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  const uint8_t header_bytes = CENSUS_READ_BYTES;
+#else
+  const uint8_t header_bytes = EARLY_REJECT_READ_BYTES;
+#endif
+  // T1: the header is the first Frame Format A block, once decoded
+  bool header_in = this->mode_ == RadioMode::T1
+                       ? this->fifo_read_ >= WMBusT1Decoder::encoded_size(WMBusT1Decoder::FIRST_BLOCK_SIZE)
+                       : this->fifo_read_ - STREAM_HEADER_BYTES >= header_bytes;
+  if (this->early_reject_ && !this->fifo_header_checked_ && header_in) {
+    this->fifo_header_checked_ = true;
+    const uint8_t *packet = this->fifo_pkt_->data;
+    uint8_t first_block[WMBusT1Decoder::FIRST_BLOCK_SIZE];  // Same offsets as a C1 slot
+    bool header_ok = true;
+    if (this->mode_ == RadioMode::T1) {
+      packet = first_block;
+      header_ok = WMBusT1Decoder::decode(this->t1_raw_, first_block, sizeof(first_block));
+    }
+    if (header_ok && this->find_meter_(&packet[OFFSET_METER_ID]) == nullptr) {
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+      this->record_census_(packet, this->rx_rssi_dbm_);
+#endif
+      this->watchdog_.feed(millis());
+      this->frames_rejected_early_++;
+      this->early_reject_bytes_skipped_ += this->fifo_total_ - this->fifo_read_;
+      this->fifo_pkt_ = nullptr;
+      this->restart_fifo_rx_();
+      return;
+    }
+  }
+
+  if (this->fifo_read_ < this->fifo_total_) {
+    return;  // More on the next threshold or end-of-packet edge
+  }
+
+  // Complete: the radio is IDLE (fixed length reached) or still in RX after
+  // a late switch; either way it is restarted for the next telegram
+  PacketBuffer *pkt = this->fifo_pkt_;
+  this->fifo_pkt_ = nullptr;
+  this->frames_read_fully_++;
+  if (this->fifo_total_ > CC1101_FIFO_SIZE) {
+    this->long_telegrams_++;
+  }
+  if (this->mode_ == RadioMode::T1) {
+    bool decoded = this->decode_t1_packet_(this->t1_raw_, pkt->data[0], pkt);
+    this->restart_fifo_rx_();
+    if (!decoded) {
+      return;  // Slot is reused, never committed
+    }
+  } else {
+    this->finish_stream_decode_(pkt);
+    this->restart_fifo_rx_();
+  }
+  this->packet_buffer_.commit(pkt->data[0] + 1, millis());
+
+  this->process_buffered_packets_();
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::TOTAL, this->isr_cycles_);
+}
+
+bool Multical21WMBusComponent::begin_fifo_packet_() {
+  PacketBuffer *pkt = this->packet_buffer_.reserve();
+  if (pkt == nullptr) {
+    ESP_LOGW(TAG, "Packet buffer full - dropping packet (%u dropped)", (unsigned) this->packet_buffer_.get_drop_count());
+    return false;
+  }
+
+  uint8_t header[STREAM_HEADER_BYTES];
+  this->radio_.read_fifo_burst(header, sizeof(header));
+  uint8_t length = header[2];
+  if (this->mode_ == RadioMode::T1) {
+    // Three coded bytes are the L- and C-fields
+    uint8_t fields[2];
+    if (!WMBusT1Decoder::decode(header, fields, sizeof(fields)) || fields[0] + CRC_SIZE > MAX_PACKET_SIZE) {
+      return false;  // Noise that happened to match the sync word
+    }
+    length = fields[0];
+    memcpy(this->t1_raw_, header, sizeof(header));
+  }
+  WMBUS_HOT_LOGI(TAG, "Packet received: L-field=%u", length);
+  if (length < MIN_WMBUS_PACKET_LENGTH) {
+    return false;  // Noise that happened to match the sync word
+  }
+
+  // Stop the radio right after the last byte: infinite -> fixed length.
+  // Longer telegrams stay in infinite mode and are cut off by the restart.
+  this->fifo_total_ = this->mode_ == RadioMode::T1
+                          ? WMBusT1Decoder::encoded_size(WMBusT1Decoder::frame_size(length))
+                          : STREAM_HEADER_BYTES + length;
+  this->fifo_read_ = STREAM_HEADER_BYTES;
+  if (this->fifo_total_ <= MAX_FIXED_PACKET_LENGTH) {
+    this->radio_.set_fixed_length(this->fifo_total_);
+  }
+
+  // Mid-telegram, so the status registers hold this telegram's level
+  this->store_rx_status_(pkt, this->radio_.read_status_register(CC1101_RSSI), this->radio_.read_lqi());
+  pkt->data[0] = length;
+  this->stream_decoder_.reset();
+  this->stream_meter_ = nullptr;
+  this->stream_decrypt_us_ = 0;
+  if (this->pipelined_decode_ && this->mode_ == RadioMode::C1) {
+    this->stream_decoder_.begin(pkt->data);
+  }
+  this->fifo_pkt_ = pkt;
+  this->fifo_header_checked_ = false;
+  this->packets_received_++;
+  return true;
+}
+
+void Multical21WMBusComponent::restart_fifo_rx_() {
+  this->restart_started_us_ = micros();
+  this->restart_pending_ = true;
+  this->radio_.start_rx();
+  // Poll the restart from the very next pass, not a loop interval later:
+  // the chip is in RX within a millisecond and a telegram may follow
+  this->high_freq_loop_.start();
+}
+
+void Multical21WMBusComponent::track_radio_restart_() {
+  if (this->radio_.get_state() == RadioState::SLEEP) {
+    this->high_freq_loop_.stop();  // Nothing to poll until the next window
+    return;
+  }
+  if (!this->radio_.is_receiving()) {
+    // Keep loop() spinning so state transitions are seen within microseconds
+    this->high_freq_loop_.start();
+    return;
+  }
+  if (!this->continuous_draining_) {
+    this->high_freq_loop_.stop();
+  }
+
+  if (this->restart_pending_) {
+    this->restart_pending_ = false;
+    this->record_deaf_time_(micros() - this->restart_started_us_);
+    WMBUS_HOT_LOGD(TAG, "ISR-to-RX-restart window: %u us (restart %u us: idle %u, flush %u, rx %u)",
+             (unsigned) (micros() - this->isr_time_us_), (unsigned) this->radio_.get_last_rx_start_us(),
+             (unsigned) this->radio_.get_state_duration_us(RadioState::IDLE_PENDING),
+             (unsigned) this->radio_.get_state_duration_us(RadioState::FLUSHING),
+             (unsigned) this->radio_.get_state_duration_us(RadioState::RX_PENDING));
+  }
+}
+
+void Multical21WMBusComponent::record_deaf_time_(uint32_t deaf_us) {
+  this->total_deaf_time_us_ += deaf_us;
+  WMBUS_HOT_LOGD(TAG, "Receiver deaf time: %u us", (unsigned) deaf_us);
 }
 
 void Multical21WMBusComponent::update() {
-  // Periodic update called based on polling interval
-  // Print transmission interval statistics ONLY for configured meter
+  // Statistics only: telegrams are received and processed in loop(), so this
+  // logs and publishes the counters of every meter and enabled receive option
 
   uint32_t now = millis();
 
-  // Look for OUR meter in stats
-  bool found_our_meter = false;
-  for (const auto &stats : this->meter_stats_) {
-    // Convert meter ID back to bytes for display (big-endian format)
-    uint8_t id_bytes[4] = {
-      (uint8_t)((stats.meter_id >> 24) & 0xFF),
-      (uint8_t)((stats.meter_id >> 16) & 0xFF),
-      (uint8_t)((stats.meter_id >> 8) & 0xFF),
-      (uint8_t)(stats.meter_id & 0xFF)
-    };
-
-    // Check if this is our meter
-    // id_bytes is already in big-endian format, same as this->meter_id_
-    bool is_ours = (id_bytes[0] == this->meter_id_[0] &&
-                    id_bytes[1] == this->meter_id_[1] &&
-                    id_bytes[2] == this->meter_id_[2] &&
-                    id_bytes[3] == this->meter_id_[3]);
-
-    if (!is_ours) {
-      continue;  // Skip other meters
-    }
-
-    found_our_meter = true;
-
-    // Calculate time since last packet
-    uint32_t elapsed_ms = now - stats.last_seen_ms;
-    uint32_t elapsed_sec = elapsed_ms / 1000;
-
-    ESP_LOGI(TAG, "===========================================================");
-    ESP_LOGI(TAG, "OUR METER: %02X%02X%02X%02X", id_bytes[0], id_bytes[1], id_bytes[2], id_bytes[3]);
-    ESP_LOGI(TAG, "===========================================================");
-
-    if (stats.packet_count > 1) {
-      uint32_t avg_interval_ms = stats.total_interval_ms / (stats.packet_count - 1);
-      uint32_t avg_interval_sec = avg_interval_ms / 1000;
-
-      // Calculate estimated time until next packet
-      int32_t time_until_next_sec = avg_interval_sec - elapsed_sec;
-
-      ESP_LOGI(TAG, "  Packets received: %u", stats.packet_count);
-      ESP_LOGI(TAG, "  Average interval: %u seconds", avg_interval_sec);
-      ESP_LOGI(TAG, "  Last seen: %u seconds ago", elapsed_sec);
-
-      // Frame type statistics
-      ESP_LOGI(TAG, "  Frame types: compact=%u, long=%u, last=%s",
-               stats.compact_frame_count, stats.long_frame_count, stats.last_frame_type.c_str());
-      if (stats.compact_frame_count + stats.long_frame_count > 0) {
-        float compact_ratio = (float)stats.compact_frame_count / (stats.compact_frame_count + stats.long_frame_count) * 100.0f;
-        ESP_LOGI(TAG, "  Compact ratio: %.1f%% (expect ~87.5%% = 7/8)", compact_ratio);
+  this->publish_ring_stats_();
+
+  // Periodic counter summary; replaces per-telegram logging in the quiet profile
+  ESP_LOGD(TAG, "Telegrams: received=%u, valid=%u, CRC errors=%u, ID mismatches=%u, parse errors=%u",
+           this->packets_received_, this->packets_valid_, this->crc_errors_, this->id_mismatches_,
+           this->parse_errors_);
+
+  // Per-meter transmission statistics
+  for (WMBusMeter *meter : this->meters_) {
+    if (meter != nullptr) {
+      this->log_meter_stats_(meter, now);
+    }
+  }
+
+  if (this->early_reject_) {
+    this->log_early_reject_stats_(now);
+  }
+
+  this->log_mode_schedule_(now);
+
+  if (this->rx_windowing_) {
+    this->log_rx_window_stats_();
+  }
+
+  if (this->mode_ == RadioMode::T1 || this->dual_mode_) {
+    ESP_LOGD(TAG, "T1: %u symbol errors, %u block CRC errors, %u too long for the FIFO",
+             (unsigned) this->t1_symbol_errors_, (unsigned) this->t1_block_crc_errors_, (unsigned) this->t1_too_long_);
+  }
+
+  if (this->fifo_streaming_) {
+    ESP_LOGD(TAG, "FIFO streaming: %u threshold/end wakes, %u long telegrams, %u lost to overflow",
+             (unsigned) this->fifo_wakes_, (unsigned) this->long_telegrams_, (unsigned) this->fifo_overflows_);
+  }
+
+  if (this->keystream_prediction_) {
+    for (WMBusMeter *meter : this->meters_) {
+      if (meter != nullptr) {
+        this->update_keystream_prediction_(meter, now);
       }
+    }
+    this->publish_keystream_stats_();
+  }
+
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  ESP_LOGD(TAG, "Census: %u meters heard (capacity %u, %u evicted)", (unsigned) this->census_.size(),
+           (unsigned) this->census_.MAX_ENTRIES, (unsigned) this->census_.get_eviction_count());
+  if (this->census_meters_sensor_ != nullptr) {
+    this->census_meters_sensor_->publish_state(this->census_.size());
+  }
+#endif
+
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  this->log_latency_histograms_(false);
+  this->publish_latency_stats_();
+#endif
+
+  float spi_saved_per_hour = this->watchdog_.get_spi_transactions_saved_per_hour(now);
+  ESP_LOGD(TAG, "Supervision: quiet %u s, window %u s, probes=%u, recoveries=%u, ~%.0f SPI transactions/h saved",
+           (unsigned) (this->watchdog_.get_quiet_ms(now) / 1000),
+           (unsigned) (this->watchdog_.get_silence_window_ms() / 1000), (unsigned) this->watchdog_.get_probe_count(),
+           (unsigned) this->watchdog_.get_recovery_count(), spi_saved_per_hour);
+  if (this->spi_transactions_saved_sensor_ != nullptr) {
+    this->spi_transactions_saved_sensor_->publish_state(spi_saved_per_hour);
+  }
+
+  RecoveryKind recovery_kind = this->radio_.get_last_recovery_kind();
+  if (this->recovery_time_sensor_ != nullptr && recovery_kind != RecoveryKind::NONE &&
+      this->radio_.get_recovery_count() != this->recoveries_published_) {
+    this->recoveries_published_ = this->radio_.get_recovery_count();
+    this->recovery_time_sensor_->publish_state(this->radio_.get_last_recovery_us(recovery_kind));
+  }
+  if (this->time_to_first_rx_sensor_ != nullptr && !this->time_to_first_rx_published_ &&
+      this->radio_.get_time_to_first_rx_us() != 0) {
+    this->time_to_first_rx_published_ = true;
+    this->time_to_first_rx_sensor_->publish_state(this->radio_.get_time_to_first_rx_us());
+  }
+}
+
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+void Multical21WMBusComponent::set_latency_sensor(LatencyStage stage, uint8_t percentile, sensor::Sensor *sensor) {
+  uint8_t index = static_cast<uint8_t>(stage);
+  if (percentile == 50) {
+    this->latency_p50_sensors_[index] = sensor;
+  } else if (percentile == 99) {
+    this->latency_p99_sensors_[index] = sensor;
+  }
+}
+
+void Multical21WMBusComponent::log_latency_histograms_(bool with_buckets) {
+  // Histograms count CPU cycles; report in microseconds
+  float cycles_per_us = arch_get_cpu_freq_hz() / 1e6f;
+
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    LatencyStage stage = static_cast<LatencyStage>(i);
+    const LatencyHistogram &hist = this->latency_.get(stage);
+    if (hist.get_count() == 0) {
+      continue;
+    }
+    ESP_LOGD(TAG, "Latency %-10s n=%u p50<=%.1fus p99<=%.1fus max=%.1fus", latency_stage_to_string(stage),
+             (unsigned) hist.get_count(), hist.percentile(50) / cycles_per_us, hist.percentile(99) / cycles_per_us,
+             hist.get_max() / cycles_per_us);
 
-      if (time_until_next_sec > 0) {
-        ESP_LOGI(TAG, "  Next packet expected in: ~%d seconds", time_until_next_sec);
-      } else {
-        ESP_LOGI(TAG, "  Next packet: OVERDUE by %d seconds", -time_until_next_sec);
+    if (!with_buckets) {
+      continue;
+    }
+    // Non-empty buckets as "<=upper_us:count"
+    char line[256] = "";
+    size_t pos = 0;
+    for (uint8_t b = 0; b < LatencyHistogram::BUCKET_COUNT && pos < sizeof(line); b++) {
+      if (hist.get_bucket(b) == 0) {
+        continue;
       }
-    } else {
-      ESP_LOGI(TAG, "  Packets received: 1");
-      ESP_LOGI(TAG, "  Last seen: %u seconds ago", elapsed_sec);
-      ESP_LOGI(TAG, "  Frame type: %s", stats.last_frame_type.c_str());
-      ESP_LOGI(TAG, "  (Need at least 2 packets to calculate interval)");
+      pos += snprintf(line + pos, sizeof(line) - pos, " <=%.1f:%u",
+                      LatencyHistogram::bucket_upper_bound(b) / cycles_per_us, (unsigned) hist.get_bucket(b));
+    }
+    ESP_LOGD(TAG, "  buckets (us):%s", line);
+  }
+}
+
+void Multical21WMBusComponent::publish_latency_stats_() {
+  float cycles_per_us = arch_get_cpu_freq_hz() / 1e6f;
+
+  for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+    const LatencyHistogram &hist = this->latency_.get(static_cast<LatencyStage>(i));
+    if (hist.get_count() == 0) {
+      continue;
+    }
+    if (this->latency_p50_sensors_[i] != nullptr) {
+      this->latency_p50_sensors_[i]->publish_state(hist.percentile(50) / cycles_per_us);
+    }
+    if (this->latency_p99_sensors_[i] != nullptr) {
+      this->latency_p99_sensors_[i]->publish_state(hist.percentile(99) / cycles_per_us);
+    }
+  }
+}
+#endif
+
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+void Multical21WMBusComponent::record_census_(const uint8_t *packet_data, int16_t rssi_dbm) {
+  uint16_t manufacturer = packet_data[OFFSET_M_FIELD] | (packet_data[OFFSET_M_FIELD + 1] << 8);
+  this->census_.record(meter_id_from_le(&packet_data[OFFSET_METER_ID]), manufacturer,
+                       packet_data[OFFSET_VERSION], packet_data[OFFSET_DEVICE_TYPE], rssi_dbm, millis());
+}
+
+std::string Multical21WMBusComponent::census_json() const {
+  std::string json;
+  json.reserve(this->census_.size() * 130 + 2);
+  this->census_.to_json(json, millis());
+  return json;
+}
+#endif
+
+void Multical21WMBusComponent::update_keystream_prediction_(WMBusMeter *meter, uint32_t now) {
+  // Every transmission advances the access number, so a silence spanning
+  // several learned intervals means telegrams were missed. Slide the
+  // predicted window so it still covers the next one we will hear.
+  const MeterStats &stats = meter->get_stats();
+  if (stats.packet_count < 2) {
+    return;
+  }
+  uint32_t avg_interval_ms = stats.total_interval_ms / (stats.packet_count - 1);
+  if (avg_interval_ms == 0) {
+    return;
+  }
+  uint32_t intervals = (now - stats.last_seen_ms) / avg_interval_ms;
+  uint32_t skip = intervals > 1 ? intervals - 1 : 0;
+  meter->get_crypto().set_prediction_skip(skip > 255 ? 255 : skip);
+  this->keystream_precompute_pending_ = true;
+}
+
+void Multical21WMBusComponent::publish_keystream_stats_() {
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  for (const WMBusMeter *meter : this->meters_) {
+    if (meter != nullptr) {
+      hits += meter->get_crypto().get_keystream_hits();
+      misses += meter->get_crypto().get_keystream_misses();
     }
-    ESP_LOGI(TAG, "===========================================================");
-    break;  // Found our meter, no need to continue
   }
 
-  if (!found_our_meter) {
+  // Average latency saved per hit: full AES-CTR decrypt vs XOR with the stored keystream
+  float saved_us = NAN;
+  if (hits > 0 && this->decrypt_full_count_ > 0) {
+    saved_us = (float) this->decrypt_full_us_total_ / this->decrypt_full_count_ -
+               (float) this->decrypt_hit_us_total_ / hits;
+  }
+
+  if (hits + misses > 0) {
+    ESP_LOGD(TAG, "Keystream prediction: %u hits, %u misses, ~%.0f us saved per hit",
+             hits, misses, saved_us);
+  }
+  if (this->keystream_hit_rate_sensor_ != nullptr && hits + misses > 0) {
+    this->keystream_hit_rate_sensor_->publish_state(100.0f * hits / (hits + misses));
+  }
+  if (this->keystream_latency_saved_sensor_ != nullptr && !std::isnan(saved_us)) {
+    this->keystream_latency_saved_sensor_->publish_state(saved_us);
+  }
+}
+
+void Multical21WMBusComponent::log_meter_stats_(const WMBusMeter *meter, uint32_t now) {
+  const MeterStats &stats = meter->get_stats();
+
+  if (stats.packet_count == 0) {
     // Display meter ID in the same order as printed on the physical meter
-    ESP_LOGI(TAG, "Configured meter %02X%02X%02X%02X not detected yet",
-             this->meter_id_[0], this->meter_id_[1], this->meter_id_[2], this->meter_id_[3]);
+    ESP_LOGI(TAG, "Configured meter %08X not detected yet", (unsigned) stats.meter_id);
+    return;
+  }
+
+  // Calculate time since last packet
+  uint32_t elapsed_ms = now - stats.last_seen_ms;
+  uint32_t elapsed_sec = elapsed_ms / 1000;
+
+  ESP_LOGI(TAG, "===========================================================");
+  ESP_LOGI(TAG, "METER: %08X", (unsigned) stats.meter_id);
+  ESP_LOGI(TAG, "===========================================================");
+
+  if (stats.packet_count > 1) {
+    uint32_t avg_interval_ms = stats.total_interval_ms / (stats.packet_count - 1);
+    uint32_t avg_interval_sec = avg_interval_ms / 1000;
+
+    // Calculate estimated time until next packet
+    int32_t time_until_next_sec = avg_interval_sec - elapsed_sec;
+
+    ESP_LOGI(TAG, "  Packets received: %u", stats.packet_count);
+    ESP_LOGI(TAG, "  Average interval: %u seconds", avg_interval_sec);
+    ESP_LOGI(TAG, "  Last seen: %u seconds ago", elapsed_sec);
+    if (meter->get_signal_count() > 0) {
+      ESP_LOGI(TAG, "  Signal: RSSI %d dBm (avg %.1f), LQI %u (avg %.1f)", meter->get_last_rssi_dbm(),
+               meter->get_rssi_avg_dbm(), meter->get_last_lqi(), meter->get_lqi_avg());
+    }
+
+    // Frame type statistics
+    ESP_LOGI(TAG, "  Frame types: compact=%u, long=%u, last=%s",
+             stats.compact_frame_count, stats.long_frame_count, frame_type_to_string(stats.last_frame_type));
+    if (stats.compact_frame_count + stats.long_frame_count > 0) {
+      float compact_ratio = (float)stats.compact_frame_count / (stats.compact_frame_count + stats.long_frame_count) * 100.0f;
+      ESP_LOGI(TAG, "  Compact ratio: %.1f%% (expect ~87.5%% = 7/8)", compact_ratio);
+    }
+
+    if (time_until_next_sec > 0) {
+      ESP_LOGI(TAG, "  Next packet expected in: ~%d seconds", time_until_next_sec);
+    } else {
+      ESP_LOGI(TAG, "  Next packet: OVERDUE by %d seconds", -time_until_next_sec);
+    }
+  } else {
+    ESP_LOGI(TAG, "  Packets received: 1");
+    ESP_LOGI(TAG, "  Last seen: %u seconds ago", elapsed_sec);
+    ESP_LOGI(TAG, "  Frame type: %s", frame_type_to_string(stats.last_frame_type));
+    ESP_LOGI(TAG, "  (Need at least 2 packets to calculate interval)");
+  }
+  ESP_LOGI(TAG, "===========================================================");
+}
+
+void Multical21WMBusComponent::publish_ring_stats_() {
+  if (this->ring_high_water_mark_sensor_ != nullptr) {
+    this->ring_high_water_mark_sensor_->publish_state(this->packet_buffer_.get_high_water_mark());
+  }
+  if (this->ring_dropped_packets_sensor_ != nullptr) {
+    this->ring_dropped_packets_sensor_->publish_state(this->packet_buffer_.get_drop_count());
+  }
+  if (this->ring_depth_sensor_ != nullptr) {
+    this->ring_depth_sensor_->publish_state(this->packet_buffer_.size());
+  }
+}
+
+void Multical21WMBusComponent::log_early_reject_stats_(uint32_t now) {
+  // Each skipped byte is 8 SPI clocks at 4 MHz = 2 us of bus time
+  uint32_t spi_saved_us = this->early_reject_bytes_skipped_ * 2;
+  float hours = now / 3600000.0f;
+  ESP_LOGI(TAG, "Early reject: %u rejected early, %u fully read, %u bytes skipped (~%u us SPI)",
+           this->frames_rejected_early_, this->frames_read_fully_,
+           this->early_reject_bytes_skipped_, spi_saved_us);
+  if (hours > 0.0f) {
+    ESP_LOGI(TAG, "  Rejected %.1f frames/hour, saving ~%.0f us SPI/hour",
+             this->frames_rejected_early_ / hours, spi_saved_us / hours);
   }
 }
 
 void Multical21WMBusComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "Multical21 wMBUS Receiver:");
+  if (this->dual_mode_) {
+    ESP_LOGCONFIG(TAG, "  Mode: C1 + T1 time-sliced (%u C1 meters, %u T1 meters)",
+                  (unsigned) this->mode_scheduler_.meter_count(RadioMode::C1),
+                  (unsigned) this->mode_scheduler_.meter_count(RadioMode::T1));
+  } else {
+    ESP_LOGCONFIG(TAG, "  Mode: %s (%s MHz)", radio_mode_to_string(this->mode_),
+                  this->mode_ == RadioMode::T1 ? "868.30" : "868.95");
+  }
   ESP_LOGCONFIG(TAG, "  GDO0 Pin: GPIO%u", this->gdo0_pin_);
-  LOG_SENSOR("  ", "Total Consumption", this->total_consumption_sensor_);
-  LOG_SENSOR("  ", "Target Consumption", this->target_consumption_sensor_);
-  LOG_SENSOR("  ", "Flow Temperature", this->flow_temperature_sensor_);
-  LOG_SENSOR("  ", "Ambient Temperature", this->ambient_temperature_sensor_);
-
-  // Display meter ID in the same order as printed on the physical meter
-  ESP_LOGCONFIG(TAG, "  Meter ID: %02X%02X%02X%02X",
-                this->meter_id_[0], this->meter_id_[1], this->meter_id_[2], this->meter_id_[3]);
-  ESP_LOGCONFIG(TAG, "  Statistics: Received=%u, Valid=%u, CRC Errors=%u, ID Mismatches=%u",
-                this->packets_received_, this->packets_valid_, this->crc_errors_, this->id_mismatches_);
+  if (this->fifo_streaming_) {
+    ESP_LOGCONFIG(TAG, "  GDO2 Pin: GPIO%u (FIFO streaming, telegrams up to %u bytes)", this->gdo2_pin_,
+                  MAX_PACKET_SIZE);
+  }
+  LOG_SENSOR("  ", "Ring High Water Mark", this->ring_high_water_mark_sensor_);
+  LOG_SENSOR("  ", "Ring Dropped Packets", this->ring_dropped_packets_sensor_);
+  LOG_SENSOR("  ", "Ring Depth", this->ring_depth_sensor_);
+  LOG_SENSOR("  ", "Keystream Hit Rate", this->keystream_hit_rate_sensor_);
+  LOG_SENSOR("  ", "Keystream Latency Saved", this->keystream_latency_saved_sensor_);
+  LOG_SENSOR("  ", "SPI Transactions Saved", this->spi_transactions_saved_sensor_);
+  LOG_SENSOR("  ", "Recovery Time", this->recovery_time_sensor_);
+  LOG_SENSOR("  ", "Time To First RX", this->time_to_first_rx_sensor_);
+  LOG_SENSOR("  ", "C1 Capture Rate", this->capture_rate_sensors_[static_cast<uint8_t>(RadioMode::C1)]);
+  LOG_SENSOR("  ", "T1 Capture Rate", this->capture_rate_sensors_[static_cast<uint8_t>(RadioMode::T1)]);
+
+  ESP_LOGCONFIG(TAG, "  Meters: %u", (unsigned) METER_COUNT);
+  for (WMBusMeter *meter : this->meters_) {
+    if (meter != nullptr) {
+      meter->dump_config();
+    }
+  }
+  ESP_LOGCONFIG(TAG, "  Packet Ring: %u slots (high water %u, dropped %u)",
+                (unsigned) this->packet_buffer_.capacity(), (unsigned) this->packet_buffer_.get_high_water_mark(),
+                (unsigned) this->packet_buffer_.get_drop_count());
+  ESP_LOGCONFIG(TAG, "  Continuous RX: %s", YESNO(this->continuous_rx_));
+  if (this->rx_windowing_) {
+    ESP_LOGCONFIG(TAG, "  RX Windowing: guard %u ms (widens on misses up to interval/%u)%s",
+                  (unsigned) this->rx_window_.get_guard_ms(), (unsigned) RX_WINDOW_MAX_GUARD_DIVISOR,
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+                  ", light sleep between windows");
+#else
+                  "");
+#endif
+    LOG_SENSOR("  ", "RX Duty Cycle", this->rx_duty_cycle_sensor_);
+  }
+#ifdef MULTICAL21_WMBUS_QUIET_LOGGING
+  ESP_LOGCONFIG(TAG, "  Log Profile: quiet (per-telegram logging compiled out)");
+#else
+  ESP_LOGCONFIG(TAG, "  Log Profile: verbose");
+#endif
+  ESP_LOGCONFIG(TAG, "  Early Reject: %s", YESNO(this->early_reject_));
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  ESP_LOGCONFIG(TAG, "  Census: %u slots, up to %u meters (%u heard, %u evicted)",
+                (unsigned) MULTICAL21_WMBUS_CENSUS_SIZE, (unsigned) this->census_.MAX_ENTRIES,
+                (unsigned) this->census_.size(), (unsigned) this->census_.get_eviction_count());
+  LOG_SENSOR("  ", "Census Meters", this->census_meters_sensor_);
+#else
+  ESP_LOGCONFIG(TAG, "  Census: disabled");
+#endif
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  ESP_LOGCONFIG(TAG, "  Latency Histograms: enabled");
+  this->log_latency_histograms_(true);
+#endif
+  ESP_LOGCONFIG(TAG, "  Keystream Prediction: %s", YESNO(this->keystream_prediction_));
+  if (this->keystream_prediction_) {
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    for (const WMBusMeter *meter : this->meters_) {
+      if (meter != nullptr) {
+        hits += meter->get_crypto().get_keystream_hits();
+        misses += meter->get_crypto().get_keystream_misses();
+      }
+    }
+    ESP_LOGCONFIG(TAG, "    Hits: %u, Misses: %u", (unsigned) hits, (unsigned) misses);
+  }
+  ESP_LOGCONFIG(TAG, "  Radio state: %s (last RX start %u us, recoveries %u)",
+                CC1101Radio::state_to_string(this->radio_.get_state()),
+                (unsigned) this->radio_.get_last_rx_start_us(), (unsigned) this->radio_.get_recovery_count());
+  ESP_LOGCONFIG(TAG, "  Boot: %s, first RX after %u us, register mismatches %u",
+                this->radio_.is_fast_boot() ? "fast (profile kept)" : "cold",
+                (unsigned) this->radio_.get_time_to_first_rx_us(),
+                (unsigned) this->radio_.get_register_mismatch_count());
+  ESP_LOGCONFIG(TAG, "  Recovery: warm %u (last %u us, profile %u us), cold %u (last %u us), calibration %s",
+                (unsigned) this->radio_.get_warm_recovery_count(),
+                (unsigned) this->radio_.get_last_recovery_us(RecoveryKind::WARM),
+                (unsigned) this->radio_.get_last_warm_config_us(),
+                (unsigned) (this->radio_.get_recovery_count() - this->radio_.get_warm_recovery_count()),
+                (unsigned) this->radio_.get_last_recovery_us(RecoveryKind::COLD),
+                this->radio_.has_calibration_cache() ? "cached" : "not cached");
+  ESP_LOGCONFIG(TAG, "  Supervision: silence window %u s, probes %u, watchdog recoveries %u",
+                (unsigned) (this->watchdog_.get_silence_window_ms() / 1000),
+                (unsigned) this->watchdog_.get_probe_count(), (unsigned) this->watchdog_.get_recovery_count());
+  if (this->packets_received_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Receiver deaf time: %u us/packet average",
+                  (unsigned) (this->total_deaf_time_us_ / this->packets_received_));
+  }
+  ESP_LOGCONFIG(TAG, "  Statistics: Received=%u, Valid=%u, CRC Errors=%u, ID Mismatches=%u, Parse Errors=%u",
+                this->packets_received_, this->packets_valid_, this->crc_errors_, this->id_mismatches_,
+                this->parse_errors_);
 }
 
 // ============================================================================
@@ -410,109 +1299,319 @@ void Multical21WMBusComponent::dump_config() {
 void IRAM_ATTR Multical21WMBusComponent::packet_isr_(Multical21WMBusComponent *instance) {
   // CRITICAL TIMING PATH - Minimal ISR: just set flag and wake loop
   // Per WMBUS_IMPLEMENTATION_SPEC.md Section 5.1:
-  // - GDO0 falling edge = packet complete, data in FIFO
+  // - GDO0 falling edge = packet complete, data in FIFO (continuous RX:
+  //   FIFO threshold reached)
   // - Must read FIFO quickly before next packet arrives
   // - Use enable_loop_soon_any_context() to wake loop ASAP
   //
   // Design: ISR only sets flag, loop() reads FIFO immediately when woken
 
+  instance->isr_time_us_ = micros();
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  instance->isr_cycles_ = arch_get_cpu_cycle_count();
+#endif
   instance->packet_ready_ = true;
   instance->enable_loop_soon_any_context();
 }
 
-void Multical21WMBusComponent::process_packet_(const uint8_t *packet_data,
-                                                uint8_t packet_length) {
+void IRAM_ATTR Multical21WMBusComponent::fifo_isr_(Multical21WMBusComponent *instance) {
+  // GDO2 rising: RX FIFO reached the threshold while a telegram arrives
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  instance->isr_cycles_ = arch_get_cpu_cycle_count();
+#endif
+  instance->fifo_ready_ = true;
+  instance->enable_loop_soon_any_context();
+}
+
+void Multical21WMBusComponent::process_packet_(const uint8_t *packet_data, uint16_t packet_length, int16_t rssi_dbm,
+                                                uint8_t lqi, DecodeVerdict verdict) {
   uint8_t length = packet_data[0];
 
   // Guard clauses for validation
-  if (!this->validate_packet_structure_(packet_data, length, packet_length)) {
+  if (!this->validate_packet_structure_(length, packet_length)) {
     return;
   }
 
-  // Check if it's our meter (guard clause)
-  uint8_t meter_id[4] = {packet_data[4], packet_data[5], packet_data[6], packet_data[7]};
-  if (!this->is_our_meter_id_(meter_id)) {
+  // Any well-formed telegram, ours or not, shows the radio is receiving
+  this->watchdog_.feed(millis());
+
+  // Check if it's one of our meters (guard clause)
+  WMBusMeter *meter = this->find_meter_(&packet_data[OFFSET_METER_ID]);
+  if (meter == nullptr) {
+    this->id_mismatches_++;
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+    // Only census headers that pass CRC, so noise does not become meters
+    bool crc_ok;
+    if (verdict == DecodeVerdict::NONE) {
+      uint16_t packet_crc = (packet_data[length - 1] << 8) | packet_data[length];
+      crc_ok = WMBusCrypto::calculate_crc(packet_data, length - 1) == packet_crc;
+    } else {
+      crc_ok = verdict != DecodeVerdict::CRC_FAILED;
+    }
+    if (crc_ok) {
+      this->record_census_(packet_data, rssi_dbm);
+    }
+#endif
     return;  // Not our meter, skip silently
   }
 
-  ESP_LOGI(TAG, "========================================");
-  ESP_LOGI(TAG, "*** PROCESSING OUR METER ***");
-  ESP_LOGI(TAG, "========================================");
+  WMBUS_HOT_LOGI(TAG, "========================================");
+  WMBUS_HOT_LOGI(TAG, "*** PROCESSING METER %08X ***", (unsigned) meter->get_meter_id());
+  WMBUS_HOT_LOGI(TAG, "========================================");
 
-  // Verify CRC (guard clause)
-  if (!this->verify_packet_crc_(packet_data, length)) {
+  // Verify CRC (guard clause); the pipelined decoder may already have done it
+  if (verdict == DecodeVerdict::CRC_FAILED) {
+    ESP_LOGW(TAG, "CRC verification FAILED (checked during FIFO read)");
+    this->crc_errors_++;
     return;
   }
+  if (verdict == DecodeVerdict::NONE && !this->verify_packet_crc_(packet_data, length)) {
+    return;
+  }
+
+  // Only telegrams that pass CRC count towards the meter's signal averages
+  meter->record_signal(rssi_dbm, lqi);
+  this->mode_scheduler_.record(find_meter_index(meter->get_meter_id()), millis(),
+                               packet_data[OFFSET_ACCESS_NUMBER]);
+
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  this->record_census_(packet_data, rssi_dbm);
+#endif
 
-  // Decrypt payload
-  uint8_t plaintext[MAX_PACKET_SIZE];
+  // Decrypt payload, unless it was decrypted in place while being read
+  uint8_t plaintext_buffer[MAX_PACKET_SIZE];
+  const uint8_t *plaintext = plaintext_buffer;
   uint8_t plaintext_length;
-  if (!this->decrypt_packet_payload_(packet_data, length, plaintext, plaintext_length)) {
-    return;
+  if (verdict == DecodeVerdict::DECRYPTED) {
+    plaintext = &packet_data[OFFSET_CIPHER_START];
+    plaintext_length = length - CRC_SIZE - OFFSET_CIPHER_START + 1;
+  } else {
+    if (!this->decrypt_packet_payload_(meter, packet_data, length, plaintext_buffer, plaintext_length)) {
+      return;
+    }
+    WMBUS_LATENCY_END(this->latency_, LatencyStage::PLAINTEXT_READY, this->isr_cycles_);
   }
 
   // Parse meter data using parser helper
+  WMBUS_LATENCY_BEGIN(parse_start);
   WMBusMeterData data = this->parser_.parse(plaintext, plaintext_length);
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::PARSE, parse_start);
   if (!data.valid) {
     ESP_LOGW(TAG, "Failed to parse meter data");
+    this->parse_errors_++;
     return;
   }
 
   // Update statistics (now that we have frame_type from parsing)
-  uint32_t meter_id_uint = (meter_id[3] << 24) | (meter_id[2] << 16) |
-                           (meter_id[1] << 8) | meter_id[0];
-  this->update_meter_stats_(meter_id_uint, data.frame_type);
+  this->update_meter_stats_(meter, data.frame_type);
+
+  // Key and IV are confirmed good: predict the next access numbers
+  if (this->keystream_prediction_) {
+    meter->get_crypto().predict_next(packet_data);
+    this->keystream_precompute_pending_ = true;
+  }
 
-  // Publish data to sensors
-  this->publish_meter_data_(data);
+  // Publish data to the meter's sensors
+  WMBUS_LATENCY_BEGIN(publish_start);
+  meter->publish(data);
+  WMBUS_LATENCY_END(this->latency_, LatencyStage::PUBLISH, publish_start);
 
   // Success!
   this->packets_valid_++;
-  ESP_LOGI(TAG, "========================================");
-  ESP_LOGI(TAG, "Packet processed successfully!");
-  ESP_LOGI(TAG, "Total valid packets: %u", this->packets_valid_);
-  ESP_LOGI(TAG, "========================================");
+  WMBUS_HOT_LOGI(TAG, "========================================");
+  WMBUS_HOT_LOGI(TAG, "Packet processed successfully!");
+  WMBUS_HOT_LOGI(TAG, "Total valid packets: %u", this->packets_valid_);
+  WMBUS_HOT_LOGI(TAG, "========================================");
 }
 
-void Multical21WMBusComponent::publish_meter_data_(const WMBusMeterData &data) {
-  // Publish to ESPHome sensors
-  if (this->total_consumption_sensor_ != nullptr) {
-    this->total_consumption_sensor_->publish_state(data.total_consumption_m3);
+// ============================================================================
+// Health Monitoring
+// ============================================================================
+
+void Multical21WMBusComponent::supervise_radio_() {
+  // Powered down between RX windows: any SPI access would wake the chip
+  if (this->radio_.is_sleeping()) {
+    return;
   }
-  if (this->target_consumption_sensor_ != nullptr) {
-    this->target_consumption_sensor_->publish_state(data.target_consumption_m3);
+  // A restart or recovery is already in progress; the state machine owns the radio
+  if (!this->radio_.is_receiving()) {
+    ESP_LOGD(TAG, "Radio state: %s", CC1101Radio::state_to_string(this->radio_.get_state()));
+    return;
   }
-  if (this->flow_temperature_sensor_ != nullptr) {
-    this->flow_temperature_sensor_->publish_state(data.flow_temperature_c);
+
+  uint32_t now = millis();
+  this->watchdog_.set_expected_interval(this->shortest_meter_interval_ms_());
+  uint32_t quiet_sec = this->watchdog_.get_quiet_ms(now) / 1000;
+
+  switch (this->watchdog_.check(now)) {
+    case WatchdogAction::NONE:
+      break;  // Telegrams are flowing; no SPI traffic
+    case WatchdogAction::PROBE:
+      ESP_LOGD(TAG, "No telegram for %u s (expected within %u s) - probing radio", (unsigned) quiet_sec,
+               (unsigned) (this->watchdog_.get_silence_window_ms() / 1000));
+      this->probe_radio_();
+      break;
+    case WatchdogAction::RECOVER:
+      ESP_LOGW(TAG, "No telegram for %u s - restarting radio", (unsigned) quiet_sec);
+      // A warm restart first; if the previous one brought nothing back, reset the chip
+      this->radio_.recover(this->watchdog_.get_consecutive_recoveries() > 1);
+      break;
   }
-  if (this->ambient_temperature_sensor_ != nullptr) {
-    this->ambient_temperature_sensor_->publish_state(data.ambient_temperature_c);
+}
+
+void Multical21WMBusComponent::check_radio_registers_() {
+  // Mid-recovery the registers are being rewritten anyway
+  if (!this->radio_.is_receiving()) {
+    return;
   }
-  if (this->info_codes_sensor_ != nullptr) {
-    this->info_codes_sensor_->publish_state(data.status.c_str());
+  if (!this->radio_.verify_registers()) {
+    // Brown-out or glitch: the cached calibration cannot be trusted either
+    ESP_LOGW(TAG, "Radio registers no longer match the profile - reconfiguring");
+    this->radio_.recover(true);
   }
-  ESP_LOGI(TAG, "Meter data published to sensors");
 }
 
-// ============================================================================
-// Health Monitoring
-// ============================================================================
+void Multical21WMBusComponent::schedule_mode_() {
+  uint32_t now = millis();
+  this->mode_scheduler_.account(now, this->mode_);
+
+  // Never cut a telegram short: GDO0 is high from the sync word to the end
+  // of the packet, and a streamed telegram may be between threshold wakes
+  if (!this->radio_.is_receiving() || this->packet_ready_ || this->fifo_pkt_ != nullptr ||
+      digitalRead(this->gdo0_pin_)) {
+    return;
+  }
+
+  RadioMode mode = this->mode_scheduler_.select(now, this->mode_);
+  if (mode == this->mode_) {
+    return;
+  }
+  WMBUS_HOT_LOGD(TAG, "Switching to %s", radio_mode_to_string(mode));
+  this->mode_ = mode;
+  this->restart_started_us_ = micros();
+  this->restart_pending_ = true;
+  this->radio_.switch_mode(mode);
+  this->high_freq_loop_.start();
+}
+
+void Multical21WMBusComponent::log_mode_schedule_(uint32_t now) {
+  float rates[RADIO_MODE_COUNT];
+  for (uint8_t m = 0; m < RADIO_MODE_COUNT; m++) {
+    rates[m] = this->mode_scheduler_.get_capture_rate(static_cast<RadioMode>(m), now);
+    if (this->capture_rate_sensors_[m] != nullptr && rates[m] >= 0.0f) {
+      this->capture_rate_sensors_[m]->publish_state(rates[m]);
+    }
+  }
+  if (!this->dual_mode_) {
+    return;
+  }
+  for (uint8_t m = 0; m < RADIO_MODE_COUNT; m++) {
+    RadioMode mode = static_cast<RadioMode>(m);
+    if (rates[m] < 0.0f) {
+      ESP_LOGD(TAG, "Mode schedule: %s %.0f%% of the time, no meter interval learned yet", radio_mode_to_string(mode),
+               this->mode_scheduler_.get_time_share(mode));
+    } else {
+      ESP_LOGD(TAG, "Mode schedule: %s %.0f%% of the time, %.1f%% of telegrams captured", radio_mode_to_string(mode),
+               this->mode_scheduler_.get_time_share(mode), rates[m]);
+    }
+  }
+  ESP_LOGD(TAG, "Mode schedule: %u switches (%u-register delta each), %u repeated telegrams ignored",
+           (unsigned) this->radio_.get_mode_switch_count(), this->radio_.get_last_mode_delta_bytes(),
+           (unsigned) this->mode_scheduler_.get_ignored_count());
+}
 
-void Multical21WMBusComponent::log_radio_status_() {
-  // Just log status for diagnostics, don't process packets
+void Multical21WMBusComponent::update_rx_window_() {
+  uint32_t now = millis();
+  bool sleeping = this->radio_.get_state() == RadioState::SLEEP;
+  this->rx_window_.account(now, !sleeping);
+  uint32_t opens_in = this->rx_window_.update(this->mode_scheduler_, now);
+
+  if (sleeping) {
+    if (opens_in <= RX_WINDOW_WAKE_LEAD_MS) {
+      WMBUS_HOT_LOGD(TAG, "RX window opens - waking radio");
+      this->radio_.wake();
+      return;
+    }
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+    // Buffered telegrams and keystream precomputation go first
+    if (this->packet_buffer_.size() == 0 && !this->keystream_precompute_pending_) {
+      this->light_sleep_(opens_in - RX_WINDOW_WAKE_LEAD_MS);
+    }
+#endif
+    return;
+  }
+
+  // Never cut a telegram short (as for mode switches)
+  if (opens_in > RX_WINDOW_WAKE_LEAD_MS + RX_WINDOW_MIN_OFF_MS && this->radio_.is_receiving() &&
+      !this->packet_ready_ && this->fifo_pkt_ == nullptr && !digitalRead(this->gdo0_pin_)) {
+    WMBUS_HOT_LOGD(TAG, "Next RX window in %u ms - powering radio down", (unsigned) opens_in);
+    this->radio_.power_down();
+  }
+}
+
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+void Multical21WMBusComponent::light_sleep_(uint32_t sleep_ms) {
+  if (sleep_ms < LIGHT_SLEEP_MIN_MS) {
+    return;
+  }
+  // Bounded so the rest of ESPHome still gets a loop() now and then
+  if (sleep_ms > LIGHT_SLEEP_MAX_MS) {
+    sleep_ms = LIGHT_SLEEP_MAX_MS;
+  }
+  uint32_t start_ms = millis();
+  esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(sleep_ms) * 1000);
+  esp_light_sleep_start();
+  this->light_sleep_ms_ += millis() - start_ms;
+}
+#endif
+
+void Multical21WMBusComponent::log_rx_window_stats_() {
+  float duty_cycle = this->rx_window_.get_duty_cycle();
+  float hit_rate = this->rx_window_.get_hit_rate();
+  if (hit_rate < 0.0f) {
+    ESP_LOGD(TAG, "RX windowing: radio on %.1f%% of the time, no window judged yet", duty_cycle);
+  } else {
+    ESP_LOGD(TAG, "RX windowing: radio on %.1f%% of the time, %.1f%% of windows caught their telegram (%u hit, %u missed)",
+             duty_cycle, hit_rate, (unsigned) this->rx_window_.get_hits(), (unsigned) this->rx_window_.get_misses());
+  }
+  ESP_LOGD(TAG, "  Widest guard %u ms, %u surveys, %u power-downs, last wake to RX %u us",
+           (unsigned) this->rx_window_.get_widest_guard_ms(), (unsigned) this->rx_window_.get_survey_count(),
+           (unsigned) this->radio_.get_power_down_count(), (unsigned) this->radio_.get_last_wake_us());
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+  uint32_t now = millis();
+  if (now > 0) {
+    ESP_LOGD(TAG, "  MCU in light sleep %.1f%% of the time", 100.0f * this->light_sleep_ms_ / now);
+  }
+#endif
+  if (this->rx_duty_cycle_sensor_ != nullptr) {
+    this->rx_duty_cycle_sensor_->publish_state(duty_cycle);
+  }
+}
+
+uint32_t Multical21WMBusComponent::shortest_meter_interval_ms_() const {
+  uint32_t shortest_ms = 0;
+  for (const WMBusMeter *meter : this->meters_) {
+    if (meter == nullptr || meter->get_stats().packet_count < 2) {
+      continue;
+    }
+    const MeterStats &stats = meter->get_stats();
+    uint32_t avg_interval_ms = stats.total_interval_ms / (stats.packet_count - 1);
+    if (shortest_ms == 0 || avg_interval_ms < shortest_ms) {
+      shortest_ms = avg_interval_ms;
+    }
+  }
+  return shortest_ms;
+}
+
+void Multical21WMBusComponent::probe_radio_() {
+  // Stream is quiet: check the radio state over SPI
   uint8_t marcstate = this->radio_.get_marcstate();
   uint8_t rxbytes = this->radio_.get_rx_bytes();
   uint8_t num_bytes = rxbytes & 0x7F;
   bool overflow = rxbytes & 0x80;
 
   // Read RSSI for signal strength
-  uint8_t rssi_raw = this->radio_.read_status_register(0x34);  // RSSI register
-  int16_t rssi_dbm;
-  if (rssi_raw >= 128) {
-    rssi_dbm = (rssi_raw - 256) / 2 - 74;
-  } else {
-    rssi_dbm = rssi_raw / 2 - 74;
-  }
+  int16_t rssi_dbm = this->radio_.read_rssi_dbm();
 
   ESP_LOGD(TAG, "Radio status: MARC=0x%02X, RXbytes=%u, overflow=%s, interrupts=%u, ready=%s, RSSI=%ddBm",
            marcstate, num_bytes, overflow ? "YES" : "no",
@@ -522,8 +1621,6 @@ void Multical21WMBusComponent::log_radio_status_() {
   if (marcstate == MARCSTATE_RXFIFO_OVERFLOW || overflow) {
     ESP_LOGW(TAG, "Radio in OVERFLOW state (MARC=0x%02X, overflow=%s) - restarting",
              marcstate, overflow ? "YES" : "no");
-    this->radio_.enter_idle();
-    this->radio_.flush_rx_fifo();
     this->radio_.start_rx();
   } else if (marcstate != MARCSTATE_RX) {
     ESP_LOGW(TAG, "Radio not in RX mode (state=0x%02X, expected 0x%02X) - restarting",
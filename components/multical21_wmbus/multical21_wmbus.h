@@ -1,24 +1,42 @@
 #pragma once
 
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/spi/spi.h"
 #include "wmbus_types.h"
+#include "cc1101_bus.h"
 #include "cc1101_radio.h"
 #include "wmbus_crypto.h"
+#include "wmbus_meter.h"
 #include "wmbus_packet_parser.h"
 #include "wmbus_packet_buffer.h"
+#include "wmbus_stream_decoder.h"
+#include "wmbus_t1_decoder.h"
+#include "wmbus_census.h"
+#include "wmbus_latency.h"
+#include "wmbus_mode_scheduler.h"
+#include "wmbus_rx_window.h"
+#include "wmbus_watchdog.h"
+
+// Packet ring size from YAML (packet_ring_size), power of two
+#ifndef MULTICAL21_WMBUS_PACKET_RING_SIZE
+#define MULTICAL21_WMBUS_PACKET_RING_SIZE PACKET_RING_SIZE
+#endif
 
 namespace esphome {
 namespace multical21_wmbus {
 
 static const char *const TAG = "multical21_wmbus";
 
-class Multical21WMBusComponent : public PollingComponent, public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST,
-                                                                                  spi::CLOCK_POLARITY_LOW,
-                                                                                  spi::CLOCK_PHASE_LEADING,
-                                                                                  spi::DATA_RATE_4MHZ> {
+class Multical21WMBusComponent : public PollingComponent,
+                                 public CC1101Bus,
+                                 public spi::SPIDevice<spi::BIT_ORDER_MSB_FIRST,
+                                                       spi::CLOCK_POLARITY_LOW,
+                                                       spi::CLOCK_PHASE_LEADING,
+                                                       spi::DATA_RATE_4MHZ> {
  public:
   Multical21WMBusComponent() = default;
 
@@ -30,69 +48,218 @@ class Multical21WMBusComponent : public PollingComponent, public spi::SPIDevice<
   float get_setup_priority() const override { return setup_priority::DATA; }
 
   // Configuration setters
-  void set_meter_id(const std::vector<uint8_t> &meter_id) { this->meter_id_ = meter_id; }
-  void set_aes_key(const std::vector<uint8_t> &aes_key) { this->aes_key_ = aes_key; }
+  void add_meter(WMBusMeter *meter);
   void set_gdo0_pin(uint8_t pin) { this->gdo0_pin_ = pin; }
+  void set_gdo2_pin(uint8_t pin) {
+    this->gdo2_pin_ = pin;
+    this->fifo_streaming_ = true;
+    this->radio_.set_fifo_streaming(true);
+  }
+  void set_mode(RadioMode mode) {
+    this->mode_ = mode;
+    this->radio_.set_mode(mode);
+  }
+  void set_dual_mode(bool dual_mode) { this->dual_mode_ = dual_mode; }
+  void set_early_reject(bool early_reject) { this->early_reject_ = early_reject; }
+  void set_keystream_prediction(bool keystream_prediction) { this->keystream_prediction_ = keystream_prediction; }
+  void set_pipelined_decode(bool pipelined_decode) { this->pipelined_decode_ = pipelined_decode; }
+  void set_continuous_rx(bool continuous_rx) {
+    this->continuous_rx_ = continuous_rx;
+    this->radio_.set_continuous_rx(continuous_rx);
+  }
+  void set_rx_windowing(bool rx_windowing) { this->rx_windowing_ = rx_windowing; }
+  void set_rx_window_guard(uint32_t guard_ms) { this->rx_window_.set_guard_ms(guard_ms); }
 
   // Sensor setters
-  void set_total_consumption_sensor(sensor::Sensor *sensor) { this->total_consumption_sensor_ = sensor; }
-  void set_target_consumption_sensor(sensor::Sensor *sensor) { this->target_consumption_sensor_ = sensor; }
-  void set_flow_temperature_sensor(sensor::Sensor *sensor) { this->flow_temperature_sensor_ = sensor; }
-  void set_ambient_temperature_sensor(sensor::Sensor *sensor) { this->ambient_temperature_sensor_ = sensor; }
+  // info_codes from the text_sensor platform; goes to the meter when only one is configured
   void set_info_codes_sensor(text_sensor::TextSensor *sensor) { this->info_codes_sensor_ = sensor; }
+  void set_ring_high_water_mark_sensor(sensor::Sensor *sensor) { this->ring_high_water_mark_sensor_ = sensor; }
+  void set_ring_dropped_packets_sensor(sensor::Sensor *sensor) { this->ring_dropped_packets_sensor_ = sensor; }
+  void set_ring_depth_sensor(sensor::Sensor *sensor) { this->ring_depth_sensor_ = sensor; }
+  void set_keystream_hit_rate_sensor(sensor::Sensor *sensor) { this->keystream_hit_rate_sensor_ = sensor; }
+  void set_keystream_latency_saved_sensor(sensor::Sensor *sensor) { this->keystream_latency_saved_sensor_ = sensor; }
+  void set_spi_transactions_saved_sensor(sensor::Sensor *sensor) { this->spi_transactions_saved_sensor_ = sensor; }
+  void set_recovery_time_sensor(sensor::Sensor *sensor) { this->recovery_time_sensor_ = sensor; }
+  void set_time_to_first_rx_sensor(sensor::Sensor *sensor) { this->time_to_first_rx_sensor_ = sensor; }
+  void set_capture_rate_sensor(RadioMode mode, sensor::Sensor *sensor) {
+    this->capture_rate_sensors_[static_cast<uint8_t>(mode)] = sensor;
+  }
+  void set_rx_duty_cycle_sensor(sensor::Sensor *sensor) { this->rx_duty_cycle_sensor_ = sensor; }
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  void set_latency_sensor(LatencyStage stage, uint8_t percentile, sensor::Sensor *sensor);
+#endif
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  void set_census_meters_sensor(sensor::Sensor *sensor) { this->census_meters_sensor_ = sensor; }
+
+  /**
+   * @brief Every meter heard recently, as a JSON array
+   *
+   * For lambdas, e.g. a template text sensor or an API service.
+   */
+  std::string census_json() const;
+#endif
+
+  // CC1101Bus implementation (SPI transport for radio_)
+  void cc1101_select() override { this->enable(); }
+  void cc1101_deselect() override { this->disable(); }
+  void cc1101_write_byte(uint8_t data) override { this->write_byte(data); }
+  uint8_t cc1101_read_byte() override { return this->read_byte(); }
+  void cc1101_read_array(uint8_t *data, size_t length) override { this->read_array(data, length); }
+  void cc1101_write_array(const uint8_t *data, size_t length) override { this->write_array(data, length); }
 
  protected:
   // High-level packet processing (coordinates helper classes)
-  void process_packet_(const uint8_t *packet_data, uint8_t packet_length);
-  void publish_meter_data_(const WMBusMeterData &data);
+  void process_packet_(const uint8_t *packet_data, uint16_t packet_length, int16_t rssi_dbm, uint8_t lqi,
+                       DecodeVerdict verdict);
 
   // Helper functions
-  void update_meter_stats_(uint32_t meter_id_uint, const std::string &frame_type);
-  bool is_our_meter_id_(const uint8_t *meter_id_le);
+  void update_meter_stats_(WMBusMeter *meter, FrameType frame_type);
+  WMBusMeter *find_meter_(const uint8_t *meter_id_le);
   bool read_packet_from_fifo_(uint8_t *buffer, uint8_t &length);
+  void drain_fifo_(uint8_t count);
+  void read_fifo_decoded_(uint8_t *packet, uint16_t offset, uint8_t count);
+  void finish_stream_decode_(PacketBuffer *pkt);
   bool read_fifo_into_packet_buffer_();
+  bool read_t1_packet_from_fifo_(PacketBuffer *pkt, uint8_t &length);
+  bool decode_t1_packet_(const uint8_t *raw, uint8_t l_field, PacketBuffer *pkt);
+  void read_continuous_frame_(uint8_t count);
+  void finish_continuous_frame_();
+  void store_rx_status_(PacketBuffer *pkt, uint8_t rssi_raw, uint8_t lqi_raw);
+  void loop_continuous_rx_();
+  void loop_fifo_streaming_();
+  bool begin_fifo_packet_();
+  void restart_fifo_rx_();
+  void track_radio_restart_();
+  void record_deaf_time_(uint32_t deaf_us);
   void process_buffered_packets_();
-  bool validate_packet_structure_(const uint8_t *packet_data, uint8_t length, uint8_t packet_length);
+  bool validate_packet_structure_(uint8_t length, uint16_t packet_length);
   bool verify_packet_crc_(const uint8_t *packet_data, uint8_t length);
-  bool decrypt_packet_payload_(const uint8_t *packet_data, uint8_t length,
+  bool decrypt_packet_payload_(WMBusMeter *meter, const uint8_t *packet_data, uint8_t length,
                                 uint8_t *plaintext, uint8_t &plaintext_length);
 
   // Health monitoring
-  void log_radio_status_();
+  void supervise_radio_();
+  void probe_radio_();
+  void check_radio_registers_();
+  void schedule_mode_();
+  void log_mode_schedule_(uint32_t now);
+  void update_rx_window_();
+  void log_rx_window_stats_();
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+  void light_sleep_(uint32_t sleep_ms);
+#endif
+  uint32_t shortest_meter_interval_ms_() const;
+  void log_early_reject_stats_(uint32_t now);
+  void publish_ring_stats_();
+  void log_meter_stats_(const WMBusMeter *meter, uint32_t now);
+  void update_keystream_prediction_(WMBusMeter *meter, uint32_t now);
+  void publish_keystream_stats_();
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  void log_latency_histograms_(bool with_buckets);
+  void publish_latency_stats_();
+#endif
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  void record_census_(const uint8_t *packet_data, int16_t rssi_dbm);
+#endif
 
   // Interrupt handling - CRITICAL TIMING PATH
   static void IRAM_ATTR packet_isr_(Multical21WMBusComponent *instance);
+  static void IRAM_ATTR fifo_isr_(Multical21WMBusComponent *instance);
   static Multical21WMBusComponent *isr_instance_;
   volatile bool packet_ready_{false};
+  volatile bool fifo_ready_{false};   // GDO2: RX FIFO reached the threshold
+  volatile uint32_t isr_time_us_{0};  // micros() at GDO0 falling edge
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+  volatile uint32_t isr_cycles_{0};   // CPU cycle counter at GDO0 falling edge
+  WMBusLatencyStats latency_;
+  sensor::Sensor *latency_p50_sensors_[LATENCY_STAGE_COUNT]{};
+  sensor::Sensor *latency_p99_sensors_[LATENCY_STAGE_COUNT]{};
+#endif
 
   // Helper classes (composition)
   CC1101Radio radio_;
-  WMBusCrypto crypto_;
   WMBusPacketParser parser_;
-  WMBusPacketBuffer<4> packet_buffer_;
+  WMBusPacketBuffer<MULTICAL21_WMBUS_PACKET_RING_SIZE> packet_buffer_;
+  WMBusWatchdog watchdog_;
+  WMBusModeScheduler mode_scheduler_;
+  WMBusRxWindow rx_window_;
+  WMBusStreamDecoder stream_decoder_;
+  WMBusMeter *stream_meter_{nullptr};  // Meter whose key the stream decoder uses
+  uint32_t stream_decrypt_us_{0};      // Decrypt time of the telegram being read
+#ifdef MULTICAL21_WMBUS_CENSUS_SIZE
+  WMBusCensus<MULTICAL21_WMBUS_CENSUS_SIZE> census_;
+  sensor::Sensor *census_meters_sensor_{nullptr};
+  int16_t rx_rssi_dbm_{0};  // RSSI of the telegram being read from the FIFO
+#endif
 
   // Configuration
-  std::vector<uint8_t> meter_id_;
-  std::vector<uint8_t> aes_key_;
+  WMBusMeter *meters_[METER_COUNT]{};  // Indexed like METER_IDS
   uint8_t gdo0_pin_;
+  uint8_t gdo2_pin_{0};
+  RadioMode mode_{RadioMode::C1};  // Mode the radio is receiving in (switches with dual_mode_)
+  bool dual_mode_{false};           // mode: c1_t1, time-sliced between the meters' modes
+  bool fifo_streaming_{false};  // gdo2_pin set: drain the FIFO while telegrams arrive
+  bool continuous_rx_{false};
+  bool rx_windowing_{false};  // Power the radio down between predicted telegrams
+  bool early_reject_{false};
+  bool keystream_prediction_{false};
+  bool pipelined_decode_{false};
 
   // Sensors
-  sensor::Sensor *total_consumption_sensor_{nullptr};
-  sensor::Sensor *target_consumption_sensor_{nullptr};
-  sensor::Sensor *flow_temperature_sensor_{nullptr};
-  sensor::Sensor *ambient_temperature_sensor_{nullptr};
   text_sensor::TextSensor *info_codes_sensor_{nullptr};
+  sensor::Sensor *ring_high_water_mark_sensor_{nullptr};
+  sensor::Sensor *ring_dropped_packets_sensor_{nullptr};
+  sensor::Sensor *ring_depth_sensor_{nullptr};
+  sensor::Sensor *keystream_hit_rate_sensor_{nullptr};
+  sensor::Sensor *keystream_latency_saved_sensor_{nullptr};
+  sensor::Sensor *spi_transactions_saved_sensor_{nullptr};
+  sensor::Sensor *recovery_time_sensor_{nullptr};
+  sensor::Sensor *time_to_first_rx_sensor_{nullptr};
+  sensor::Sensor *capture_rate_sensors_[RADIO_MODE_COUNT]{};
+  sensor::Sensor *rx_duty_cycle_sensor_{nullptr};
 
   // State tracking
-  uint32_t last_packet_time_{0};
-  uint32_t last_health_check_{0};
   uint32_t packets_received_{0};
   uint32_t packets_valid_{0};
   uint32_t crc_errors_{0};
   uint32_t id_mismatches_{0};
+  uint32_t parse_errors_{0};
+  uint32_t frames_rejected_early_{0};       // Foreign telegrams dropped after the A-field
+  uint32_t frames_read_fully_{0};           // Telegrams drained completely over SPI
+  uint32_t early_reject_bytes_skipped_{0};  // FIFO bytes flushed instead of read
+
+  // FIFO streaming: telegram being drained while it arrives
+  PacketBuffer *fifo_pkt_{nullptr};
+  uint16_t fifo_total_{0};  // FIFO bytes of the telegram: STREAM_HEADER_BYTES + L
+  uint16_t fifo_read_{0};   // FIFO bytes read so far
+  bool fifo_header_checked_{false};  // Early reject decided for this telegram
+  uint32_t fifo_wakes_{0};
+  uint32_t long_telegrams_{0};    // Telegrams longer than one FIFO fill
+  uint32_t fifo_overflows_{0};    // Telegrams lost to an RX FIFO overflow
+
+  // Continuous RX: frame being drained (fifo_pkt_/fifo_read_ track it)
+  bool continuous_draining_{false};      // FIFO not seen empty: GDO0 stays asserted, poll
+  bool continuous_end_seen_{false};      // Telegram's last byte has been seen in the FIFO
+  uint32_t continuous_end_us_{0};        // When it was first seen
 
-  // Meter transmission tracking (for analyzing transmission intervals)
-  std::vector<MeterStats> meter_stats_;
+  // Mode T1: coded FIFO bytes are collected here and decoded once complete
+  uint8_t t1_raw_[T1_MAX_ENCODED_SIZE];
+  uint32_t t1_symbol_errors_{0};     // Telegrams with a chip pattern that is no 3-out-of-6 symbol
+  uint32_t t1_block_crc_errors_{0};  // Telegrams with a wrong Frame Format A block CRC
+  uint32_t t1_too_long_{0};          // Telegrams longer than one FIFO fill without gdo2_pin
+  uint64_t total_deaf_time_us_{0};  // Time the receiver spent outside RX
+  uint32_t decrypt_hit_us_total_{0};   // Decrypt time served from precomputed keystream
+  uint32_t decrypt_full_us_total_{0};  // Decrypt time through the full AES-CTR path
+  uint32_t decrypt_full_count_{0};
+  bool keystream_precompute_pending_{false};
+  uint32_t recoveries_published_{0};  // Radio recovery count at the last recovery_time publish
+  bool time_to_first_rx_published_{false};
+  uint32_t restart_started_us_{0};
+  bool restart_pending_{false};
+#ifdef MULTICAL21_WMBUS_LIGHT_SLEEP
+  uint64_t light_sleep_ms_{0};  // Time the MCU spent in light sleep
+#endif
+  HighFrequencyLoopRequester high_freq_loop_;
 };
 
 }  // namespace multical21_wmbus
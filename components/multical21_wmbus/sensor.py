@@ -1,32 +1,114 @@
 """ESPHome component for Multical21 wMBUS receiver with CC1101 radio."""
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import sensor, spi
+from esphome.components import sensor, spi, text_sensor
 from esphome import pins
+from esphome.core import CORE
 from esphome.const import (
     CONF_ID,
     CONF_NUMBER,
+    ENTITY_CATEGORY_DIAGNOSTIC,
     DEVICE_CLASS_WATER,
     DEVICE_CLASS_TEMPERATURE,
+    DEVICE_CLASS_SIGNAL_STRENGTH,
     STATE_CLASS_TOTAL_INCREASING,
     STATE_CLASS_MEASUREMENT,
     UNIT_CUBIC_METER,
     UNIT_CELSIUS,
+    UNIT_DECIBEL_MILLIWATT,
+    UNIT_MICROSECOND,
+    UNIT_PERCENT,
     ICON_WATER,
     ICON_THERMOMETER,
 )
-from . import multical21_wmbus_ns, Multical21WMBusComponent
+from . import multical21_wmbus_ns, Multical21WMBusComponent, WMBusMeter
 
 DEPENDENCIES = ["spi"]
 AUTO_LOAD = ["sensor", "text_sensor"]
 
+CONF_METERS = "meters"
 CONF_METER_ID = "meter_id"
 CONF_AES_KEY = "aes_key"
 CONF_GDO0_PIN = "gdo0_pin"
+CONF_GDO2_PIN = "gdo2_pin"
+CONF_MODE = "mode"
+CONF_CONTINUOUS_RX = "continuous_rx"
+CONF_RX_WINDOWING = "rx_windowing"
+CONF_RX_WINDOW_GUARD = "rx_window_guard"
+CONF_LIGHT_SLEEP = "light_sleep"
+CONF_EARLY_REJECT = "early_reject"
+CONF_PACKET_RING_SIZE = "packet_ring_size"
+CONF_LOG_PROFILE = "log_profile"
+CONF_KEYSTREAM_PREDICTION = "keystream_prediction"
+CONF_PIPELINED_DECODE = "pipelined_decode"
+CONF_CENSUS = "census"
+CONF_CENSUS_SIZE = "census_size"
+CONF_CENSUS_METERS = "census_meters"
+CONF_LATENCY_HISTOGRAMS = "latency_histograms"
+CONF_RING_HIGH_WATER_MARK = "ring_high_water_mark"
+CONF_RING_DROPPED_PACKETS = "ring_dropped_packets"
+CONF_RING_DEPTH = "ring_depth"
+CONF_KEYSTREAM_HIT_RATE = "keystream_hit_rate"
+CONF_KEYSTREAM_LATENCY_SAVED = "keystream_latency_saved"
+CONF_SPI_TRANSACTIONS_SAVED = "spi_transactions_saved"
+CONF_RECOVERY_TIME = "recovery_time"
+CONF_TIME_TO_FIRST_RX = "time_to_first_rx"
+CONF_C1_CAPTURE_RATE = "c1_capture_rate"
+CONF_T1_CAPTURE_RATE = "t1_capture_rate"
+CONF_RX_DUTY_CYCLE = "rx_duty_cycle"
 CONF_TOTAL_CONSUMPTION = "total_consumption"
 CONF_TARGET_CONSUMPTION = "target_consumption"
 CONF_FLOW_TEMPERATURE = "flow_temperature"
 CONF_AMBIENT_TEMPERATURE = "ambient_temperature"
+CONF_INFO_CODES = "info_codes"
+CONF_RSSI = "rssi"
+CONF_LQI = "lqi"
+
+LatencyStage = multical21_wmbus_ns.enum("LatencyStage", is_class=True)
+RadioMode = multical21_wmbus_ns.enum("RadioMode", is_class=True)
+
+RADIO_MODES = {
+    "c1": RadioMode.C1,
+    "t1": RadioMode.T1,
+}
+# Top-level mode: one of RADIO_MODES, or time-sliced between the meters' modes
+MODE_DUAL = "c1_t1"
+
+CAPTURE_RATE_SENSORS = {
+    CONF_C1_CAPTURE_RATE: RadioMode.C1,
+    CONF_T1_CAPTURE_RATE: RadioMode.T1,
+}
+
+# Timed receive stages -> <stage>_latency_p50 / <stage>_latency_p99 sensors
+LATENCY_STAGES = {
+    "loop_wake": LatencyStage.LOOP_WAKE,
+    "fifo_drain": LatencyStage.FIFO_DRAIN,
+    "crc": LatencyStage.CRC,
+    "aes": LatencyStage.AES,
+    "plaintext_ready": LatencyStage.PLAINTEXT_READY,
+    "parse": LatencyStage.PARSE,
+    "publish": LatencyStage.PUBLISH,
+    "total": LatencyStage.TOTAL,
+}
+LATENCY_PERCENTILES = (50, 99)
+LATENCY_SENSOR_KEYS = [
+    f"{stage}_latency_p{percentile}" for stage in LATENCY_STAGES for percentile in LATENCY_PERCENTILES
+]
+
+# Most meters one gateway is configured for
+MAX_METERS = 256
+
+# Per-meter options that may also be given at the top level (single meter)
+SINGLE_METER_KEYS = (
+    CONF_METER_ID,
+    CONF_AES_KEY,
+    CONF_TOTAL_CONSUMPTION,
+    CONF_TARGET_CONSUMPTION,
+    CONF_FLOW_TEMPERATURE,
+    CONF_AMBIENT_TEMPERATURE,
+    CONF_RSSI,
+    CONF_LQI,
+)
 
 def validate_aes_key(value):
     """Validate AES key is 16 bytes (32 hex characters)."""
@@ -52,45 +134,275 @@ def validate_meter_id(value):
             raise cv.Invalid(f"Invalid hexadecimal characters in meter ID: {e}")
     return value
 
-CONFIG_SCHEMA = (
+def power_of_two(min_value, max_value, name):
+    """Validator for a table size that must be a power of two."""
+    def validator(value):
+        value = cv.int_range(min=min_value, max=max_value)(value)
+        if value & (value - 1) != 0:
+            raise cv.Invalid(f"{name} must be a power of two ({min_value}, {min_value * 2}, ... {max_value})")
+        return value
+    return validator
+
+def meter_id_to_int(value):
+    """Meter ID as printed on the meter, e.g. "12345678" -> 0x12345678."""
+    return int(value.replace(" ", "").replace(":", ""), 16)
+
+def single_meter_to_list(config):
+    """Fold top-level meter_id/aes_key/sensors into a one-entry meters: list."""
+    if not any(key in config for key in SINGLE_METER_KEYS):
+        return config
+    if CONF_METERS in config:
+        raise cv.Invalid("Use either meter_id/aes_key or meters:, not both")
+    config = config.copy()
+    config[CONF_METERS] = [{key: config.pop(key) for key in SINGLE_METER_KEYS if key in config}]
+    return config
+
+def validate_unique_meters(meters):
+    """Reject duplicate meter IDs (the lookup table needs unique keys)."""
+    seen = set()
+    for meter in meters:
+        meter_id = meter_id_to_int(meter[CONF_METER_ID])
+        if meter_id in seen:
+            raise cv.Invalid(f"Meter ID {meter[CONF_METER_ID]} is configured more than once")
+        seen.add(meter_id)
+    return meters
+
+def validate_census(config):
+    """census_meters only exists when the census is compiled in."""
+    if CONF_CENSUS_METERS in config and not config[CONF_CENSUS]:
+        raise cv.Invalid("census_meters requires census: true")
+    return config
+
+def validate_fifo_streaming(config):
+    """FIFO streaming replaces the fixed-length frames of continuous RX."""
+    if CONF_GDO2_PIN in config and config[CONF_CONTINUOUS_RX]:
+        raise cv.Invalid("gdo2_pin (FIFO streaming) cannot be combined with continuous_rx: true")
+    return config
+
+def validate_signal_sensors(config):
+    """The default receive path measures no per-telegram RSSI or LQI."""
+    if config[CONF_CONTINUOUS_RX] or CONF_GDO2_PIN in config:
+        return config
+    for meter in config[CONF_METERS]:
+        for key in (CONF_RSSI, CONF_LQI):
+            if key in meter:
+                raise cv.Invalid(
+                    f"Meter {meter[CONF_METER_ID]}: {key} requires continuous_rx: true or gdo2_pin; "
+                    "the default receive path measures no signal status"
+                )
+    return config
+
+def validate_mode(config):
+    """T1 telegrams are variable-length and decoded after the FIFO read."""
+    mode = config[CONF_MODE]
+    if mode != "c1" and config[CONF_CONTINUOUS_RX]:
+        raise cv.Invalid(f"mode: {mode} cannot be combined with continuous_rx: true")
+    if mode == "t1" and config[CONF_PIPELINED_DECODE]:
+        raise cv.Invalid("pipelined_decode is only available in mode: c1 and c1_t1")
+    if mode != MODE_DUAL:
+        for meter in config[CONF_METERS]:
+            if meter.get(CONF_MODE, mode) != mode:
+                raise cv.Invalid(
+                    f"Meter {meter[CONF_METER_ID]} is set to mode: {meter[CONF_MODE]}; "
+                    f"use mode: {MODE_DUAL} to receive meters in both modes"
+                )
+    return config
+
+def validate_rx_windowing(config):
+    """Light sleep and the duty cycle sensor only exist with RX windowing."""
+    if not config[CONF_RX_WINDOWING]:
+        for key in (CONF_LIGHT_SLEEP, CONF_RX_DUTY_CYCLE):
+            if config.get(key):
+                raise cv.Invalid(f"{key} requires rx_windowing: true")
+    if config[CONF_LIGHT_SLEEP] and not CORE.is_esp32:
+        raise cv.Invalid("light_sleep is only available on ESP32")
+    return config
+
+def validate_latency(config):
+    """Latency sensors only exist when the histograms are compiled in."""
+    if not config[CONF_LATENCY_HISTOGRAMS]:
+        for key in LATENCY_SENSOR_KEYS:
+            if key in config:
+                raise cv.Invalid(f"{key} requires latency_histograms: true")
+    return config
+
+LATENCY_SENSOR_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    icon="mdi:timer-outline",
+    accuracy_decimals=1,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+METER_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(WMBusMeter),
+        cv.Required(CONF_METER_ID): validate_meter_id,
+        cv.Required(CONF_AES_KEY): validate_aes_key,
+        cv.Optional(CONF_MODE): cv.one_of(*RADIO_MODES, lower=True),
+        cv.Optional(CONF_TOTAL_CONSUMPTION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_CUBIC_METER,
+            icon=ICON_WATER,
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_WATER,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+        ),
+        cv.Optional(CONF_TARGET_CONSUMPTION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_CUBIC_METER,
+            icon=ICON_WATER,
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_WATER,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+        ),
+        cv.Optional(CONF_FLOW_TEMPERATURE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_CELSIUS,
+            icon=ICON_THERMOMETER,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_TEMPERATURE,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_AMBIENT_TEMPERATURE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_CELSIUS,
+            icon=ICON_THERMOMETER,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_TEMPERATURE,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_INFO_CODES): text_sensor.text_sensor_schema(
+            icon="mdi:alert-circle",
+        ),
+        cv.Optional(CONF_RSSI): sensor.sensor_schema(
+            unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
+            accuracy_decimals=1,
+            device_class=DEVICE_CLASS_SIGNAL_STRENGTH,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_LQI): sensor.sensor_schema(
+            icon="mdi:signal",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+CONFIG_SCHEMA = cv.All(
+    single_meter_to_list,
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(Multical21WMBusComponent),
-            cv.Required(CONF_METER_ID): validate_meter_id,
-            cv.Required(CONF_AES_KEY): validate_aes_key,
+            cv.Required(CONF_METERS): cv.All(
+                cv.ensure_list(METER_SCHEMA), cv.Length(min=1, max=MAX_METERS), validate_unique_meters
+            ),
             cv.Required(CONF_GDO0_PIN): pins.gpio_input_pin_schema,
-            cv.Optional(CONF_TOTAL_CONSUMPTION): sensor.sensor_schema(
-                unit_of_measurement=UNIT_CUBIC_METER,
-                icon=ICON_WATER,
-                accuracy_decimals=3,
-                device_class=DEVICE_CLASS_WATER,
-                state_class=STATE_CLASS_TOTAL_INCREASING,
+            cv.Optional(CONF_GDO2_PIN): pins.gpio_input_pin_schema,
+            cv.Optional(CONF_MODE, default="c1"): cv.one_of(*RADIO_MODES, MODE_DUAL, lower=True),
+            cv.Optional(CONF_CONTINUOUS_RX, default=False): cv.boolean,
+            cv.Optional(CONF_RX_WINDOWING, default=False): cv.boolean,
+            cv.Optional(CONF_RX_WINDOW_GUARD, default="500ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(milliseconds=50), max=cv.TimePeriod(milliseconds=4000)),
+            ),
+            cv.Optional(CONF_LIGHT_SLEEP, default=False): cv.boolean,
+            cv.Optional(CONF_EARLY_REJECT, default=False): cv.boolean,
+            cv.Optional(CONF_PACKET_RING_SIZE, default=4): power_of_two(2, 128, "Packet ring size"),
+            cv.Optional(CONF_LOG_PROFILE, default="verbose"): cv.one_of("verbose", "quiet", lower=True),
+            cv.Optional(CONF_KEYSTREAM_PREDICTION, default=False): cv.boolean,
+            cv.Optional(CONF_PIPELINED_DECODE, default=False): cv.boolean,
+            cv.Optional(CONF_CENSUS, default=False): cv.boolean,
+            cv.Optional(CONF_CENSUS_SIZE, default=64): power_of_two(8, 256, "Census size"),
+            cv.Optional(CONF_LATENCY_HISTOGRAMS, default=False): cv.boolean,
+            cv.Optional(CONF_RING_HIGH_WATER_MARK): sensor.sensor_schema(
+                icon="mdi:tray-full",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             ),
-            cv.Optional(CONF_TARGET_CONSUMPTION): sensor.sensor_schema(
-                unit_of_measurement=UNIT_CUBIC_METER,
-                icon=ICON_WATER,
-                accuracy_decimals=3,
-                device_class=DEVICE_CLASS_WATER,
+            cv.Optional(CONF_RING_DROPPED_PACKETS): sensor.sensor_schema(
+                icon="mdi:tray-remove",
+                accuracy_decimals=0,
                 state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             ),
-            cv.Optional(CONF_FLOW_TEMPERATURE): sensor.sensor_schema(
-                unit_of_measurement=UNIT_CELSIUS,
-                icon=ICON_THERMOMETER,
+            cv.Optional(CONF_RING_DEPTH): sensor.sensor_schema(
+                icon="mdi:tray",
                 accuracy_decimals=0,
-                device_class=DEVICE_CLASS_TEMPERATURE,
                 state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_KEYSTREAM_HIT_RATE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon="mdi:key-chain",
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             ),
-            cv.Optional(CONF_AMBIENT_TEMPERATURE): sensor.sensor_schema(
-                unit_of_measurement=UNIT_CELSIUS,
-                icon=ICON_THERMOMETER,
+            cv.Optional(CONF_KEYSTREAM_LATENCY_SAVED): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MICROSECOND,
+                icon="mdi:timer-sand",
                 accuracy_decimals=0,
-                device_class=DEVICE_CLASS_TEMPERATURE,
                 state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_SPI_TRANSACTIONS_SAVED): sensor.sensor_schema(
+                unit_of_measurement="/h",
+                icon="mdi:swap-horizontal",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_RECOVERY_TIME): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MICROSECOND,
+                icon="mdi:restart",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_TIME_TO_FIRST_RX): sensor.sensor_schema(
+                unit_of_measurement=UNIT_MICROSECOND,
+                icon="mdi:timer-play-outline",
+                accuracy_decimals=0,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_C1_CAPTURE_RATE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon="mdi:radar",
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_T1_CAPTURE_RATE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon="mdi:radar",
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_RX_DUTY_CYCLE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                icon="mdi:sleep",
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+            cv.Optional(CONF_CENSUS_METERS): sensor.sensor_schema(
+                icon="mdi:access-point-network",
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
             ),
         }
     )
+    .extend({cv.Optional(key): LATENCY_SENSOR_SCHEMA for key in LATENCY_SENSOR_KEYS})
     .extend(cv.polling_component_schema("60s"))
-    .extend(spi.spi_device_schema(cs_pin_required=True))
+    .extend(spi.spi_device_schema(cs_pin_required=True)),
+    validate_census,
+    validate_fifo_streaming,
+    validate_signal_sensors,
+    validate_mode,
+    validate_rx_windowing,
+    validate_latency,
 )
 
 
@@ -100,35 +412,155 @@ async def to_code(config):
     await cg.register_component(var, config)
     await spi.register_spi_device(var, config)
 
-    # Set meter ID (4 bytes)
-    meter_id_str = config[CONF_METER_ID].replace(" ", "").replace(":", "")
-    meter_id_bytes = bytes.fromhex(meter_id_str)
-    meter_id_array = [int(b) for b in meter_id_bytes]
-    cg.add(var.set_meter_id(meter_id_array))
+    # Meter ID table: sorted at compile time, hashed into a constexpr table
+    meters = sorted(config[CONF_METERS], key=lambda m: meter_id_to_int(m[CONF_METER_ID]))
+    cg.add_define("MULTICAL21_WMBUS_METER_COUNT", len(meters))
+    cg.add_define(
+        "MULTICAL21_WMBUS_METER_IDS",
+        cg.RawExpression(", ".join(f"0x{meter_id_to_int(m[CONF_METER_ID]):08X}" for m in meters)),
+    )
+
+    for meter_config in meters:
+        meter = cg.new_Pvariable(meter_config[CONF_ID], meter_id_to_int(meter_config[CONF_METER_ID]))
+
+        # Mode the meter transmits in; defaults to the component's (C1 when time-sliced)
+        mode = config[CONF_MODE] if config[CONF_MODE] != MODE_DUAL else "c1"
+        cg.add(meter.set_mode(RADIO_MODES[meter_config.get(CONF_MODE, mode)]))
+
+        # Set AES key (16 bytes); each meter keeps its own expanded key schedule
+        aes_key_str = meter_config[CONF_AES_KEY].replace(" ", "").replace(":", "")
+        aes_key_bytes = bytes.fromhex(aes_key_str)
+        aes_key_array = [int(b) for b in aes_key_bytes]
+        cg.add(meter.set_aes_key(aes_key_array))
+
+        # Register the meter's sensors
+        if CONF_TOTAL_CONSUMPTION in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_TOTAL_CONSUMPTION])
+            cg.add(meter.set_total_consumption_sensor(sens))
+
+        if CONF_TARGET_CONSUMPTION in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_TARGET_CONSUMPTION])
+            cg.add(meter.set_target_consumption_sensor(sens))
+
+        if CONF_FLOW_TEMPERATURE in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_FLOW_TEMPERATURE])
+            cg.add(meter.set_flow_temperature_sensor(sens))
+
+        if CONF_AMBIENT_TEMPERATURE in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_AMBIENT_TEMPERATURE])
+            cg.add(meter.set_ambient_temperature_sensor(sens))
+
+        if CONF_INFO_CODES in meter_config:
+            sens = await text_sensor.new_text_sensor(meter_config[CONF_INFO_CODES])
+            cg.add(meter.set_info_codes_sensor(sens))
+
+        if CONF_RSSI in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_RSSI])
+            cg.add(meter.set_rssi_sensor(sens))
+
+        if CONF_LQI in meter_config:
+            sens = await sensor.new_sensor(meter_config[CONF_LQI])
+            cg.add(meter.set_lqi_sensor(sens))
 
-    # Set AES key (16 bytes)
-    aes_key_str = config[CONF_AES_KEY].replace(" ", "").replace(":", "")
-    aes_key_bytes = bytes.fromhex(aes_key_str)
-    aes_key_array = [int(b) for b in aes_key_bytes]
-    cg.add(var.set_aes_key(aes_key_array))
+        cg.add(var.add_meter(meter))
 
     # Set GDO0 pin - extract pin number from GPIO config
     gdo0_pin_num = config[CONF_GDO0_PIN][CONF_NUMBER]
     cg.add(var.set_gdo0_pin(gdo0_pin_num))
 
-    # Register sensors
-    if CONF_TOTAL_CONSUMPTION in config:
-        sens = await sensor.new_sensor(config[CONF_TOTAL_CONSUMPTION])
-        cg.add(var.set_total_consumption_sensor(sens))
+    # GDO2 FIFO threshold drives reception; telegrams up to 255 bytes are kept
+    if CONF_GDO2_PIN in config:
+        cg.add(var.set_gdo2_pin(config[CONF_GDO2_PIN][CONF_NUMBER]))
+        cg.add_define("MULTICAL21_WMBUS_MAX_PACKET_SIZE", 255)
+
+    # wM-Bus mode: C1 (868.95 MHz), T1 (868.3 MHz, 3-out-of-6 coded), or
+    # time-sliced between the two, starting in C1
+    if config[CONF_MODE] == MODE_DUAL:
+        cg.add(var.set_mode(RadioMode.C1))
+        cg.add(var.set_dual_mode(True))
+    else:
+        cg.add(var.set_mode(RADIO_MODES[config[CONF_MODE]]))
+
+    # Stay in RX across telegrams (no per-packet IDLE/flush/recalibration)
+    cg.add(var.set_continuous_rx(config[CONF_CONTINUOUS_RX]))
+
+    # Power the radio down between predicted telegrams (and the MCU with light_sleep)
+    cg.add(var.set_rx_windowing(config[CONF_RX_WINDOWING]))
+    cg.add(var.set_rx_window_guard(config[CONF_RX_WINDOW_GUARD].total_milliseconds))
+    if config[CONF_LIGHT_SLEEP]:
+        cg.add_define("MULTICAL21_WMBUS_LIGHT_SLEEP")
+
+    # Drop foreign telegrams after reading the header instead of the whole FIFO
+    cg.add(var.set_early_reject(config[CONF_EARLY_REJECT]))
+
+    # Precompute the AES-CTR keystream for the next expected access numbers
+    cg.add(var.set_keystream_prediction(config[CONF_KEYSTREAM_PREDICTION]))
+    cg.add(var.set_pipelined_decode(config[CONF_PIPELINED_DECODE]))
+
+    # Packet ring size is a template parameter, so it is set at compile time
+    cg.add_define("MULTICAL21_WMBUS_PACKET_RING_SIZE", config[CONF_PACKET_RING_SIZE])
+
+    # Quiet profile compiles out per-telegram logging (counters remain)
+    if config[CONF_LOG_PROFILE] == "quiet":
+        cg.add_define("MULTICAL21_WMBUS_QUIET_LOGGING")
+
+    # Stage timing is only compiled in when enabled (cycle counter reads on the hot path)
+    if config[CONF_LATENCY_HISTOGRAMS]:
+        cg.add_define("MULTICAL21_WMBUS_LATENCY_HISTOGRAMS")
+
+    # Census table is only compiled in (and sized) when enabled
+    if config[CONF_CENSUS]:
+        cg.add_define("MULTICAL21_WMBUS_CENSUS_SIZE", config[CONF_CENSUS_SIZE])
+
+    # Register diagnostic sensors
+    if CONF_RING_HIGH_WATER_MARK in config:
+        sens = await sensor.new_sensor(config[CONF_RING_HIGH_WATER_MARK])
+        cg.add(var.set_ring_high_water_mark_sensor(sens))
+
+    if CONF_RING_DROPPED_PACKETS in config:
+        sens = await sensor.new_sensor(config[CONF_RING_DROPPED_PACKETS])
+        cg.add(var.set_ring_dropped_packets_sensor(sens))
+
+    if CONF_RING_DEPTH in config:
+        sens = await sensor.new_sensor(config[CONF_RING_DEPTH])
+        cg.add(var.set_ring_depth_sensor(sens))
+
+    if CONF_KEYSTREAM_HIT_RATE in config:
+        sens = await sensor.new_sensor(config[CONF_KEYSTREAM_HIT_RATE])
+        cg.add(var.set_keystream_hit_rate_sensor(sens))
+
+    if CONF_KEYSTREAM_LATENCY_SAVED in config:
+        sens = await sensor.new_sensor(config[CONF_KEYSTREAM_LATENCY_SAVED])
+        cg.add(var.set_keystream_latency_saved_sensor(sens))
+
+    if CONF_SPI_TRANSACTIONS_SAVED in config:
+        sens = await sensor.new_sensor(config[CONF_SPI_TRANSACTIONS_SAVED])
+        cg.add(var.set_spi_transactions_saved_sensor(sens))
+
+    if CONF_RECOVERY_TIME in config:
+        sens = await sensor.new_sensor(config[CONF_RECOVERY_TIME])
+        cg.add(var.set_recovery_time_sensor(sens))
+
+    if CONF_TIME_TO_FIRST_RX in config:
+        sens = await sensor.new_sensor(config[CONF_TIME_TO_FIRST_RX])
+        cg.add(var.set_time_to_first_rx_sensor(sens))
+
+    for key, mode in CAPTURE_RATE_SENSORS.items():
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(var.set_capture_rate_sensor(mode, sens))
 
-    if CONF_TARGET_CONSUMPTION in config:
-        sens = await sensor.new_sensor(config[CONF_TARGET_CONSUMPTION])
-        cg.add(var.set_target_consumption_sensor(sens))
+    if CONF_RX_DUTY_CYCLE in config:
+        sens = await sensor.new_sensor(config[CONF_RX_DUTY_CYCLE])
+        cg.add(var.set_rx_duty_cycle_sensor(sens))
 
-    if CONF_FLOW_TEMPERATURE in config:
-        sens = await sensor.new_sensor(config[CONF_FLOW_TEMPERATURE])
-        cg.add(var.set_flow_temperature_sensor(sens))
+    if CONF_CENSUS_METERS in config:
+        sens = await sensor.new_sensor(config[CONF_CENSUS_METERS])
+        cg.add(var.set_census_meters_sensor(sens))
 
-    if CONF_AMBIENT_TEMPERATURE in config:
-        sens = await sensor.new_sensor(config[CONF_AMBIENT_TEMPERATURE])
-        cg.add(var.set_ambient_temperature_sensor(sens))
+    for stage, stage_enum in LATENCY_STAGES.items():
+        for percentile in LATENCY_PERCENTILES:
+            key = f"{stage}_latency_p{percentile}"
+            if key in config:
+                sens = await sensor.new_sensor(config[key])
+                cg.add(var.set_latency_sensor(stage_enum, percentile, sens))
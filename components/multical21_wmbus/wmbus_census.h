@@ -0,0 +1,237 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief One overheard meter in the census
+ */
+struct CensusEntry {
+  uint32_t meter_id;         // A-field as printed on the meter
+  uint32_t first_seen_ms;
+  uint32_t last_seen_ms;
+  uint32_t avg_interval_ms;  // Moving average (1/8 weight per new interval)
+  uint16_t manufacturer;     // Raw M-field
+  uint16_t count;            // Telegrams heard (saturates)
+  int16_t rssi_dbm;          // Last measured telegram (RSSI_UNKNOWN_DBM: none yet)
+  int16_t rssi_avg_x16;      // Moving average in 1/16 dBm
+  uint8_t version;
+  uint8_t device_type;
+  bool used;
+};
+
+/**
+ * @brief Bounded census of every meter heard on the air
+ *
+ * Fixed-capacity open-addressing hash table (linear probing) keyed by
+ * manufacturer + A-field. All storage is inline, so memory use is known at
+ * compile time and nothing is allocated per telegram. Once the table holds
+ * MAX_ENTRIES meters, the least recently heard one is evicted; the table is
+ * never filled beyond 3/4 so probe chains stay short.
+ *
+ * Eviction uses backward-shift deletion, so there are no tombstones and
+ * lookups never degrade over time.
+ *
+ * @tparam SIZE Number of slots, a power of two (default: 64)
+ *
+ * Thread Safety: not thread-safe; use from loop() only.
+ */
+template<size_t SIZE = CENSUS_SIZE>
+class WMBusCensus {
+  static_assert(SIZE >= 8 && (SIZE & (SIZE - 1)) == 0, "Census size must be a power of two");
+
+ public:
+  /// Meters kept before the least recently heard one is evicted
+  static constexpr size_t MAX_ENTRIES = SIZE - SIZE / 4;
+
+  /**
+   * @brief Record a telegram header
+   *
+   * @param meter_id A-field as printed on the meter
+   * @param manufacturer Raw M-field (little-endian decoded)
+   * @param version Version byte
+   * @param device_type Device type byte
+   * @param rssi_dbm Signal strength of this telegram (RSSI_UNKNOWN_DBM leaves the RSSI alone)
+   * @param now Current time in milliseconds
+   */
+  void record(uint32_t meter_id, uint16_t manufacturer, uint8_t version, uint8_t device_type,
+              int16_t rssi_dbm, uint32_t now) {
+    size_t idx = this->find_(meter_id, manufacturer);
+    if (idx == SIZE) {
+      if (this->count_ >= MAX_ENTRIES) {
+        this->evict_lru_(now);
+      }
+      idx = this->insert_(meter_id, manufacturer, now);
+    } else {
+      CensusEntry &entry = this->slots_[idx];
+      uint32_t interval_ms = now - entry.last_seen_ms;
+      if (entry.count == 1) {
+        entry.avg_interval_ms = interval_ms;
+      } else {
+        entry.avg_interval_ms = entry.avg_interval_ms - entry.avg_interval_ms / 8 + interval_ms / 8;
+      }
+      entry.last_seen_ms = now;
+      if (entry.count < UINT16_MAX) {
+        entry.count++;
+      }
+    }
+
+    CensusEntry &entry = this->slots_[idx];
+    entry.version = version;
+    entry.device_type = device_type;
+    if (rssi_dbm == RSSI_UNKNOWN_DBM) {
+      return;
+    }
+    if (entry.rssi_dbm == RSSI_UNKNOWN_DBM) {
+      entry.rssi_avg_x16 = rssi_dbm * 16;
+    } else {
+      entry.rssi_avg_x16 += (rssi_dbm * 16 - entry.rssi_avg_x16) / 8;
+    }
+    entry.rssi_dbm = rssi_dbm;
+  }
+
+  /**
+   * @brief Meters currently in the table
+   */
+  size_t size() const { return this->count_; }
+
+  /**
+   * @brief Meters dropped to make room for newer ones
+   */
+  uint32_t get_eviction_count() const { return this->evictions_; }
+
+  /**
+   * @brief Decode an M-field into its three-letter manufacturer code
+   *
+   * @param manufacturer Raw M-field
+   * @param out Buffer of at least 4 bytes, receives e.g. "KAM"
+   */
+  static void decode_manufacturer(uint16_t manufacturer, char *out) {
+    out[0] = static_cast<char>(((manufacturer >> 10) & 0x1F) + 64);
+    out[1] = static_cast<char>(((manufacturer >> 5) & 0x1F) + 64);
+    out[2] = static_cast<char>((manufacturer & 0x1F) + 64);
+    out[3] = '\0';
+  }
+
+  /**
+   * @brief Append the table as a JSON array to out
+   *
+   * One object per meter:
+   * {"id":"12345678","mfr":"KAM","ver":27,"type":22,"count":5,
+   *  "age_s":12,"interval_s":16,"rssi":-71,"rssi_avg":-72.5}
+   * rssi and rssi_avg are null until a telegram with measured RSSI was heard.
+   *
+   * @param out String to append to (reserve ~130 bytes per meter)
+   * @param now Current time in milliseconds, for age_s
+   */
+  void to_json(std::string &out, uint32_t now) const {
+    out += '[';
+    bool first = true;
+    for (const CensusEntry &entry : this->slots_) {
+      if (!entry.used) {
+        continue;
+      }
+      char mfr[4];
+      decode_manufacturer(entry.manufacturer, mfr);
+      char buf[160];
+      int n = snprintf(buf, sizeof(buf),
+                       "%s{\"id\":\"%08X\",\"mfr\":\"%s\",\"ver\":%u,\"type\":%u,\"count\":%u,"
+                       "\"age_s\":%u,\"interval_s\":%u,",
+                       first ? "" : ",", (unsigned) entry.meter_id, mfr, entry.version, entry.device_type,
+                       entry.count, (unsigned) ((now - entry.last_seen_ms) / 1000),
+                       (unsigned) (entry.avg_interval_ms / 1000));
+      if (entry.rssi_dbm == RSSI_UNKNOWN_DBM) {
+        snprintf(buf + n, sizeof(buf) - n, "\"rssi\":null,\"rssi_avg\":null}");
+      } else {
+        snprintf(buf + n, sizeof(buf) - n, "\"rssi\":%d,\"rssi_avg\":%.1f}", entry.rssi_dbm,
+                 entry.rssi_avg_x16 / 16.0f);
+      }
+      out += buf;
+      first = false;
+    }
+    out += ']';
+  }
+
+ private:
+  static constexpr size_t MASK = SIZE - 1;
+
+  static size_t home_(uint32_t meter_id, uint16_t manufacturer) {
+    // Fibonacci hashing; A-fields are BCD, so mix before masking
+    uint32_t key = meter_id ^ (static_cast<uint32_t>(manufacturer) * 0x9E3779B9u);
+    return ((key * 2654435761u) >> 16) & MASK;
+  }
+
+  size_t find_(uint32_t meter_id, uint16_t manufacturer) const {
+    for (size_t idx = home_(meter_id, manufacturer);; idx = (idx + 1) & MASK) {
+      const CensusEntry &entry = this->slots_[idx];
+      if (!entry.used) {
+        return SIZE;  // Not present
+      }
+      if (entry.meter_id == meter_id && entry.manufacturer == manufacturer) {
+        return idx;
+      }
+    }
+  }
+
+  size_t insert_(uint32_t meter_id, uint16_t manufacturer, uint32_t now) {
+    size_t idx = home_(meter_id, manufacturer);
+    while (this->slots_[idx].used) {
+      idx = (idx + 1) & MASK;
+    }
+    CensusEntry &entry = this->slots_[idx];
+    entry = CensusEntry{};
+    entry.meter_id = meter_id;
+    entry.manufacturer = manufacturer;
+    entry.first_seen_ms = now;
+    entry.last_seen_ms = now;
+    entry.count = 1;
+    entry.rssi_dbm = RSSI_UNKNOWN_DBM;
+    entry.used = true;
+    this->count_++;
+    return idx;
+  }
+
+  void evict_lru_(uint32_t now) {
+    // Linear scan; only runs when a new meter arrives at a full table
+    size_t oldest = SIZE;
+    uint32_t oldest_age = 0;
+    for (size_t i = 0; i < SIZE; i++) {
+      if (this->slots_[i].used && (oldest == SIZE || now - this->slots_[i].last_seen_ms > oldest_age)) {
+        oldest = i;
+        oldest_age = now - this->slots_[i].last_seen_ms;
+      }
+    }
+    if (oldest != SIZE) {
+      this->erase_(oldest);
+      this->evictions_++;
+    }
+  }
+
+  void erase_(size_t hole) {
+    // Backward-shift: pull later entries of the probe chain into the hole
+    for (size_t j = (hole + 1) & MASK; this->slots_[j].used; j = (j + 1) & MASK) {
+      size_t home = home_(this->slots_[j].meter_id, this->slots_[j].manufacturer);
+      // Entry at j may move only if its home is not cyclically within (hole, j]
+      bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+      if (!stays) {
+        this->slots_[hole] = this->slots_[j];
+        hole = j;
+      }
+    }
+    this->slots_[hole].used = false;
+    this->count_--;
+  }
+
+  CensusEntry slots_[SIZE]{};
+  size_t count_{0};
+  uint32_t evictions_{0};
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
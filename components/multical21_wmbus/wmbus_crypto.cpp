@@ -1,6 +1,5 @@
 #include "wmbus_crypto.h"
-#include "esphome/core/log.h"
-#include <mbedtls/aes.h>
+#include "wmbus_log.h"
 #include <cstring>
 
 namespace esphome {
@@ -8,56 +7,71 @@ namespace multical21_wmbus {
 
 static const char *const TAG = "multical21_wmbus.crypto";
 
+// Position of the access number inside the AES-CTR IV (after M, A and CI)
+static constexpr uint8_t IV_OFFSET_ACCESS_NUMBER = 9;
+
 // ============================================================================
 // CRC Calculation
 // ============================================================================
 
-uint16_t WMBusCrypto::calculate_crc(const uint8_t *data, uint8_t length) {
-  // CRC-16-EN-13757-4 implementation per spec section 6.1
-  const uint16_t poly = CRC_POLY;
-  uint16_t crc = 0x0000;
-
-  // Initial CRC calculation
-  for (int i = 0; i < 16; i++) {
-    bool bit = crc & 1;
-    if (bit) {
-      crc ^= poly;
-    }
-    crc >>= 1;
-    if (bit) {
-      crc |= 0x8000;
+// CRC-16-EN-13757-4 is a plain MSB-first CRC (poly 0x3D65, init 0x0000, no
+// reflection, final XOR 0xFFFF). The spec's augmented bit-serial form
+// (section 6.1) is equivalent; the table below is generated from the same
+// polynomial at compile time and processes one byte per lookup.
+static constexpr std::array<uint16_t, 256> make_crc_table() {
+  std::array<uint16_t, 256> table{};
+  for (uint16_t i = 0; i < 256; i++) {
+    uint16_t crc = i << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ CRC_POLY) : static_cast<uint16_t>(crc << 1);
     }
+    table[i] = crc;
   }
+  return table;
+}
 
-  // Process each byte
-  for (uint8_t i = 0; i < length; i++) {
-    uint8_t c = data[i];
+static constexpr std::array<uint16_t, 256> CRC_TABLE = make_crc_table();
 
-    for (int j = 7; j >= 0; j--) {
-      bool bit = crc & 0x8000;
-      crc <<= 1;
-      if (c & (1 << j)) {
-        crc |= 1;
-      }
-      if (bit) {
-        crc ^= poly;
-      }
-    }
+uint16_t WMBusCrypto::crc_update(uint16_t state, const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    state = static_cast<uint16_t>((state << 8) ^ CRC_TABLE[((state >> 8) ^ data[i]) & 0xFF]);
   }
+  return state;
+}
 
-  // Final CRC calculation
-  for (int i = 0; i < 16; i++) {
-    bool bit = crc & 0x8000;
-    crc <<= 1;
-    if (bit) {
-      crc ^= poly;
-    }
-  }
+uint16_t WMBusCrypto::calculate_crc(const uint8_t *data, uint8_t length) {
+  return crc_finalize(crc_update(CRC_INIT, data, length));
+}
 
-  // Final XOR
-  crc ^= 0xFFFF;
+// ============================================================================
+// Key Management
+// ============================================================================
 
-  return crc & 0xFFFF;
+WMBusCrypto::WMBusCrypto() {
+  mbedtls_aes_init(&this->aes_ctx_);
+}
+
+WMBusCrypto::~WMBusCrypto() {
+  mbedtls_aes_free(&this->aes_ctx_);
+}
+
+bool WMBusCrypto::set_key(const std::array<uint8_t, 16> &aes_key) {
+  int ret = mbedtls_aes_setkey_enc(&this->aes_ctx_, aes_key.data(), 128);
+  if (ret != 0) {
+    ESP_LOGE(TAG, "AES key setup failed: %d", ret);
+    this->key_set_ = false;
+    return false;
+  }
+  this->key_set_ = true;
+
+  // Keystreams from the old key are useless
+  this->has_prediction_ = false;
+  this->predicted_length_ = 0;
+  this->precompute_pending_ = false;
+  for (auto &slot : this->slots_) {
+    slot.ready = false;
+  }
+  return true;
 }
 
 // ============================================================================
@@ -79,16 +93,20 @@ void WMBusCrypto::build_iv_(const uint8_t *packet, uint8_t *iv) {
   iv[8] = packet[11];
 
   // Bytes 9-12: Access number + Status + Configuration
-  memcpy(&iv[9], &packet[13], 4);
+  memcpy(&iv[IV_OFFSET_ACCESS_NUMBER], &packet[OFFSET_ACCESS_NUMBER], 4);
 
   // Bytes 13-15: Padding (already zero from memset)
 }
 
 bool WMBusCrypto::decrypt_packet(const uint8_t *packet,
                                   uint8_t packet_length,
-                                  const std::array<uint8_t, 16> &aes_key,
                                   uint8_t *plaintext,
                                   uint8_t &plaintext_length) {
+  if (!this->key_set_) {
+    ESP_LOGE(TAG, "No AES key set");
+    return false;
+  }
+
   // Calculate cipher length
   // Cipher spans from byte 17 to byte (packet_length - 2) inclusive
   // Length = (packet_length - 2) - 17 + 1 = packet_length - 18
@@ -99,43 +117,143 @@ bool WMBusCrypto::decrypt_packet(const uint8_t *packet,
     return false;
   }
 
-  // Extract cipher data (starts at byte 17, after header)
-  const uint8_t *cipher_data = &packet[OFFSET_CIPHER_START];
+  // Cipher data starts at byte 17, after header; decrypt it in one piece
+  this->begin_stream(packet, plaintext_length);
+  if (!this->stream_decrypt(&packet[OFFSET_CIPHER_START], plaintext, plaintext_length)) {
+    return false;
+  }
+
+  WMBUS_HOT_LOGD(TAG, "Decryption successful, plaintext length: %u bytes", plaintext_length);
+  return true;
+}
 
+bool WMBusCrypto::begin_stream(const uint8_t *packet, uint8_t cipher_length) {
   // Build IV from packet header
-  uint8_t iv[16];
-  this->build_iv_(packet, iv);
+  this->build_iv_(packet, this->stream_counter_);
+  this->stream_slot_ = nullptr;
+  this->stream_offset_ = 0;
+  this->stream_block_offset_ = 0;
+  this->last_hit_ = false;
+  if (!this->key_set_) {
+    return false;
+  }
 
-  // Decrypt using AES-128-CTR
-  mbedtls_aes_context aes_ctx;
-  mbedtls_aes_init(&aes_ctx);
+  // Predicted telegram: the keystream is already there, decrypting is one XOR
+  if (this->has_prediction_) {
+    for (auto &slot : this->slots_) {
+      if (slot.ready && cipher_length <= slot.length &&
+          memcmp(slot.iv, this->stream_counter_, sizeof(slot.iv)) == 0) {
+        this->stream_slot_ = &slot;
+        this->last_hit_ = true;
+        this->keystream_hits_++;
+        WMBUS_HOT_LOGD(TAG, "Decrypting from precomputed keystream (access number %u)",
+                       this->stream_counter_[IV_OFFSET_ACCESS_NUMBER]);
+        return true;
+      }
+    }
+    this->keystream_misses_++;
+    WMBUS_HOT_LOGD(TAG, "Keystream miss (access number %u)", this->stream_counter_[IV_OFFSET_ACCESS_NUMBER]);
+  }
+  return true;
+}
 
-  size_t nc_off = 0;
-  uint8_t nonce_counter[16];
-  uint8_t stream_block[16];
+bool WMBusCrypto::stream_decrypt(const uint8_t *cipher, uint8_t *plaintext, size_t length) {
+  if (!this->key_set_) {
+    ESP_LOGE(TAG, "No AES key set");
+    return false;
+  }
 
-  memcpy(nonce_counter, iv, 16);
+  if (this->stream_slot_ != nullptr) {
+    const uint8_t *stream = &this->stream_slot_->stream[this->stream_offset_];
+    for (size_t i = 0; i < length; i++) {
+      plaintext[i] = cipher[i] ^ stream[i];
+    }
+    this->stream_offset_ += length;
+    return true;
+  }
 
-  int ret = mbedtls_aes_setkey_enc(&aes_ctx, aes_key.data(), 128);
+  // AES-128-CTR with the cached key schedule; counter, block and offset
+  // carry over, so a chunk may end mid-block
+  int ret = mbedtls_aes_crypt_ctr(&this->aes_ctx_, length, &this->stream_block_offset_, this->stream_counter_,
+                                  this->stream_block_, cipher, plaintext);
   if (ret != 0) {
-    ESP_LOGE(TAG, "AES key setup failed: %d", ret);
-    mbedtls_aes_free(&aes_ctx);
+    ESP_LOGE(TAG, "AES decryption failed: %d", ret);
     return false;
   }
+  this->stream_offset_ += length;
+  return true;
+}
 
-  ret = mbedtls_aes_crypt_ctr(&aes_ctx, plaintext_length, &nc_off,
-                               nonce_counter, stream_block,
-                               cipher_data, plaintext);
+// ============================================================================
+// Keystream Prediction
+// ============================================================================
 
-  mbedtls_aes_free(&aes_ctx);
+void WMBusCrypto::predict_next(const uint8_t *packet, uint8_t skip) {
+  for (auto &slot : this->slots_) {
+    slot.ready = false;
+  }
 
-  if (ret != 0) {
-    ESP_LOGE(TAG, "AES decryption failed: %d", ret);
-    return false;
+  // Cover the longest frame type seen, so compact and long frames both hit
+  uint8_t cipher_length = packet[0] - CRC_SIZE - OFFSET_CIPHER_START + 1;
+  if (cipher_length > KEYSTREAM_MAX_SIZE) {
+    this->has_prediction_ = false;
+    this->precompute_pending_ = false;
+    return;
+  }
+  if (cipher_length > this->predicted_length_) {
+    this->predicted_length_ = cipher_length;
   }
 
-  ESP_LOGD(TAG, "Decryption successful, plaintext length: %u bytes", plaintext_length);
-  return true;
+  this->build_iv_(packet, this->predicted_iv_);
+  this->prediction_skip_ = skip;
+  this->has_prediction_ = true;
+  this->precompute_pending_ = true;
+}
+
+void WMBusCrypto::set_prediction_skip(uint8_t skip) {
+  if (!this->has_prediction_ || skip == this->prediction_skip_) {
+    return;
+  }
+  this->prediction_skip_ = skip;
+  this->precompute_pending_ = true;
+  for (auto &slot : this->slots_) {
+    slot.ready = false;
+  }
+}
+
+void WMBusCrypto::precompute_keystream() {
+  this->precompute_pending_ = false;
+  if (!this->key_set_ || !this->has_prediction_) {
+    return;
+  }
+
+  // CTR keystream is the cipher output for an all-zero input
+  static const uint8_t ZEROS[KEYSTREAM_MAX_SIZE] = {};
+
+  for (uint8_t i = 0; i < KEYSTREAM_SLOTS; i++) {
+    KeystreamSlot &slot = this->slots_[i];
+    memcpy(slot.iv, this->predicted_iv_, sizeof(slot.iv));
+    // Access number wraps at 255 like the meter's counter
+    slot.iv[IV_OFFSET_ACCESS_NUMBER] = static_cast<uint8_t>(
+        this->predicted_iv_[IV_OFFSET_ACCESS_NUMBER] + 1 + this->prediction_skip_ + i);
+
+    size_t nc_off = 0;
+    uint8_t nonce_counter[16];
+    uint8_t stream_block[16];
+    memcpy(nonce_counter, slot.iv, 16);
+
+    int ret = mbedtls_aes_crypt_ctr(&this->aes_ctx_, this->predicted_length_, &nc_off,
+                                    nonce_counter, stream_block, ZEROS, slot.stream);
+    slot.length = this->predicted_length_;
+    slot.ready = (ret == 0);
+    if (ret != 0) {
+      ESP_LOGW(TAG, "Keystream precompute failed: %d", ret);
+    }
+  }
+
+  ESP_LOGV(TAG, "Precomputed keystream for access numbers %u..%u",
+           (uint8_t) (this->predicted_iv_[IV_OFFSET_ACCESS_NUMBER] + 1 + this->prediction_skip_),
+           (uint8_t) (this->predicted_iv_[IV_OFFSET_ACCESS_NUMBER] + this->prediction_skip_ + KEYSTREAM_SLOTS));
 }
 
 }  // namespace multical21_wmbus
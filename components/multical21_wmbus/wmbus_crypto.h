@@ -1,7 +1,9 @@
 #pragma once
 
 #include "wmbus_types.h"
+#include <mbedtls/aes.h>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace esphome {
@@ -13,15 +15,54 @@ namespace multical21_wmbus {
  * Handles all cryptographic operations including CRC calculation
  * and AES-128-CTR decryption for wMBUS Mode C packets.
  *
+ * The AES key schedule is expanded once in set_key() and kept in a long-lived
+ * cipher context, so per-telegram work is only IV construction and CTR.
+ *
+ * Optionally, the CTR keystream for the meter's next access number(s) can be
+ * generated ahead of time (predict_next() + precompute_keystream()). A
+ * telegram whose IV matches a precomputed slot is then decrypted with a
+ * single XOR; any mismatch falls back to the normal CTR path. Only as much
+ * keystream as the meter's longest telegram so far needs is generated.
+ *
+ * A telegram can also be decrypted piecewise as its bytes arrive
+ * (begin_stream() + stream_decrypt()); decrypt_packet() is the same path
+ * run over the whole ciphertext at once.
+ *
  * Responsibility: Isolated crypto operations with no hardware dependencies.
  * Extracted from: multical21_wmbus.cpp lines 615-727
  */
 class WMBusCrypto {
  public:
+  WMBusCrypto();
+  ~WMBusCrypto();
+
+  // Owns an mbedTLS context; not copyable
+  WMBusCrypto(const WMBusCrypto &) = delete;
+  WMBusCrypto &operator=(const WMBusCrypto &) = delete;
+
+  /**
+   * @brief Expand and cache the AES-128 key schedule
+   *
+   * Call at setup and whenever the key changes.
+   *
+   * @param aes_key 16-byte AES-128 encryption key
+   * @return true if the key was accepted
+   */
+  bool set_key(const std::array<uint8_t, 16> &aes_key);
+
+  /**
+   * @brief Check whether a key has been set
+   */
+  bool has_key() const { return this->key_set_; }
+
+  /// Initial CRC state for crc_update()
+  static constexpr uint16_t CRC_INIT = 0x0000;
+
   /**
    * @brief Calculate CRC-16-EN-13757-4 checksum
    *
    * Implements the CRC algorithm specified in EN 13757-4 for wMBUS packets.
+   * Equivalent to crc_finalize(crc_update(CRC_INIT, data, length)).
    *
    * @param data Pointer to data buffer
    * @param length Number of bytes to process
@@ -29,25 +70,118 @@ class WMBusCrypto {
    */
   static uint16_t calculate_crc(const uint8_t *data, uint8_t length);
 
+  /**
+   * @brief Feed bytes into a running CRC-16-EN-13757-4 state
+   *
+   * Table-driven (one lookup per byte). Can be called repeatedly to process a
+   * telegram in chunks, e.g. per block or as bytes arrive from the FIFO.
+   *
+   * @param state Running state (start with CRC_INIT)
+   * @param data Pointer to data buffer
+   * @param length Number of bytes to process
+   * @return Updated state
+   */
+  static uint16_t crc_update(uint16_t state, const uint8_t *data, size_t length);
+
+  /**
+   * @brief Turn a running CRC state into the transmitted CRC value
+   *
+   * @param state Running state from crc_update()
+   * @return 16-bit CRC value (final XOR applied)
+   */
+  static uint16_t crc_finalize(uint16_t state) { return state ^ 0xFFFF; }
+
   /**
    * @brief Decrypt AES-128-CTR encrypted wMBUS payload
    *
    * Decrypts the encrypted portion of a wMBUS packet using AES-128 in CTR mode.
    * The IV is automatically constructed from the packet header per EN 13757-4.
+   * Uses the key schedule cached by set_key().
    *
    * @param packet Pointer to complete packet buffer (including header)
    * @param packet_length Total length of packet (L-field value)
-   * @param aes_key 16-byte AES-128 encryption key
    * @param plaintext Output buffer for decrypted data (must be at least 64 bytes)
    * @param plaintext_length Output parameter - receives length of decrypted data
    * @return true if decryption succeeded, false on error
    */
   bool decrypt_packet(const uint8_t *packet,
                       uint8_t packet_length,
-                      const std::array<uint8_t, 16> &aes_key,
                       uint8_t *plaintext,
                       uint8_t &plaintext_length);
 
+  /**
+   * @brief Start decrypting a telegram piecewise
+   *
+   * Builds the IV and picks a precomputed keystream slot if one matches.
+   * Only the header (up to OFFSET_CIPHER_START) must be present.
+   *
+   * @param packet Pointer to packet buffer (includes header)
+   * @param cipher_length Ciphertext bytes the telegram will carry
+   * @return true if a key is set
+   */
+  bool begin_stream(const uint8_t *packet, uint8_t cipher_length);
+
+  /**
+   * @brief Decrypt the next ciphertext bytes of the telegram from begin_stream()
+   *
+   * Bytes must be passed in order; chunks of any size are fine, as CTR
+   * state carries over between calls. cipher and plaintext may be the same
+   * buffer.
+   *
+   * @param cipher Next ciphertext bytes
+   * @param plaintext Output buffer
+   * @param length Number of bytes
+   * @return true on success
+   */
+  bool stream_decrypt(const uint8_t *cipher, uint8_t *plaintext, size_t length);
+
+  /**
+   * @brief Predict the IVs of the next telegrams from a decrypted one
+   *
+   * Cheap: only records the IV template. The keystream itself is generated
+   * later by precompute_keystream(). Slots cover access numbers
+   * last + 1 + skip .. last + KEYSTREAM_SLOTS + skip (mod 256); status and
+   * configuration bytes are assumed unchanged. Slots are as long as the
+   * longest ciphertext seen from this meter; a meter whose telegrams exceed
+   * KEYSTREAM_MAX_SIZE is not predicted.
+   *
+   * @param packet Pointer to the last successfully decrypted packet
+   * @param skip Telegrams assumed missed since then (0 = next is last + 1)
+   */
+  void predict_next(const uint8_t *packet, uint8_t skip = 0);
+
+  /**
+   * @brief Shift an existing prediction to assume missed telegrams
+   *
+   * No-op if nothing was predicted yet or the skip is unchanged.
+   *
+   * @param skip Telegrams assumed missed since the last decrypted one
+   */
+  void set_prediction_skip(uint8_t skip);
+
+  /**
+   * @brief Check whether predicted slots still need their keystream
+   */
+  bool is_precompute_pending() const { return this->precompute_pending_; }
+
+  /**
+   * @brief Generate the keystream for all predicted slots
+   *
+   * Costs the same AES work as decrypting KEYSTREAM_SLOTS of the meter's telegrams;
+   * call it while the receiver is idle, not on the arrival path.
+   */
+  void precompute_keystream();
+
+  /**
+   * @brief Whether the last decrypt_packet() call used a precomputed keystream
+   */
+  bool last_decrypt_was_hit() const { return this->last_hit_; }
+
+  /// Decrypts served from a precomputed keystream
+  uint32_t get_keystream_hits() const { return this->keystream_hits_; }
+  /// Decrypts that had a prediction but no matching slot
+  uint32_t get_keystream_misses() const { return this->keystream_misses_; }
+
  private:
   /**
    * @brief Build AES-CTR initialization vector from packet header
@@ -58,6 +192,37 @@ class WMBusCrypto {
    * @param iv Output buffer for 16-byte IV (must be pre-allocated)
    */
   void build_iv_(const uint8_t *packet, uint8_t *iv);
+
+  /**
+   * @brief One predicted telegram: its IV and CTR keystream
+   */
+  struct KeystreamSlot {
+    uint8_t iv[16];
+    uint8_t stream[KEYSTREAM_MAX_SIZE];
+    uint8_t length;  // Valid bytes of stream
+    bool ready;
+  };
+
+  mbedtls_aes_context aes_ctx_;  // Expanded key schedule, valid when key_set_
+  bool key_set_{false};
+
+  // Telegram being decrypted by stream_decrypt()
+  const KeystreamSlot *stream_slot_{nullptr};  // Precomputed keystream, or nullptr for CTR
+  size_t stream_offset_{0};                    // Bytes decrypted so far
+  size_t stream_block_offset_{0};              // Used bytes of stream_block_ (mbedTLS nc_off)
+  uint8_t stream_counter_[16]{};
+  uint8_t stream_block_[16]{};
+
+  // Keystream prediction
+  KeystreamSlot slots_[KEYSTREAM_SLOTS]{};
+  uint8_t predicted_iv_[16]{};     // IV of the last decrypted telegram
+  uint8_t prediction_skip_{0};
+  uint8_t predicted_length_{0};    // Longest ciphertext seen from this meter
+  bool has_prediction_{false};
+  bool precompute_pending_{false};
+  bool last_hit_{false};
+  uint32_t keystream_hits_{0};
+  uint32_t keystream_misses_{0};
 };
 
 }  // namespace multical21_wmbus
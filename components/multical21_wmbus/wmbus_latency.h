@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Hot-path stage timing
+ *
+ * With MULTICAL21_WMBUS_LATENCY_HISTOGRAMS (latency_histograms: true) each
+ * stage of a telegram's path is timed with the CPU cycle counter and fed into
+ * a log2 histogram. Without it the macros below compile to nothing.
+ *
+ * WMBUS_LATENCY_BEGIN(name) declares a start timestamp; WMBUS_LATENCY_END()
+ * records the cycles elapsed since a timestamp. Both expect
+ * esphome/core/hal.h (arch_get_cpu_cycle_count()) in the including unit.
+ */
+#ifdef MULTICAL21_WMBUS_LATENCY_HISTOGRAMS
+#define WMBUS_LATENCY_BEGIN(name) const uint32_t name = arch_get_cpu_cycle_count()
+#define WMBUS_LATENCY_END(stats, stage, start) (stats).record((stage), arch_get_cpu_cycle_count() - (start))
+#else
+#define WMBUS_LATENCY_BEGIN(name) \
+  do { \
+  } while (false)
+#define WMBUS_LATENCY_END(stats, stage, start) \
+  do { \
+  } while (false)
+#endif
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief Timed stages of the receive path
+ */
+enum class LatencyStage : uint8_t {
+  LOOP_WAKE,   // GDO0 ISR -> loop() handles the telegram
+  FIFO_DRAIN,  // Reading the FIFO into the packet ring
+  CRC,
+  AES,
+  PLAINTEXT_READY,  // GDO0 ISR -> CRC verdict and plaintext ready
+  PARSE,
+  PUBLISH,
+  TOTAL,       // GDO0 ISR -> all buffered telegrams published
+};
+
+constexpr uint8_t LATENCY_STAGE_COUNT = 8;
+
+inline const char *latency_stage_to_string(LatencyStage stage) {
+  switch (stage) {
+    case LatencyStage::LOOP_WAKE:
+      return "loop wake";
+    case LatencyStage::FIFO_DRAIN:
+      return "FIFO drain";
+    case LatencyStage::CRC:
+      return "CRC";
+    case LatencyStage::AES:
+      return "AES";
+    case LatencyStage::PLAINTEXT_READY:
+      return "plaintext";
+    case LatencyStage::PARSE:
+      return "parse";
+    case LatencyStage::PUBLISH:
+      return "publish";
+    case LatencyStage::TOTAL:
+      return "total";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief Fixed-bucket log2 histogram of cycle counts
+ *
+ * Bucket b counts samples in [2^(b-1), 2^b) cycles (bucket 0: zero), so
+ * 33 counters cover the whole uint32_t range. Recording is a count-leading-
+ * zeros and an increment; percentiles are resolved to a bucket's upper bound
+ * (capped at the largest sample), i.e. to within a factor of two.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr uint8_t BUCKET_COUNT = 33;
+
+  void record(uint32_t cycles) {
+    uint8_t bucket = cycles == 0 ? 0 : 32 - __builtin_clz(cycles);
+    this->buckets_[bucket]++;
+    this->count_++;
+    if (cycles > this->max_) {
+      this->max_ = cycles;
+    }
+  }
+
+  /**
+   * @brief Upper bound of the bucket holding the given percentile
+   *
+   * @param percentile 1..100
+   * @return Cycles (0 if nothing recorded)
+   */
+  uint32_t percentile(uint8_t percentile) const {
+    if (this->count_ == 0) {
+      return 0;
+    }
+    // Rank of the sample at the percentile, rounded up
+    uint32_t rank = (static_cast<uint64_t>(this->count_) * percentile + 99) / 100;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+      seen += this->buckets_[b];
+      if (seen >= rank) {
+        uint32_t bound = bucket_upper_bound(b);
+        return bound < this->max_ ? bound : this->max_;
+      }
+    }
+    return this->max_;
+  }
+
+  /**
+   * @brief Largest cycle count that falls into bucket b
+   */
+  static uint32_t bucket_upper_bound(uint8_t b) {
+    return b == 0 ? 0 : static_cast<uint32_t>((1ULL << b) - 1);
+  }
+
+  uint32_t get_bucket(uint8_t b) const { return this->buckets_[b]; }
+  uint32_t get_count() const { return this->count_; }
+  uint32_t get_max() const { return this->max_; }
+
+ protected:
+  uint32_t buckets_[BUCKET_COUNT]{};
+  uint32_t count_{0};
+  uint32_t max_{0};
+};
+
+/**
+ * @brief One histogram per receive stage
+ */
+class WMBusLatencyStats {
+ public:
+  void record(LatencyStage stage, uint32_t cycles) {
+    this->histograms_[static_cast<uint8_t>(stage)].record(cycles);
+  }
+
+  const LatencyHistogram &get(LatencyStage stage) const {
+    return this->histograms_[static_cast<uint8_t>(stage)];
+  }
+
+ protected:
+  LatencyHistogram histograms_[LATENCY_STAGE_COUNT];
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @brief Logging macros for the decode pipeline units
+ *
+ * wmbus_crypto, wmbus_packet_parser and wmbus_packet_buffer log through this
+ * header instead of esphome/core/log.h directly. On target it resolves to the
+ * ESPHome logger; off-device (no ESPHome headers on the include path) errors
+ * and warnings go to stderr and everything else compiles away, so these units
+ * can be built and benchmarked natively.
+ *
+ * Per-telegram (hot path) messages use the WMBUS_HOT_LOGx variants. With the
+ * quiet log profile (MULTICAL21_WMBUS_QUIET_LOGGING) they are compiled out,
+ * format strings included; the arguments are still type-checked.
+ */
+
+#include <cstdio>
+
+#define WMBUS_LOG_DISCARD_(...) \
+  do { \
+    if (false) \
+      printf(__VA_ARGS__); \
+  } while (false)
+
+#if __has_include("esphome/core/log.h")
+#include "esphome/core/defines.h"
+#include "esphome/core/log.h"
+#else
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "[E][%s] " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "[W][%s] " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define ESP_LOGVV(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define ESP_LOGCONFIG(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#endif
+
+#ifdef MULTICAL21_WMBUS_QUIET_LOGGING
+#define WMBUS_HOT_LOGI(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define WMBUS_HOT_LOGD(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#define WMBUS_HOT_LOGV(tag, format, ...) WMBUS_LOG_DISCARD_(format, ##__VA_ARGS__)
+#else
+#define WMBUS_HOT_LOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define WMBUS_HOT_LOGD(tag, format, ...) ESP_LOGD(tag, format, ##__VA_ARGS__)
+#define WMBUS_HOT_LOGV(tag, format, ...) ESP_LOGV(tag, format, ##__VA_ARGS__)
+#endif
@@ -0,0 +1,80 @@
+#include "wmbus_meter.h"
+#include "wmbus_log.h"
+#include "esphome/core/helpers.h"
+#include <algorithm>
+#include <array>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+static const char *const TAG = "multical21_wmbus.meter";
+
+void WMBusMeter::set_aes_key(const std::vector<uint8_t> &aes_key) {
+  // Expand the key schedule once here rather than per telegram
+  std::array<uint8_t, 16> aes_key_array{};
+  std::copy_n(aes_key.begin(), std::min(aes_key.size(), aes_key_array.size()), aes_key_array.begin());
+  this->crypto_.set_key(aes_key_array);
+}
+
+void WMBusMeter::record_signal(int16_t rssi_dbm, uint8_t lqi) {
+  if (rssi_dbm == RSSI_UNKNOWN_DBM) {
+    return;  // Not measured during the telegram; keep it out of the averages
+  }
+  if (this->signal_count_ == 0) {
+    this->rssi_avg_x16_ = rssi_dbm * 16;
+    this->lqi_avg_x16_ = lqi * 16;
+  } else {
+    this->rssi_avg_x16_ += (rssi_dbm * 16 - this->rssi_avg_x16_) / 8;
+    this->lqi_avg_x16_ += (lqi * 16 - this->lqi_avg_x16_) / 8;
+  }
+  this->last_rssi_dbm_ = rssi_dbm;
+  this->last_lqi_ = lqi;
+  this->signal_count_++;
+}
+
+void WMBusMeter::publish(const WMBusMeterData &data) {
+  // Publish to ESPHome sensors
+  if (this->total_consumption_sensor_ != nullptr) {
+    this->total_consumption_sensor_->publish_state(data.total_consumption_m3);
+  }
+  if (this->target_consumption_sensor_ != nullptr) {
+    this->target_consumption_sensor_->publish_state(data.target_consumption_m3);
+  }
+  if (this->flow_temperature_sensor_ != nullptr) {
+    this->flow_temperature_sensor_->publish_state(data.flow_temperature_c);
+  }
+  if (this->ambient_temperature_sensor_ != nullptr) {
+    this->ambient_temperature_sensor_->publish_state(data.ambient_temperature_c);
+  }
+  if (this->info_codes_sensor_ != nullptr) {
+    // Only place a status string is built
+    char status[WMBusPacketParser::STATUS_STRING_SIZE];
+    this->info_codes_sensor_->publish_state(
+        data.has_info_codes ? WMBusPacketParser::format_status(data.info_codes, status) : "unknown");
+  }
+  if (this->signal_count_ > 0) {
+    if (this->rssi_sensor_ != nullptr) {
+      this->rssi_sensor_->publish_state(this->get_rssi_avg_dbm());
+    }
+    if (this->lqi_sensor_ != nullptr) {
+      this->lqi_sensor_->publish_state(this->get_lqi_avg());
+    }
+  }
+  WMBUS_HOT_LOGI(TAG, "Meter %08X data published to sensors", (unsigned) this->get_meter_id());
+}
+
+void WMBusMeter::dump_config() {
+  // Display meter ID in the same order as printed on the physical meter
+  ESP_LOGCONFIG(TAG, "  Meter %08X:", (unsigned) this->get_meter_id());
+  LOG_SENSOR("    ", "Total Consumption", this->total_consumption_sensor_);
+  LOG_SENSOR("    ", "Target Consumption", this->target_consumption_sensor_);
+  LOG_SENSOR("    ", "Flow Temperature", this->flow_temperature_sensor_);
+  LOG_SENSOR("    ", "Ambient Temperature", this->ambient_temperature_sensor_);
+  LOG_TEXT_SENSOR("    ", "Info Codes", this->info_codes_sensor_);
+  LOG_SENSOR("    ", "RSSI", this->rssi_sensor_);
+  LOG_SENSOR("    ", "LQI", this->lqi_sensor_);
+  ESP_LOGCONFIG(TAG, "    AES key: %s", YESNO(this->crypto_.has_key()));
+}
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/text_sensor/text_sensor.h"
+#include "wmbus_types.h"
+#include "wmbus_crypto.h"
+#include "wmbus_meter_table.h"
+#include "wmbus_packet_parser.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+// ============================================================================
+// Meter
+// ============================================================================
+
+/**
+ * @brief One configured Multical21 meter
+ *
+ * Holds everything that differs between meters: the expanded AES key
+ * schedule (so switching meters costs nothing per telegram), transmission
+ * and signal statistics and the meter's own sensors.
+ *
+ * Responsibility: Per-meter state and publishing - no radio or FIFO handling.
+ */
+class WMBusMeter {
+ public:
+  explicit WMBusMeter(uint32_t meter_id) { this->stats_.meter_id = meter_id; }
+
+  uint32_t get_meter_id() const { return this->stats_.meter_id; }
+
+  /**
+   * @brief wM-Bus mode the meter transmits in (for mode: c1_t1 scheduling)
+   */
+  void set_mode(RadioMode mode) { this->mode_ = mode; }
+  RadioMode get_mode() const { return this->mode_; }
+
+  /**
+   * @brief Expand and cache this meter's AES-128 key schedule
+   *
+   * @param aes_key 16-byte key from YAML
+   */
+  void set_aes_key(const std::vector<uint8_t> &aes_key);
+
+  WMBusCrypto &get_crypto() { return this->crypto_; }
+  const WMBusCrypto &get_crypto() const { return this->crypto_; }
+  MeterStats &get_stats() { return this->stats_; }
+  const MeterStats &get_stats() const { return this->stats_; }
+
+  // Sensor setters
+  void set_total_consumption_sensor(sensor::Sensor *sensor) { this->total_consumption_sensor_ = sensor; }
+  void set_target_consumption_sensor(sensor::Sensor *sensor) { this->target_consumption_sensor_ = sensor; }
+  void set_flow_temperature_sensor(sensor::Sensor *sensor) { this->flow_temperature_sensor_ = sensor; }
+  void set_ambient_temperature_sensor(sensor::Sensor *sensor) { this->ambient_temperature_sensor_ = sensor; }
+  void set_info_codes_sensor(text_sensor::TextSensor *sensor) { this->info_codes_sensor_ = sensor; }
+  bool has_info_codes_sensor() const { return this->info_codes_sensor_ != nullptr; }
+  void set_rssi_sensor(sensor::Sensor *sensor) { this->rssi_sensor_ = sensor; }
+  void set_lqi_sensor(sensor::Sensor *sensor) { this->lqi_sensor_ = sensor; }
+
+  /**
+   * @brief Fold one telegram's signal status into the rolling averages
+   *
+   * Moving averages with 1/8 weight per telegram, kept in 1/16 units so no
+   * float math runs per telegram. Telegrams without a measured status
+   * (RSSI_UNKNOWN_DBM) are skipped.
+   *
+   * @param rssi_dbm Signal strength of the telegram
+   * @param lqi Link quality indicator (lower is better)
+   */
+  void record_signal(int16_t rssi_dbm, uint8_t lqi);
+
+  uint32_t get_signal_count() const { return this->signal_count_; }
+  int16_t get_last_rssi_dbm() const { return this->last_rssi_dbm_; }
+  uint8_t get_last_lqi() const { return this->last_lqi_; }
+  float get_rssi_avg_dbm() const { return this->rssi_avg_x16_ / 16.0f; }
+  float get_lqi_avg() const { return this->lqi_avg_x16_ / 16.0f; }
+
+  /**
+   * @brief Publish parsed readings to this meter's sensors
+   */
+  void publish(const WMBusMeterData &data);
+
+  /**
+   * @brief Log meter ID and sensors for dump_config()
+   */
+  void dump_config();
+
+ protected:
+  WMBusCrypto crypto_;
+  MeterStats stats_{};
+  RadioMode mode_{RadioMode::C1};
+
+  sensor::Sensor *total_consumption_sensor_{nullptr};
+  sensor::Sensor *target_consumption_sensor_{nullptr};
+  sensor::Sensor *flow_temperature_sensor_{nullptr};
+  sensor::Sensor *ambient_temperature_sensor_{nullptr};
+  text_sensor::TextSensor *info_codes_sensor_{nullptr};
+  sensor::Sensor *rssi_sensor_{nullptr};
+  sensor::Sensor *lqi_sensor_{nullptr};
+
+  // Signal quality of telegrams that passed CRC
+  uint32_t signal_count_{0};
+  int16_t last_rssi_dbm_{0};
+  int16_t rssi_avg_x16_{0};  // Moving average in 1/16 dBm
+  uint16_t lqi_avg_x16_{0};  // Moving average in 1/16 LQI
+  uint8_t last_lqi_{0};
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
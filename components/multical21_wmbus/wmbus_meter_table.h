@@ -0,0 +1,110 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include <cstddef>
+#include <cstdint>
+
+// Meter IDs from YAML (meters:), emitted by codegen in ascending order
+#ifndef MULTICAL21_WMBUS_METER_COUNT
+#define MULTICAL21_WMBUS_METER_COUNT 1
+#define MULTICAL21_WMBUS_METER_IDS 0x00000000
+#endif
+
+namespace esphome {
+namespace multical21_wmbus {
+
+constexpr size_t METER_COUNT = MULTICAL21_WMBUS_METER_COUNT;
+
+// Meter IDs as printed on the meter (0x12345678 for "12345678"), ascending
+constexpr uint32_t METER_IDS[METER_COUNT] = {MULTICAL21_WMBUS_METER_IDS};
+
+constexpr bool meter_ids_sorted() {
+  for (size_t i = 1; i < METER_COUNT; i++) {
+    if (METER_IDS[i - 1] >= METER_IDS[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(meter_ids_sorted(), "Meter ID table must be sorted and free of duplicates");
+
+// Hash slots: a power of two at least twice METER_COUNT, so probe runs stay short
+constexpr size_t meter_hash_bits() {
+  size_t bits = 1;
+  while ((static_cast<size_t>(1) << bits) < 2 * METER_COUNT) {
+    bits++;
+  }
+  return bits;
+}
+
+constexpr size_t METER_HASH_BITS = meter_hash_bits();
+constexpr size_t METER_HASH_SIZE = static_cast<size_t>(1) << METER_HASH_BITS;
+
+/**
+ * @brief Home slot of a meter ID (Fibonacci hashing)
+ *
+ * Takes the top bits of a multiplicative hash, which spreads runs of
+ * consecutive serial numbers evenly.
+ */
+constexpr size_t meter_hash_slot(uint32_t meter_id) {
+  return static_cast<uint32_t>(meter_id * 0x9E3779B1u) >> (32 - METER_HASH_BITS);
+}
+
+/**
+ * @brief Open-addressed ID table built at compile time
+ *
+ * Each slot holds an index into METER_IDS plus one (0: empty). Linear
+ * probing; at most half the slots are used, so every probe run ends.
+ */
+struct MeterHashTable {
+  uint16_t slots[METER_HASH_SIZE];
+};
+
+constexpr MeterHashTable make_meter_hash_table() {
+  MeterHashTable table{};
+  for (size_t i = 0; i < METER_COUNT; i++) {
+    size_t slot = meter_hash_slot(METER_IDS[i]);
+    while (table.slots[slot] != 0) {
+      slot = (slot + 1) & (METER_HASH_SIZE - 1);
+    }
+    table.slots[slot] = static_cast<uint16_t>(i + 1);
+  }
+  return table;
+}
+
+constexpr MeterHashTable METER_HASH_TABLE = make_meter_hash_table();
+
+/**
+ * @brief Find a meter's slot in METER_IDS
+ *
+ * One multiply and usually one or two table probes, whatever the number of
+ * meters; no heap.
+ *
+ * @param meter_id Meter ID (see METER_IDS)
+ * @return Index into METER_IDS, or -1 if the meter is not configured
+ */
+constexpr int find_meter_index(uint32_t meter_id) {
+  for (size_t slot = meter_hash_slot(meter_id);; slot = (slot + 1) & (METER_HASH_SIZE - 1)) {
+    uint16_t entry = METER_HASH_TABLE.slots[slot];
+    if (entry == 0) {
+      return -1;
+    }
+    if (METER_IDS[entry - 1] == meter_id) {
+      return entry - 1;
+    }
+  }
+}
+
+/**
+ * @brief Convert the little-endian A-field of a telegram to a meter ID
+ *
+ * @param meter_id_le 4 bytes starting at OFFSET_METER_ID
+ */
+inline uint32_t meter_id_from_le(const uint8_t *meter_id_le) {
+  return (static_cast<uint32_t>(meter_id_le[3]) << 24) | (static_cast<uint32_t>(meter_id_le[2]) << 16) |
+         (static_cast<uint32_t>(meter_id_le[1]) << 8) | meter_id_le[0];
+}
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
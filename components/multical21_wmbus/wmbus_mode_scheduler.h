@@ -0,0 +1,266 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include "wmbus_meter_table.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief What the scheduler knows about one configured meter
+ */
+struct ScheduleEntry {
+  uint32_t first_seen_ms;
+  uint32_t last_seen_ms;
+  uint32_t interval_ms;  // Learned transmit interval, corrected for missed telegrams (0: unknown)
+  uint32_t short_gap_ms;  // Gap well below interval_ms waiting to be confirmed (0: none)
+  uint32_t captures;
+  uint8_t access_number;  // Of the last capture
+  RadioMode mode;
+};
+
+/**
+ * @brief Time-sliced C1/T1 scheduling for a single radio
+ *
+ * Every configured meter is received in its own mode. From each meter's
+ * captures the scheduler learns its transmit interval and opens a window of
+ * +-guard around every transmission it expects (interval / 16, at least
+ * SCHEDULER_MIN_GUARD_MS). Whenever a window is open the radio listens in
+ * that meter's mode; of several open windows the one closing first wins.
+ * Between windows the radio waits in the mode of the next window to open.
+ * While a mode still has meters without a learned interval, the gaps
+ * between windows are instead shared out in slices of
+ * SCHEDULER_DWELL_MS + jitter, so the slices do not lock onto the meters'
+ * transmit period.
+ *
+ * MeterStats averages capture gaps, which on a time-sliced radio include
+ * every missed telegram. The interval here is corrected instead: a gap is
+ * divided by the number of intervals it spans, and a gap well below the
+ * estimate replaces it (the estimate itself spanned misses) once the next
+ * gap confirms it. A repeater's copy of a telegram (same access number)
+ * and captures closer than SCHEDULER_MIN_GAP_MS are ignored, so neither
+ * can collapse the interval.
+ *
+ * Capture rate per mode is telegrams captured over telegrams the meters of
+ * that mode are expected to have sent since their first capture.
+ *
+ * Thread Safety: not thread-safe; use from loop() only.
+ */
+class WMBusModeScheduler {
+ public:
+  void set_meter_mode(size_t index, RadioMode mode) { this->entries_[index].mode = mode; }
+  RadioMode get_meter_mode(size_t index) const { return this->entries_[index].mode; }
+
+  /**
+   * @brief Learned timing of a meter (also used for RX windowing)
+   */
+  const ScheduleEntry &get_entry(size_t index) const { return this->entries_[index]; }
+
+  /**
+   * @brief A telegram of a configured meter passed CRC
+   *
+   * @param index Meter index (see METER_IDS)
+   * @param now Current time in milliseconds
+   * @param access_number Access number from the telegram header
+   * @return false if the telegram was ignored as a repeated copy
+   */
+  bool record(size_t index, uint32_t now, uint8_t access_number) {
+    ScheduleEntry &entry = this->entries_[index];
+    if (entry.captures == 0) {
+      entry.first_seen_ms = now;
+    } else {
+      uint32_t gap_ms = now - entry.last_seen_ms;
+      bool repeated = access_number == entry.access_number && (entry.interval_ms == 0 || gap_ms < entry.interval_ms / 2);
+      if (repeated || gap_ms < SCHEDULER_MIN_GAP_MS) {
+        this->ignored_++;
+        return false;
+      }
+      if (entry.interval_ms == 0) {
+        entry.interval_ms = gap_ms;
+      } else if (gap_ms < entry.interval_ms - entry.interval_ms / 4) {
+        // One short gap may be a stray telegram; two in a row that agree
+        // mean the estimate spanned misses (or the meter got faster)
+        uint32_t tolerance_ms = entry.short_gap_ms / 8;
+        if (entry.short_gap_ms != 0 && gap_ms + tolerance_ms >= entry.short_gap_ms &&
+            gap_ms <= entry.short_gap_ms + tolerance_ms) {
+          entry.interval_ms = gap_ms;
+          entry.short_gap_ms = 0;
+        } else {
+          entry.short_gap_ms = gap_ms;
+        }
+      } else {
+        uint32_t spanned = (gap_ms + entry.interval_ms / 2) / entry.interval_ms;
+        int32_t error_ms = static_cast<int32_t>(gap_ms / spanned - entry.interval_ms);
+        entry.interval_ms += error_ms / 8;
+        entry.short_gap_ms = 0;
+      }
+    }
+    entry.last_seen_ms = now;
+    entry.access_number = access_number;
+    entry.captures++;
+    return true;
+  }
+
+  /**
+   * @brief Mode the radio should be in now
+   *
+   * @param now Current time in milliseconds
+   * @param current Mode the radio is in
+   */
+  RadioMode select(uint32_t now, RadioMode current) {
+    bool window_open = false;
+    uint32_t open_closes_in = UINT32_MAX;
+    RadioMode open_mode = current;
+    uint32_t next_opens_in = UINT32_MAX;
+    RadioMode next_mode = current;
+    bool unlearned[RADIO_MODE_COUNT]{};
+
+    for (const ScheduleEntry &entry : this->entries_) {
+      if (entry.interval_ms == 0) {
+        unlearned[static_cast<uint8_t>(entry.mode)] = true;
+        continue;
+      }
+      // Next transmission whose window has not closed yet, sliding over missed ones
+      uint32_t guard_ms = guard_ms_(entry);
+      uint32_t elapsed_ms = now - entry.last_seen_ms;
+      uint32_t intervals = elapsed_ms > guard_ms ? (elapsed_ms - guard_ms) / entry.interval_ms + 1 : 1;
+      uint32_t closes_in = intervals * entry.interval_ms + guard_ms - elapsed_ms;
+      if (closes_in <= 2 * guard_ms) {
+        window_open = true;
+        if (closes_in < open_closes_in) {
+          open_closes_in = closes_in;
+          open_mode = entry.mode;
+        }
+      } else if (closes_in - 2 * guard_ms < next_opens_in) {
+        next_opens_in = closes_in - 2 * guard_ms;
+        next_mode = entry.mode;
+      }
+    }
+
+    RadioMode mode;
+    if (window_open) {
+      mode = open_mode;
+    } else if (unlearned[0] && unlearned[1]) {
+      // Discovery in both modes: alternate slices of jittered length
+      if (now - this->slice_started_ms_ >= this->slice_ms_) {
+        mode = current == RadioMode::C1 ? RadioMode::T1 : RadioMode::C1;
+      } else {
+        mode = current;
+      }
+    } else if (unlearned[0] || unlearned[1]) {
+      mode = unlearned[0] ? RadioMode::C1 : RadioMode::T1;
+    } else {
+      mode = next_mode;
+    }
+
+    if (mode != current) {
+      this->switches_++;
+      this->slice_started_ms_ = now;
+      this->slice_ms_ = SCHEDULER_DWELL_MS + this->next_jitter_ms_();
+    }
+    return mode;
+  }
+
+  /**
+   * @brief Account the time since the last call to the given mode
+   *
+   * @param now Current time in milliseconds
+   * @param mode Mode the radio was in
+   */
+  void account(uint32_t now, RadioMode mode) {
+    if (this->accounted_ms_ != 0) {
+      this->time_in_mode_ms_[static_cast<uint8_t>(mode)] += now - this->accounted_ms_;
+    }
+    this->accounted_ms_ = now;
+  }
+
+  /**
+   * @brief Share of the time spent in a mode
+   *
+   * @return Percent (0 before any time was accounted)
+   */
+  float get_time_share(RadioMode mode) const {
+    uint64_t total_ms = this->time_in_mode_ms_[0] + this->time_in_mode_ms_[1];
+    if (total_ms == 0) {
+      return 0.0f;
+    }
+    return 100.0f * this->time_in_mode_ms_[static_cast<uint8_t>(mode)] / total_ms;
+  }
+
+  /**
+   * @brief Telegrams captured over telegrams expected, for a mode's meters
+   *
+   * Only meters with a learned interval count. A transmission is expected
+   * once its window has closed.
+   *
+   * @param mode Mode to report
+   * @param now Current time in milliseconds
+   * @return Percent, or a negative value if no meter of the mode has been learned
+   */
+  float get_capture_rate(RadioMode mode, uint32_t now) const {
+    uint32_t captured = 0;
+    uint32_t expected = 0;
+    for (const ScheduleEntry &entry : this->entries_) {
+      if (entry.mode != mode || entry.interval_ms == 0) {
+        continue;
+      }
+      uint32_t guard_ms = guard_ms_(entry);
+      uint32_t span_ms = entry.last_seen_ms - entry.first_seen_ms;
+      uint32_t sent = (span_ms + entry.interval_ms / 2) / entry.interval_ms + 1;
+      uint32_t quiet_ms = now - entry.last_seen_ms;
+      if (quiet_ms > guard_ms) {
+        sent += (quiet_ms - guard_ms) / entry.interval_ms;
+      }
+      expected += sent;
+      captured += entry.captures < sent ? entry.captures : sent;
+    }
+    if (expected == 0) {
+      return -1.0f;
+    }
+    return 100.0f * captured / expected;
+  }
+
+  /**
+   * @brief Configured meters of a mode
+   */
+  size_t meter_count(RadioMode mode) const {
+    size_t count = 0;
+    for (const ScheduleEntry &entry : this->entries_) {
+      count += entry.mode == mode ? 1 : 0;
+    }
+    return count;
+  }
+
+  uint32_t get_switch_count() const { return this->switches_; }
+
+  /**
+   * @brief Captures ignored as repeated copies (same access number or too close)
+   */
+  uint32_t get_ignored_count() const { return this->ignored_; }
+
+ protected:
+  static uint32_t guard_ms_(const ScheduleEntry &entry) {
+    uint32_t guard_ms = entry.interval_ms / SCHEDULER_GUARD_DIVISOR;
+    return guard_ms < SCHEDULER_MIN_GUARD_MS ? SCHEDULER_MIN_GUARD_MS : guard_ms;
+  }
+
+  uint32_t next_jitter_ms_() {
+    // LCG (Numerical Recipes); only has to break lock-step with the meters
+    this->jitter_state_ = this->jitter_state_ * 1664525u + 1013904223u;
+    return (this->jitter_state_ >> 16) % SCHEDULER_DWELL_JITTER_MS;
+  }
+
+  ScheduleEntry entries_[METER_COUNT]{};
+  uint64_t time_in_mode_ms_[RADIO_MODE_COUNT]{};
+  uint32_t accounted_ms_{0};
+  uint32_t slice_started_ms_{0};
+  uint32_t slice_ms_{SCHEDULER_DWELL_MS};
+  uint32_t jitter_state_{1};
+  uint32_t switches_{0};
+  uint32_t ignored_{0};
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
@@ -1,24 +1,34 @@
 #pragma once
 
 #include "wmbus_types.h"
-#include "esphome/core/log.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
 
 namespace esphome {
 namespace multical21_wmbus {
 
 /**
- * @brief Thread-safe ring buffer for ISR-to-loop packet passing
+ * @brief Lock-free single-producer/single-consumer ring for packet passing
  *
- * This template class provides a fixed-size ring buffer optimized for
- * interrupt service routine (ISR) to loop() communication. It uses volatile
- * members to ensure correct operation across ISR/main code boundaries.
+ * This template class provides a fixed-size ring buffer for handing packets
+ * from an interrupt service routine (ISR), a second core, or the FIFO reader
+ * to loop(). Indices are free-running atomics: the producer publishes a slot
+ * with a release store of the write index and the consumer observes it with
+ * an acquire load, so slot contents are always visible before the index.
  *
- * @tparam SIZE Number of packet slots in the ring buffer (default: 4)
+ * Slots can be used in place: the producer fills the slot returned by
+ * reserve() and publishes it with commit(); the consumer reads the slot from
+ * peek() and frees it with release(). push()/pop() are copying wrappers.
+ *
+ * @tparam SIZE Number of packet slots, a power of two (default: 4). All SIZE
+ *              slots are usable.
  *
  * Thread Safety:
- * - push() is ISR-safe and can be called from interrupt context
- * - pop() should only be called from loop() context
- * - No mutual exclusion needed due to single-producer, single-consumer design
+ * - push()/reserve()/commit() may only be called by the single producer
+ *   (ISR, other core, or loop())
+ * - pop()/peek()/release() may only be called by the single consumer
+ * - Telemetry getters may be called from anywhere
  *
  * Usage Example:
  * @code
@@ -29,7 +39,7 @@ namespace multical21_wmbus {
  * // ... fill pkt.data, pkt.length, pkt.timestamp ...
  * pkt.valid = true;
  * if (!buffer.push(pkt)) {
- *   // Buffer full - packet dropped
+ *   // Buffer full - packet dropped (counted in get_drop_count())
  * }
  *
  * // In loop():
@@ -37,86 +47,152 @@ namespace multical21_wmbus {
  * while (buffer.pop(pkt)) {
  *   // Process pkt
  * }
+ *
+ * // Zero-copy producer / consumer:
+ * if (PacketBuffer *slot = buffer.reserve()) {
+ *   // ... fill slot->data ...
+ *   buffer.commit(length, millis());
+ * }
+ * while (const PacketBuffer *slot = buffer.peek()) {
+ *   // Process slot in place
+ *   buffer.release();
+ * }
  * @endcode
  */
 template<size_t SIZE = PACKET_RING_SIZE>
 class WMBusPacketBuffer {
+  static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "Packet ring size must be a power of two");
+
  public:
   /**
    * @brief Construct a new packet buffer
    */
-  WMBusPacketBuffer() : read_idx_(0), write_idx_(0) {
+  WMBusPacketBuffer() {
     // Initialize all packets as invalid
     for (size_t i = 0; i < SIZE; i++) {
       ring_[i].valid = false;
       ring_[i].length = 0;
       ring_[i].timestamp = 0;
+      ring_[i].rssi_dbm = 0;
+      ring_[i].lqi = 0;
+      ring_[i].radio_crc_ok = false;
+      ring_[i].verdict = DecodeVerdict::NONE;
+    }
+  }
+
+  /**
+   * @brief Get the next free slot for in-place filling (producer)
+   *
+   * The slot stays private to the producer until commit(). Every nullptr
+   * return is counted as a dropped packet.
+   *
+   * @return Pointer to the free slot, or nullptr if buffer is full
+   */
+  PacketBuffer *reserve() {
+    uint32_t write_idx = write_idx_.load(std::memory_order_relaxed);
+    if (write_idx - read_idx_.load(std::memory_order_acquire) >= SIZE) {
+      drops_.store(drops_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return nullptr;  // Buffer full
+    }
+    return &ring_[write_idx & MASK];
+  }
+
+  /**
+   * @brief Publish the slot obtained from reserve() (producer)
+   *
+   * @param length Number of valid bytes in the slot's data
+   * @param timestamp Reception time in milliseconds
+   */
+  void commit(uint16_t length, uint32_t timestamp) {
+    uint32_t write_idx = write_idx_.load(std::memory_order_relaxed);
+    PacketBuffer &slot = ring_[write_idx & MASK];
+    slot.length = length;
+    slot.timestamp = timestamp;
+    slot.valid = true;
+
+    // Release: slot contents become visible before the new index
+    write_idx_.store(write_idx + 1, std::memory_order_release);
+
+    size_t depth = write_idx + 1 - read_idx_.load(std::memory_order_relaxed);
+    if (depth > high_water_.load(std::memory_order_relaxed)) {
+      high_water_.store(depth, std::memory_order_relaxed);
     }
   }
 
   /**
-   * @brief Add a packet to the ring buffer (ISR-safe)
+   * @brief Add a packet to the ring buffer (producer)
    *
    * @param packet The packet to add
    * @return true if packet was added successfully
    * @return false if buffer is full (packet dropped)
    */
   bool push(const PacketBuffer &packet) {
-    uint8_t write_idx = write_idx_;
-    uint8_t next_write = (write_idx + 1) % SIZE;
-
-    // Check if buffer is full
-    if (next_write == read_idx_) {
+    PacketBuffer *slot = this->reserve();
+    if (slot == nullptr) {
       return false;  // Buffer full - packet dropped
     }
 
-    // Copy packet data
-    volatile PacketBuffer *buf = &ring_[write_idx];
-    memcpy((void*)buf->data, packet.data, packet.length);
-    buf->length = packet.length;
-    buf->timestamp = packet.timestamp;
-    buf->valid = packet.valid;
+    memcpy(slot->data, packet.data, packet.length);
+    slot->rssi_dbm = packet.rssi_dbm;
+    slot->lqi = packet.lqi;
+    slot->radio_crc_ok = packet.radio_crc_ok;
+    slot->verdict = packet.verdict;
+    this->commit(packet.length, packet.timestamp);
+    return true;
+  }
 
-    // Advance write pointer (atomic operation on single byte)
-    write_idx_ = next_write;
+  /**
+   * @brief Get the oldest packet for in-place reading (consumer)
+   *
+   * The slot stays valid until release().
+   *
+   * @return Pointer to the packet, or nullptr if buffer is empty
+   */
+  const PacketBuffer *peek() const {
+    uint32_t read_idx = read_idx_.load(std::memory_order_relaxed);
+    // Acquire: pairs with the release in commit()
+    if (read_idx == write_idx_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &ring_[read_idx & MASK];
+  }
 
-    return true;
+  /**
+   * @brief Free the slot returned by peek() (consumer)
+   */
+  void release() {
+    uint32_t read_idx = read_idx_.load(std::memory_order_relaxed);
+
+    // Mark as consumed
+    ring_[read_idx & MASK].valid = false;
+
+    // Release: the producer may reuse the slot only after we are done with it
+    read_idx_.store(read_idx + 1, std::memory_order_release);
   }
 
   /**
-   * @brief Remove and return a packet from the ring buffer
+   * @brief Remove and return a packet from the ring buffer (consumer)
    *
    * @param packet Output parameter to receive the packet
    * @return true if a packet was retrieved
    * @return false if buffer is empty
    */
   bool pop(PacketBuffer &packet) {
-    // Check if buffer is empty
-    if (read_idx_ == write_idx_) {
-      return false;
-    }
-
-    uint8_t read_idx = read_idx_;
-    volatile PacketBuffer *pbuf = &ring_[read_idx];
-
-    // Skip invalid packets
-    if (!pbuf->valid) {
-      read_idx_ = (read_idx + 1) % SIZE;
+    const PacketBuffer *slot = this->peek();
+    if (slot == nullptr) {
       return false;
     }
 
-    // Copy to non-volatile buffer
-    memcpy(packet.data, (const uint8_t*)pbuf->data, pbuf->length);
-    packet.length = pbuf->length;
-    packet.timestamp = pbuf->timestamp;
-    packet.valid = pbuf->valid;
-
-    // Mark as consumed
-    pbuf->valid = false;
-
-    // Advance read pointer
-    read_idx_ = (read_idx + 1) % SIZE;
+    memcpy(packet.data, slot->data, slot->length);
+    packet.length = slot->length;
+    packet.timestamp = slot->timestamp;
+    packet.rssi_dbm = slot->rssi_dbm;
+    packet.lqi = slot->lqi;
+    packet.radio_crc_ok = slot->radio_crc_ok;
+    packet.verdict = slot->verdict;
+    packet.valid = slot->valid;
 
+    this->release();
     return true;
   }
 
@@ -127,7 +203,7 @@ class WMBusPacketBuffer {
    * @return false if buffer contains packets
    */
   bool is_empty() const {
-    return read_idx_ == write_idx_;
+    return this->size() == 0;
   }
 
   /**
@@ -137,19 +213,19 @@ class WMBusPacketBuffer {
    * @return false if buffer has space
    */
   bool is_full() const {
-    uint8_t next_write = (write_idx_ + 1) % SIZE;
-    return next_write == read_idx_;
+    return this->size() >= SIZE;
   }
 
   /**
    * @brief Clear all packets from the buffer
+   *
+   * Only safe while the producer is quiescent.
    */
   void clear() {
     for (size_t i = 0; i < SIZE; i++) {
       ring_[i].valid = false;
     }
-    read_idx_ = 0;
-    write_idx_ = 0;
+    read_idx_.store(write_idx_.load(std::memory_order_acquire), std::memory_order_release);
   }
 
   /**
@@ -158,11 +234,7 @@ class WMBusPacketBuffer {
    * @return size_t Number of packets
    */
   size_t size() const {
-    if (write_idx_ >= read_idx_) {
-      return write_idx_ - read_idx_;
-    } else {
-      return SIZE - read_idx_ + write_idx_;
-    }
+    return write_idx_.load(std::memory_order_acquire) - read_idx_.load(std::memory_order_acquire);
   }
 
   /**
@@ -174,10 +246,24 @@ class WMBusPacketBuffer {
     return SIZE;
   }
 
+  /**
+   * @brief Highest depth observed since boot
+   */
+  size_t get_high_water_mark() const { return high_water_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Packets dropped because the ring was full
+   */
+  uint32_t get_drop_count() const { return drops_.load(std::memory_order_relaxed); }
+
  private:
-  volatile PacketBuffer ring_[SIZE];  // Ring buffer storage
-  volatile uint8_t read_idx_;         // Read index (consumer)
-  volatile uint8_t write_idx_;        // Write index (producer)
+  static constexpr uint32_t MASK = SIZE - 1;
+
+  PacketBuffer ring_[SIZE];                   // Ring buffer storage (ownership follows indices)
+  std::atomic<uint32_t> read_idx_{0};         // Free-running read index (consumer)
+  std::atomic<uint32_t> write_idx_{0};        // Free-running write index (producer)
+  std::atomic<size_t> high_water_{0};         // Max depth (producer writes)
+  std::atomic<uint32_t> drops_{0};            // Full-ring drops (producer writes)
 };
 
 }  // namespace multical21_wmbus
@@ -1,6 +1,7 @@
 #include "wmbus_packet_parser.h"
-#include "esphome/core/log.h"
+#include "wmbus_log.h"
 #include <cstdio>
+#include <cstring>
 
 namespace esphome {
 namespace multical21_wmbus {
@@ -16,25 +17,30 @@ bool WMBusPacketParser::is_long_frame_(const uint8_t *plaintext) {
   return (plaintext[2] == 0x78);
 }
 
-std::string WMBusPacketParser::decode_status_(uint8_t info_codes) {
+const char *WMBusPacketParser::format_status(uint8_t info_codes, char *buf) {
+  const char *name;
   switch (info_codes) {
     case 0x00:
-      return "normal";
+      name = "normal";
+      break;
     case 0x01:
-      return "dry";
+      name = "dry";
+      break;
     case 0x02:
-      return "reverse";
+      name = "reverse";
+      break;
     case 0x04:
-      return "leak";
+      name = "leak";
+      break;
     case 0x08:
-      return "burst";
+      name = "burst";
+      break;
     default:
-      {
-        char buf[16];
-        snprintf(buf, sizeof(buf), "code_0x%02x", info_codes);
-        return std::string(buf);
-      }
+      snprintf(buf, STATUS_STRING_SIZE, "code_0x%02x", info_codes);
+      return buf;
   }
+  strncpy(buf, name, STATUS_STRING_SIZE);
+  return buf;
 }
 
 // ============================================================================
@@ -56,7 +62,7 @@ WMBusMeterData WMBusPacketParser::parse(const uint8_t *plaintext, uint8_t length
 
   // Detect frame type (compact vs long)
   bool is_long = this->is_long_frame_(plaintext);
-  data.frame_type = is_long ? "long" : "compact";
+  data.frame_type = is_long ? FrameType::LONG : FrameType::COMPACT;
   data.frame_marker = (length >= 3) ? plaintext[2] : 0x00;
 
   // Define field positions based on frame type
@@ -78,9 +84,10 @@ WMBusMeterData WMBusPacketParser::parse(const uint8_t *plaintext, uint8_t length
     pos_ambient_temp = 18;
   }
 
-  ESP_LOGI(TAG, ">>> Frame Type: %s (marker=0x%02X, length=%u bytes) <<<",
-           data.frame_type.c_str(), data.frame_marker, length);
+  WMBUS_HOT_LOGI(TAG, ">>> Frame Type: %s (marker=0x%02X, length=%u bytes) <<<",
+           frame_type_to_string(data.frame_type), data.frame_marker, length);
 
+#ifndef MULTICAL21_WMBUS_QUIET_LOGGING
   // Log first 30 bytes of plaintext in hex for analysis
   if (length > 0) {
     char hex_buf[100];
@@ -90,12 +97,13 @@ WMBusMeterData WMBusPacketParser::parse(const uint8_t *plaintext, uint8_t length
     }
     ESP_LOGD(TAG, "Plaintext hex: %s%s", hex_buf, (length > 30) ? "..." : "");
   }
+#endif
 
   // Extract meter status / info codes
   if (length > pos_info_codes) {
-    uint8_t info_codes = plaintext[pos_info_codes];
-    data.status = this->decode_status_(info_codes);
-    ESP_LOGD(TAG, "  Status: %s (0x%02X)", data.status.c_str(), info_codes);
+    data.info_codes = plaintext[pos_info_codes];
+    data.has_info_codes = true;
+    WMBUS_HOT_LOGD(TAG, "  Status: 0x%02X", data.info_codes);
   }
 
   // Extract total water consumption (4 bytes, little-endian, in liters)
@@ -105,7 +113,7 @@ WMBusMeterData WMBusPacketParser::parse(const uint8_t *plaintext, uint8_t length
                             (plaintext[pos_total + 2] << 16) |
                             (plaintext[pos_total + 3] << 24);
     data.total_consumption_m3 = total_liters / 1000.0f;
-    ESP_LOGD(TAG, "  Total consumption: %.3f m3", data.total_consumption_m3);
+    WMBUS_HOT_LOGD(TAG, "  Total consumption: %.3f m3", data.total_consumption_m3);
   }
 
   // Extract target water consumption (4 bytes, little-endian, in liters)
@@ -115,25 +123,25 @@ WMBusMeterData WMBusPacketParser::parse(const uint8_t *plaintext, uint8_t length
                              (plaintext[pos_target + 2] << 16) |
                              (plaintext[pos_target + 3] << 24);
     data.target_consumption_m3 = target_liters / 1000.0f;
-    ESP_LOGD(TAG, "  Target consumption: %.3f m3", data.target_consumption_m3);
+    WMBUS_HOT_LOGD(TAG, "  Target consumption: %.3f m3", data.target_consumption_m3);
   }
 
   // Extract flow temperature (signed byte, degrees Celsius)
   if (length > pos_flow_temp) {
     data.flow_temperature_c = static_cast<int8_t>(plaintext[pos_flow_temp]);
-    ESP_LOGD(TAG, "  Flow temperature: %d °C", data.flow_temperature_c);
+    WMBUS_HOT_LOGD(TAG, "  Flow temperature: %d °C", data.flow_temperature_c);
   }
 
   // Extract ambient temperature (signed byte, degrees Celsius)
   if (length > pos_ambient_temp) {
     data.ambient_temperature_c = static_cast<int8_t>(plaintext[pos_ambient_temp]);
-    ESP_LOGD(TAG, "  Ambient temperature: %d °C", data.ambient_temperature_c);
+    WMBUS_HOT_LOGD(TAG, "  Ambient temperature: %d °C", data.ambient_temperature_c);
   }
 
   // Mark as valid if we successfully parsed
   data.valid = true;
-  ESP_LOGI(TAG, "Parsing complete: %.3f m3, status=%s, flow=%d°C, ambient=%d°C",
-           data.total_consumption_m3, data.status.c_str(),
+  WMBUS_HOT_LOGI(TAG, "Parsing complete: %.3f m3, status=0x%02X, flow=%d°C, ambient=%d°C",
+           data.total_consumption_m3, data.info_codes,
            data.flow_temperature_c, data.ambient_temperature_c);
 
   return data;
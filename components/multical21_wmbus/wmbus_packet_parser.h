@@ -1,8 +1,8 @@
 #pragma once
 
 #include "wmbus_types.h"
+#include <cstddef>
 #include <cstdint>
-#include <string>
 
 namespace esphome {
 namespace multical21_wmbus {
@@ -11,18 +11,20 @@ namespace multical21_wmbus {
  * @brief Parsed meter data structure
  *
  * Data Transfer Object (DTO) holding all meter readings extracted
- * from a decrypted wMBUS packet.
+ * from a decrypted wMBUS packet. Holds no heap memory; strings are only
+ * produced at the sensor boundary.
  */
 struct WMBusMeterData {
   float total_consumption_m3;    // Total water consumption in cubic meters
   float target_consumption_m3;   // Target/billing consumption in cubic meters
   int8_t flow_temperature_c;     // Flow temperature in degrees Celsius
   int8_t ambient_temperature_c;  // Ambient temperature in degrees Celsius
-  std::string status;            // Human-readable meter status (e.g., "normal", "leak")
+  uint8_t info_codes;            // Raw meter status byte (see format_status())
+  bool has_info_codes;           // False if the frame was too short to carry info codes
   bool valid;                    // True if parsing succeeded, false on error
 
   // Frame analysis fields
-  std::string frame_type;        // "compact" or "long" - for debugging/analysis
+  FrameType frame_type;          // Compact or long - for debugging/analysis
   uint8_t plaintext_length;      // Length of decrypted plaintext in bytes
   uint8_t frame_marker;          // Byte 2 of plaintext (0x78 = long, other = compact)
 
@@ -32,9 +34,10 @@ struct WMBusMeterData {
     target_consumption_m3(0.0f),
     flow_temperature_c(0),
     ambient_temperature_c(0),
-    status("unknown"),
+    info_codes(0x00),
+    has_info_codes(false),
     valid(false),
-    frame_type("unknown"),
+    frame_type(FrameType::UNKNOWN),
     plaintext_length(0),
     frame_marker(0x00) {}
 };
@@ -62,6 +65,22 @@ class WMBusPacketParser {
    */
   WMBusMeterData parse(const uint8_t *plaintext, uint8_t length);
 
+  /// Buffer size needed by format_status() ("code_0xXX" + NUL fits)
+  static constexpr size_t STATUS_STRING_SIZE = 16;
+
+  /**
+   * @brief Decode meter status code to human-readable string
+   *
+   * Maps info code byte to descriptive status strings:
+   * 0x00 = "normal", 0x01 = "dry", 0x02 = "reverse", etc.
+   * Writes into the caller's buffer so no heap memory is used.
+   *
+   * @param info_codes Raw status byte from meter
+   * @param buf Output buffer, at least STATUS_STRING_SIZE bytes
+   * @return buf, holding e.g. "normal", "leak", "code_0x05"
+   */
+  static const char *format_status(uint8_t info_codes, char *buf);
+
  private:
   /**
    * @brief Detect if plaintext is a long frame format
@@ -72,17 +91,6 @@ class WMBusPacketParser {
    * @return true if long frame (0x78 marker), false if compact frame
    */
   bool is_long_frame_(const uint8_t *plaintext);
-
-  /**
-   * @brief Decode meter status code to human-readable string
-   *
-   * Maps info code byte to descriptive status strings:
-   * 0x00 = "normal", 0x01 = "dry", 0x02 = "reverse", etc.
-   *
-   * @param info_codes Raw status byte from meter
-   * @return Status string (e.g., "normal", "leak", "code_0x05")
-   */
-  std::string decode_status_(uint8_t info_codes);
 };
 
 }  // namespace multical21_wmbus
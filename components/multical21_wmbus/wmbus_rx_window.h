@@ -0,0 +1,216 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include "wmbus_meter_table.h"
+#include "wmbus_mode_scheduler.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief Window state of one configured meter
+ */
+struct RxWindowEntry {
+  uint32_t expected_ms;  // Capture time expected for the meter's next telegram
+  uint32_t guard_ms;     // Window half-width (0: not yet armed)
+  uint32_t captures;     // ScheduleEntry::captures already seen
+  uint8_t misses_in_row;
+};
+
+/**
+ * @brief Predictive RX windows between which the radio is powered down
+ *
+ * Uses the transmit intervals WMBusModeScheduler learns from captures
+ * (corrected for missed telegrams). After every capture the meter's next
+ * telegram is expected one interval later, and the radio only has to
+ * listen from guard before until guard after it. Capture times are taken
+ * once the telegram has been read, so windows are judged
+ * RX_WINDOW_SETTLE_MS late.
+ *
+ * The guard starts at the configured value (at most interval /
+ * RX_WINDOW_MAX_GUARD_DIVISOR). A window that closes without
+ * the meter's telegram doubles it (at most interval /
+ * RX_WINDOW_MAX_GUARD_DIVISOR); a telegram caught in its window takes
+ * 1/RX_WINDOW_SHRINK_DIVISOR of the excess back off, but not below twice
+ * the timing error just seen. Meters without a learned
+ * interval, and meters missed RX_WINDOW_RELEARN_MISSES times in a row, keep
+ * the radio listening until they are heard again.
+ *
+ * A meter that starts sending twice as often still hits every window, so
+ * every RX_WINDOW_SURVEY_INTERVAL_MS the radio listens for twice the
+ * longest interval plus its guard and the scheduler sees the shorter gaps
+ * (it takes two in a row before it drops the old interval).
+ *
+ * Thread Safety: not thread-safe; use from loop() only.
+ */
+class WMBusRxWindow {
+ public:
+  void set_guard_ms(uint32_t guard_ms) { this->guard_ms_ = guard_ms; }
+  uint32_t get_guard_ms() const { return this->guard_ms_; }
+
+  /**
+   * @brief Follow the windows and tell how long the radio may stay off
+   *
+   * Counts a hit for every capture inside its window and a miss for every
+   * window that closed without one.
+   *
+   * @param schedule Learned intervals and captures
+   * @param now Current time in milliseconds
+   * @return Milliseconds until the next window opens (0: the radio must listen now)
+   */
+  uint32_t update(const WMBusModeScheduler &schedule, uint32_t now) {
+    uint32_t opens_in = UINT32_MAX;
+    uint32_t longest_ms = 0;
+    for (size_t i = 0; i < METER_COUNT; i++) {
+      const ScheduleEntry &entry = schedule.get_entry(i);
+      RxWindowEntry &window = this->windows_[i];
+      if (entry.captures != window.captures) {
+        this->record_capture_(window, entry);
+      }
+      if (window.guard_ms == 0 || window.misses_in_row >= RX_WINDOW_RELEARN_MISSES) {
+        opens_in = 0;  // Interval not learned yet, or no longer trusted
+        continue;
+      }
+
+      // Window closed without the telegram: the next one is an interval later
+      while (static_cast<int32_t>(now - (window.expected_ms + window.guard_ms + RX_WINDOW_SETTLE_MS)) > 0) {
+        this->misses_++;
+        window.misses_in_row++;
+        uint32_t max_guard_ms = entry.interval_ms / RX_WINDOW_MAX_GUARD_DIVISOR;
+        window.guard_ms = window.guard_ms * 2 < max_guard_ms ? window.guard_ms * 2 : max_guard_ms;
+        window.expected_ms += entry.interval_ms;
+        if (window.misses_in_row >= RX_WINDOW_RELEARN_MISSES) {
+          break;
+        }
+      }
+      if (window.misses_in_row >= RX_WINDOW_RELEARN_MISSES) {
+        opens_in = 0;
+        continue;
+      }
+
+      uint32_t survey_ms = 2 * entry.interval_ms + window.guard_ms;
+      longest_ms = survey_ms > longest_ms ? survey_ms : longest_ms;
+      uint32_t opens_ms = window.expected_ms - window.guard_ms;
+      if (static_cast<int32_t>(opens_ms - now) <= 0) {
+        opens_in = 0;
+      } else if (opens_ms - now < opens_in) {
+        opens_in = opens_ms - now;
+      }
+    }
+
+    // Survey: a meter that started sending more often still hits every
+    // window, so now and then listen for two whole intervals
+    if (opens_in != 0 && now - this->survey_started_ms_ >= RX_WINDOW_SURVEY_INTERVAL_MS) {
+      this->survey_started_ms_ = now;
+      this->survey_ms_ = longest_ms;
+      this->surveys_++;
+    }
+    if (now - this->survey_started_ms_ < this->survey_ms_) {
+      return 0;
+    }
+    return opens_in;
+  }
+
+  /**
+   * @brief Account the time since the last call as listening or off
+   *
+   * @param now Current time in milliseconds
+   * @param listening Whether the radio was powered up
+   */
+  void account(uint32_t now, bool listening) {
+    if (this->accounted_ms_ != 0) {
+      uint32_t elapsed_ms = now - this->accounted_ms_;
+      this->total_ms_ += elapsed_ms;
+      this->listening_ms_ += listening ? elapsed_ms : 0;
+    }
+    this->accounted_ms_ = now;
+  }
+
+  /**
+   * @brief Share of the time the radio was powered up
+   *
+   * @return Percent (100 before any time was accounted)
+   */
+  float get_duty_cycle() const {
+    if (this->total_ms_ == 0) {
+      return 100.0f;
+    }
+    return 100.0f * this->listening_ms_ / this->total_ms_;
+  }
+
+  /**
+   * @brief Windows that caught their telegram, in percent of all judged windows
+   *
+   * @return Percent, or a negative value before the first window was judged
+   */
+  float get_hit_rate() const {
+    if (this->hits_ + this->misses_ == 0) {
+      return -1.0f;
+    }
+    return 100.0f * this->hits_ / (this->hits_ + this->misses_);
+  }
+
+  uint32_t get_hits() const { return this->hits_; }
+  uint32_t get_misses() const { return this->misses_; }
+  uint32_t get_survey_count() const { return this->surveys_; }
+
+  /**
+   * @brief Widest current guard of any armed window (0 if none is armed)
+   */
+  uint32_t get_widest_guard_ms() const {
+    uint32_t widest_ms = 0;
+    for (const RxWindowEntry &window : this->windows_) {
+      widest_ms = window.guard_ms > widest_ms ? window.guard_ms : widest_ms;
+    }
+    return widest_ms;
+  }
+
+ protected:
+  void record_capture_(RxWindowEntry &window, const ScheduleEntry &entry) {
+    window.captures = entry.captures;
+    if (entry.interval_ms == 0) {
+      return;  // Second capture arms the window
+    }
+
+    // The configured guard, within the same limit a miss widens it to
+    uint32_t max_guard_ms = entry.interval_ms / RX_WINDOW_MAX_GUARD_DIVISOR;
+    uint32_t base_guard_ms = this->guard_ms_ < max_guard_ms ? this->guard_ms_ : max_guard_ms;
+    if (window.guard_ms == 0) {
+      window.guard_ms = base_guard_ms;
+    } else {
+      // Only a telegram inside its window counts; captures while the radio
+      // listens for other reasons (relearning, another meter) do not
+      int32_t error_ms = static_cast<int32_t>(entry.last_seen_ms - window.expected_ms);
+      if (error_ms >= -static_cast<int32_t>(window.guard_ms) &&
+          error_ms <= static_cast<int32_t>(window.guard_ms + RX_WINDOW_SETTLE_MS)) {
+        this->hits_++;
+        uint32_t abs_error_ms = error_ms < 0 ? -error_ms : error_ms;
+        // Rounded up, so the last RX_WINDOW_SHRINK_DIVISOR ms of excess go too
+        uint32_t excess_ms = window.guard_ms > base_guard_ms ? window.guard_ms - base_guard_ms : 0;
+        uint32_t guard_ms = window.guard_ms - (excess_ms + RX_WINDOW_SHRINK_DIVISOR - 1) / RX_WINDOW_SHRINK_DIVISOR;
+        if (guard_ms < 2 * abs_error_ms) {
+          guard_ms = 2 * abs_error_ms < window.guard_ms ? 2 * abs_error_ms : window.guard_ms;
+        }
+        window.guard_ms = guard_ms;
+      }
+    }
+    window.misses_in_row = 0;
+    window.expected_ms = entry.last_seen_ms + entry.interval_ms;
+  }
+
+  RxWindowEntry windows_[METER_COUNT]{};
+  uint32_t guard_ms_{500};
+  uint32_t hits_{0};
+  uint32_t misses_{0};
+  uint64_t listening_ms_{0};
+  uint64_t total_ms_{0};
+  uint32_t accounted_ms_{0};
+  uint32_t survey_started_ms_{0};
+  uint32_t survey_ms_{0};
+  uint32_t surveys_{0};
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
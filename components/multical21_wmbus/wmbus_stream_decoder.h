@@ -0,0 +1,122 @@
+#pragma once
+
+#include "wmbus_crypto.h"
+#include "wmbus_types.h"
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief Decodes a telegram chunk by chunk while it is read from the FIFO
+ *
+ * Each chunk is folded into the running CRC and, once the meter's key is
+ * known, its ciphertext bytes are decrypted in place right after the CRC
+ * has seen them. When the last byte has been fed, the CRC verdict and the
+ * plaintext are ready; nothing is left for the processing step but parsing.
+ *
+ * Buffer layout is the packet slot's: [L][C][M M][A A A A]...[cipher]...[CRC CRC].
+ *
+ * Thread Safety: not thread-safe; use from loop() only.
+ */
+class WMBusStreamDecoder {
+ public:
+  /**
+   * @brief Start a telegram whose L-field is at packet[0]
+   */
+  void begin(const uint8_t *packet) {
+    this->length_ = packet[0];
+    this->crc_ = WMBusCrypto::crc_update(WMBusCrypto::CRC_INIT, packet, 1);
+    this->position_ = 1;
+    this->crypto_ = nullptr;
+    this->stream_started_ = false;
+    this->stream_ok_ = true;
+    this->active_ = true;
+  }
+
+  /**
+   * @brief Drop the current telegram (e.g. bad L-field)
+   */
+  void reset() { this->active_ = false; }
+
+  bool is_active() const { return this->active_; }
+
+  /**
+   * @brief Index of the next byte to be fed
+   */
+  uint16_t get_position() const { return this->position_; }
+
+  /**
+   * @brief Decrypt with this meter's key from here on
+   *
+   * Must be set before the first ciphertext byte is fed; left unset, only
+   * the CRC is checked.
+   */
+  void set_crypto(WMBusCrypto *crypto) { this->crypto_ = crypto; }
+
+  /**
+   * @brief Fold the next count bytes (at packet[get_position()]) into the decode
+   */
+  void feed(uint8_t *packet, uint8_t count) {
+    uint16_t start = this->position_;
+    uint16_t end = start + count;
+    this->position_ = end;
+
+    // CRC covers everything before the two CRC bytes at L-1 and L
+    uint16_t crc_offset = this->length_ - 1;
+    uint16_t crc_end = end < crc_offset ? end : crc_offset;
+    if (start < crc_end) {
+      this->crc_ = WMBusCrypto::crc_update(this->crc_, &packet[start], crc_end - start);
+    }
+
+    if (this->crypto_ == nullptr || !this->stream_ok_) {
+      return;
+    }
+    uint16_t from = start > OFFSET_CIPHER_START ? start : OFFSET_CIPHER_START;
+    if (from >= crc_end) {
+      return;
+    }
+    if (!this->stream_started_) {
+      this->stream_started_ = true;
+      this->stream_ok_ = this->crypto_->begin_stream(packet, crc_offset - OFFSET_CIPHER_START);
+    }
+    if (this->stream_ok_) {
+      this->stream_ok_ = this->crypto_->stream_decrypt(&packet[from], &packet[from], crc_end - from);
+    }
+  }
+
+  /**
+   * @brief Verdict once the whole telegram has been fed
+   *
+   * @param packet The fed buffer, for the transmitted CRC
+   * @return NONE if the telegram was not (completely) fed
+   */
+  DecodeVerdict finish(const uint8_t *packet) {
+    if (!this->active_ || this->position_ < this->length_ + 1) {
+      this->active_ = false;
+      return DecodeVerdict::NONE;
+    }
+    this->active_ = false;
+    uint16_t packet_crc = (packet[this->length_ - 1] << 8) | packet[this->length_];
+    if (WMBusCrypto::crc_finalize(this->crc_) != packet_crc) {
+      return DecodeVerdict::CRC_FAILED;
+    }
+    // Only a payload decrypted to the last byte counts
+    if (this->crypto_ != nullptr && this->stream_started_ && this->stream_ok_) {
+      return DecodeVerdict::DECRYPTED;
+    }
+    return DecodeVerdict::CRC_OK;
+  }
+
+ protected:
+  WMBusCrypto *crypto_{nullptr};
+  uint16_t crc_{WMBusCrypto::CRC_INIT};
+  uint8_t length_{0};
+  uint16_t position_{0};  // Reaches 256 after a 255-byte telegram
+  bool stream_started_{false};
+  bool stream_ok_{true};
+  bool active_{false};
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
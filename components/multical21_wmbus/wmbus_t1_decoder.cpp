@@ -0,0 +1,103 @@
+#include "wmbus_t1_decoder.h"
+#include "wmbus_crypto.h"
+#include <array>
+#include <cstring>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+// ============================================================================
+// 3-out-of-6 Symbol Table
+// ============================================================================
+
+// Symbol for each nibble, EN 13757-4 table 10
+static constexpr uint8_t SYMBOLS[16] = {
+    0x16, 0x0D, 0x0E, 0x0B, 0x1C, 0x19, 0x1A, 0x13,  // 0-7
+    0x2C, 0x25, 0x26, 0x23, 0x34, 0x31, 0x32, 0x29,  // 8-F
+};
+
+// Entries with this bit set are chip patterns that are not a symbol pair
+static constexpr uint16_t INVALID_SYMBOL = 0x100;
+
+// 12 chips (high symbol, low symbol) -> byte. Generated at compile time;
+// 8 KB of flash, and only 256 of the 4096 entries are valid.
+static constexpr std::array<uint16_t, 4096> make_decode_table() {
+  std::array<uint16_t, 4096> table{};
+  for (auto &entry : table) {
+    entry = INVALID_SYMBOL;
+  }
+  for (uint16_t high = 0; high < 16; high++) {
+    for (uint16_t low = 0; low < 16; low++) {
+      table[(SYMBOLS[high] << 6) | SYMBOLS[low]] = static_cast<uint16_t>((high << 4) | low);
+    }
+  }
+  return table;
+}
+
+static constexpr std::array<uint16_t, 4096> DECODE_TABLE = make_decode_table();
+
+// ============================================================================
+// Public Interface
+// ============================================================================
+
+bool WMBusT1Decoder::decode(const uint8_t *raw, uint8_t *out, uint16_t count) {
+  // Byte pairs: 3 FIFO bytes hold two 12-chip symbol pairs
+  uint16_t i = 0;
+  for (; i + 1 < count; i += 2, raw += 3) {
+    uint32_t chips = (static_cast<uint32_t>(raw[0]) << 16) | (raw[1] << 8) | raw[2];
+    uint16_t high = DECODE_TABLE[chips >> 12];
+    uint16_t low = DECODE_TABLE[chips & 0xFFF];
+    if ((high | low) & INVALID_SYMBOL) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>(high);
+    out[i + 1] = static_cast<uint8_t>(low);
+  }
+
+  // Odd count: the last byte is the first 12 chips of a pair
+  if (i < count) {
+    uint16_t last = DECODE_TABLE[(raw[0] << 4) | (raw[1] >> 4)];
+    if (last & INVALID_SYMBOL) {
+      return false;
+    }
+    out[i] = static_cast<uint8_t>(last);
+  }
+  return true;
+}
+
+bool WMBusT1Decoder::check_frame_a(const uint8_t *frame, uint8_t *packet, uint16_t packet_size) {
+  uint8_t length = frame[0];
+  if (length < FIRST_BLOCK_SIZE - 1 || length + 1 + CRC_SIZE > packet_size ||
+      length + CRC_SIZE > UINT8_MAX) {
+    return false;
+  }
+
+  // Data bytes (L included) are copied without their block CRCs
+  uint16_t data_left = length + 1;
+  uint16_t block_size = FIRST_BLOCK_SIZE;
+  uint8_t *out = packet;
+  while (data_left > 0) {
+    if (block_size > data_left) {
+      block_size = data_left;
+    }
+    uint16_t crc = WMBusCrypto::calculate_crc(frame, block_size);
+    if (crc != ((frame[block_size] << 8) | frame[block_size + 1])) {
+      return false;
+    }
+    memcpy(out, frame, block_size);
+    out += block_size;
+    frame += block_size + CRC_SIZE;
+    data_left -= block_size;
+    block_size = BLOCK_SIZE;
+  }
+
+  // One CRC over the whole telegram, counted in the L-field, as in Mode C1
+  packet[0] = length + CRC_SIZE;
+  uint16_t crc = WMBusCrypto::calculate_crc(packet, length + 1);
+  packet[length + 1] = static_cast<uint8_t>(crc >> 8);
+  packet[length + 2] = static_cast<uint8_t>(crc);
+  return true;
+}
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
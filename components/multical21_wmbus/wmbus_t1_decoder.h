@@ -0,0 +1,76 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief Mode T1 telegram decoder: 3-out-of-6 symbols and Frame Format A
+ *
+ * T1 meters send every data nibble as a 6-chip symbol with exactly three
+ * ones (EN 13757-4 table 10), most significant nibble first, so one byte is
+ * 12 chips and two bytes are 3 bytes on air. A 4096-entry table maps each
+ * 12-chip symbol pair to its byte (or to "invalid"), so a byte costs one
+ * lookup and three FIFO bytes decode with two.
+ *
+ * T1 telegrams always use Frame Format A: the L-field counts data bytes
+ * only, and a CRC follows the first block (L, C, M, A: 10 bytes) and every
+ * further block of up to 16 bytes. check_frame_a() verifies every block and
+ * re-packs the telegram into the packet slot layout used for Mode C1
+ * ([L][C]...[CRC CRC], one CRC over the whole telegram), so everything
+ * downstream of the FIFO read is shared between the modes.
+ *
+ * Stateless; all methods are static.
+ */
+class WMBusT1Decoder {
+ public:
+  /// Data bytes in the first Frame Format A block (L, C, M, A)
+  static constexpr uint8_t FIRST_BLOCK_SIZE = 10;
+  /// Data bytes in every further block (the last one may be shorter)
+  static constexpr uint8_t BLOCK_SIZE = 16;
+
+  /**
+   * @brief FIFO bytes carrying a number of decoded bytes
+   */
+  static constexpr uint16_t encoded_size(uint16_t decoded) { return (decoded * 3 + 1) / 2; }
+
+  /**
+   * @brief Decoded size of a Frame Format A telegram, block CRCs included
+   *
+   * @param l_field L-field (data bytes after it, CRCs not counted)
+   */
+  static constexpr uint16_t frame_size(uint8_t l_field) {
+    // First block CRC, plus one per started block after it (signed: L < 9 adds none)
+    return l_field + 1 + CRC_SIZE * (1 + (l_field - (FIRST_BLOCK_SIZE - 1) + BLOCK_SIZE - 1) / BLOCK_SIZE);
+  }
+
+  /**
+   * @brief Decode 3-out-of-6 chips
+   *
+   * @param raw FIFO bytes, at least encoded_size(count)
+   * @param out Receives count decoded bytes
+   * @param count Bytes to decode
+   * @return false on the first chip pattern that is not a valid symbol
+   */
+  static bool decode(const uint8_t *raw, uint8_t *out, uint16_t count);
+
+  /**
+   * @brief Verify the block CRCs of a Frame Format A telegram and re-pack it
+   *
+   * @param frame Decoded telegram, frame_size(frame[0]) bytes
+   * @param packet Receives [L+2][C]...[CRC CRC], the Mode C1 slot layout
+   * @param packet_size Size of packet; L+3 bytes are written
+   * @return false if a block CRC is wrong or the telegram does not fit
+   */
+  static bool check_frame_a(const uint8_t *frame, uint8_t *packet, uint16_t packet_size);
+};
+
+/// FIFO bytes of the longest T1 telegram that fits a packet slot once re-packed
+constexpr uint16_t T1_MAX_ENCODED_SIZE =
+    WMBusT1Decoder::encoded_size(WMBusT1Decoder::frame_size(MAX_PACKET_SIZE - CRC_SIZE));
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
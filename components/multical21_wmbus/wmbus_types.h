@@ -1,7 +1,10 @@
 #pragma once
 
+// YAML overrides (MULTICAL21_WMBUS_*); absent in the off-device build
+#if __has_include("esphome/core/defines.h")
+#include "esphome/core/defines.h"
+#endif
 #include <cstdint>
-#include <string>
 #include <vector>
 
 namespace esphome {
@@ -14,6 +17,8 @@ namespace multical21_wmbus {
 constexpr uint8_t CC1101_IOCFG2 = 0x00;
 constexpr uint8_t CC1101_IOCFG0 = 0x02;
 constexpr uint8_t CC1101_FIFOTHR = 0x03;
+constexpr uint8_t CC1101_PKTLEN = 0x06;
+constexpr uint8_t CC1101_PKTCTRL1 = 0x07;
 constexpr uint8_t CC1101_PKTCTRL0 = 0x08;
 constexpr uint8_t CC1101_FREQ2 = 0x0D;
 constexpr uint8_t CC1101_FREQ1 = 0x0E;
@@ -24,6 +29,13 @@ constexpr uint8_t CC1101_MDMCFG2 = 0x12;
 constexpr uint8_t CC1101_DEVIATN = 0x15;
 constexpr uint8_t CC1101_MCSM1 = 0x17;
 constexpr uint8_t CC1101_MCSM0 = 0x18;
+constexpr uint8_t CC1101_FSCAL3 = 0x23;
+constexpr uint8_t CC1101_FSCAL2 = 0x24;
+constexpr uint8_t CC1101_FSCAL1 = 0x25;
+constexpr uint8_t CC1101_TEST2 = 0x2C;  // TEST2..TEST0 are lost in SLEEP
+
+// Configuration registers 0x00-0x2E, written and verified as one burst
+constexpr uint8_t CC1101_CONFIG_REGISTER_COUNT = 0x2F;
 
 // ============================================================================
 // CC1101 Command Strobes
@@ -33,6 +45,7 @@ constexpr uint8_t CC1101_SRES = 0x30;   // Reset chip
 constexpr uint8_t CC1101_SCAL = 0x33;   // Calibrate frequency synthesizer
 constexpr uint8_t CC1101_SRX = 0x34;    // Enable RX
 constexpr uint8_t CC1101_SIDLE = 0x36;  // Exit RX/TX
+constexpr uint8_t CC1101_SPWD = 0x39;   // Power down (SLEEP) once CSn goes high
 constexpr uint8_t CC1101_SFRX = 0x3A;   // Flush RX FIFO
 constexpr uint8_t CC1101_SFTX = 0x3B;   // Flush TX FIFO
 constexpr uint8_t CC1101_RXFIFO = 0x3F; // RX FIFO access
@@ -41,6 +54,7 @@ constexpr uint8_t CC1101_RXFIFO = 0x3F; // RX FIFO access
 // CC1101 Status Registers
 // ============================================================================
 
+constexpr uint8_t CC1101_LQI = 0x33;        // Link quality and CRC_OK
 constexpr uint8_t CC1101_MARCSTATE = 0x35;  // Main radio control state
 constexpr uint8_t CC1101_RSSI = 0x34;       // RSSI value
 constexpr uint8_t CC1101_RXBYTES = 0x3B;    // RX FIFO bytes
@@ -68,17 +82,123 @@ constexpr uint8_t CC1101_READ_BURST = 0xC0;
 // wMBUS Packet Constants
 // ============================================================================
 
+// Longest telegram kept (L-field value); FIFO streaming (gdo2_pin) raises it to 255
+#ifdef MULTICAL21_WMBUS_MAX_PACKET_SIZE
+constexpr uint8_t MAX_PACKET_SIZE = MULTICAL21_WMBUS_MAX_PACKET_SIZE;
+#else
 constexpr uint8_t MAX_PACKET_SIZE = 64;
+#endif
 constexpr uint8_t HEADER_SIZE = 16;
 constexpr uint8_t CRC_SIZE = 2;
 constexpr uint16_t CRC_POLY = 0x3D65;
+constexpr uint8_t CC1101_FIFO_SIZE = 64;
+
+// ============================================================================
+// Received Signal Status
+// ============================================================================
+
+// RSSI byte + LQI byte, appended to the FIFO (PKTCTRL1.APPEND_STATUS) or read
+// from the RSSI/LQI status registers
+constexpr uint8_t RX_STATUS_SIZE = 2;
+constexpr uint8_t LQI_CRC_OK = 0x80;      // Chip CRC result (set while the chip CRC is disabled)
+constexpr uint8_t LQI_VALUE_MASK = 0x7F;  // Link quality, lower is better
+// Signal status not measured during the telegram (default reception mode)
+constexpr int16_t RSSI_UNKNOWN_DBM = INT16_MIN;
+constexpr uint8_t LQI_UNKNOWN = 0xFF;
+
+// ============================================================================
+// Continuous RX Mode
+// ============================================================================
+
+// Fixed packet length: 2 preamble + L-field + L bytes. With the two appended
+// status bytes a frame is as large as the FIFO, so it is drained from the
+// FIFOTHR threshold on rather than once it has ended.
+constexpr uint8_t CONTINUOUS_RX_FRAME_SIZE = CC1101_FIFO_SIZE - RX_STATUS_SIZE;
+constexpr uint8_t CONTINUOUS_RX_FRAME_BYTES = CONTINUOUS_RX_FRAME_SIZE + RX_STATUS_SIZE;  // In the FIFO
+constexpr uint8_t CONTINUOUS_RX_MAX_L_FIELD = CONTINUOUS_RX_FRAME_SIZE - 3;
+// GDO0 asserts (low, so the FALLING edge interrupt fires) when the RX FIFO
+// reaches the FIFOTHR threshold or the packet ends; it deasserts only once
+// the FIFO is empty
+constexpr uint8_t IOCFG0_RX_THRESHOLD_OR_END_INVERTED = 0x41;
+constexpr uint32_t C1_BYTE_US = 80;  // Air time of one byte at the 100 kbps C1 data rate
+constexpr uint8_t PKTCTRL0_FIXED_LENGTH = 0x00;
+constexpr uint8_t PKTCTRL1_APPEND_STATUS = 0x04;  // RSSI and LQI/CRC_OK follow each frame
+constexpr uint8_t MCSM1_RXOFF_STAY_IN_RX = 0x0C;  // RXOFF_MODE=11, TXOFF_MODE=IDLE
+constexpr uint8_t MCSM0_FS_AUTOCAL_MASK = 0x30;   // FS_AUTOCAL bits; 00 = never auto-calibrate
+
+// ============================================================================
+// FIFO Streaming (long telegrams)
+// ============================================================================
+
+// GDO2 asserts while the RX FIFO holds at least the FIFOTHR threshold; each
+// rising edge wakes loop() to drain the FIFO while the telegram still arrives
+constexpr uint8_t IOCFG2_RX_FIFO_THRESHOLD = 0x00;
+constexpr uint8_t FIFOTHR_RX_32_BYTES = 0x07;  // Half the FIFO: 2.56 ms of headroom at 100 kbps
+constexpr uint8_t PKTCTRL0_LENGTH_CONFIG_MASK = 0x03;
+constexpr uint8_t STREAM_HEADER_BYTES = 3;       // C1: 2 bytes after the sync word + L-field; T1: L and C coded
+constexpr uint16_t MAX_FIXED_PACKET_LENGTH = 255;  // Longest PKTLEN; longer stays in infinite mode
+
+// ============================================================================
+// Radio Modes
+// ============================================================================
+
+// Mode T1 (EN 13757-4): 868.3 MHz at 100 kcps +-12 %, 3-out-of-6 coded. Chip
+// rate, deviation and the 0x543D sync word are those of C1, and BSCFG already
+// tracks +-12.5 % rate offset, so only the carrier moves.
+constexpr uint8_t T1_FREQ2 = 0x21;
+constexpr uint8_t T1_FREQ1 = 0x65;
+constexpr uint8_t T1_FREQ0 = 0x6A;  // 868.3 MHz
+
+// ============================================================================
+// Mode Scheduler (mode: c1_t1)
+// ============================================================================
+
+constexpr uint32_t MODE_SCHEDULE_INTERVAL_MS = 100;  // Scheduler tick
+constexpr uint32_t SCHEDULER_GUARD_DIVISOR = 16;     // Window +-interval/16 around an expected telegram
+constexpr uint32_t SCHEDULER_MIN_GUARD_MS = 500;
+constexpr uint32_t SCHEDULER_DWELL_MS = 2000;        // Discovery slice per mode, plus jitter
+constexpr uint32_t SCHEDULER_DWELL_JITTER_MS = 1000;
+constexpr uint32_t SCHEDULER_MIN_GAP_MS = 1000;      // Closer captures are repeated copies, not a new interval
+
+// ============================================================================
+// RX Windowing (rx_windowing: true)
+// ============================================================================
+
+constexpr uint32_t RX_WINDOW_MAX_GUARD_DIVISOR = 4;  // Guard never exceeds interval/4
+constexpr uint32_t RX_WINDOW_SHRINK_DIVISOR = 32;    // A hit narrows the guard by 1/32 towards the configured one
+constexpr uint8_t RX_WINDOW_RELEARN_MISSES = 4;      // Misses in a row before listening until the meter is heard
+constexpr uint32_t RX_WINDOW_SETTLE_MS = 100;        // Capture time lags the telegram by its airtime and the read
+constexpr uint32_t RX_WINDOW_WAKE_LEAD_MS = 20;      // Radio wake-up and loop() latency ahead of a window
+constexpr uint32_t RX_WINDOW_MIN_OFF_MS = 100;       // Shorter gaps are not worth a power-down
+constexpr uint32_t RX_WINDOW_SURVEY_INTERVAL_MS = 3600000;  // Listen through two whole intervals every hour
+constexpr uint32_t RADIO_WAKE_SETTLE_US = 500;       // Crystal start-up after CSn wakes the chip
+constexpr uint32_t LIGHT_SLEEP_MIN_MS = 50;          // Shorter gaps are not worth a light sleep
+constexpr uint32_t LIGHT_SLEEP_MAX_MS = 1000;        // Other components still get a loop() every second
 
 // ============================================================================
 // Timeout Constants
 // ============================================================================
 
-constexpr uint32_t RECEIVE_TIMEOUT_MS = 300000;  // 5 minutes
-constexpr uint32_t HEALTH_CHECK_INTERVAL_MS = 10000;  // 10 seconds
+constexpr uint32_t RECEIVE_TIMEOUT_MS = 300000;  // 5 minutes; longest silence before recovery
+constexpr uint32_t HEALTH_CHECK_INTERVAL_MS = 10000;  // 10 seconds; supervision tick
+constexpr uint32_t REGISTER_CHECK_INTERVAL_MS = 60000;  // Register profile hash check (one burst read)
+constexpr uint32_t RADIO_STATE_TIMEOUT_MS = 100;     // Max wait for a MARCSTATE transition
+constexpr uint32_t RADIO_RESET_SETTLE_MS = 10;       // Chip settle time after SRES
+constexpr uint32_t RADIO_RESET_POLL_US = 20;         // Retry interval of the GDO config rewrite after SRES
+constexpr uint8_t RADIO_RESET_POLL_LIMIT = 50;       // Rewrite attempts (1 ms) before configure_() takes over
+constexpr uint8_t RADIO_IDLE_POLL_LIMIT = 16;        // MARCSTATE polls in enter_idle()
+
+// ============================================================================
+// Radio Supervision
+// ============================================================================
+
+constexpr uint8_t WATCHDOG_SILENCE_FACTOR = 3;  // Quiet for 3 meter intervals before probing
+constexpr uint8_t WATCHDOG_RECOVER_FACTOR = 4;  // Quiet for 4 silence windows before recovery
+constexpr uint8_t WATCHDOG_MAX_BACKOFF = 3;     // Fruitless recoveries: wait up to 8x longer
+constexpr uint32_t WATCHDOG_MIN_SILENCE_MS = HEALTH_CHECK_INTERVAL_MS;
+// Silence window until an interval is learned; also the upper bound, so
+// recovery never waits longer than RECEIVE_TIMEOUT_MS
+constexpr uint32_t WATCHDOG_DEFAULT_SILENCE_MS = RECEIVE_TIMEOUT_MS / WATCHDOG_RECOVER_FACTOR;
 
 // ============================================================================
 // wMBUS Packet Size Constraints
@@ -96,25 +216,119 @@ constexpr uint8_t INVALID_LENGTH_MARKER = 255;
 constexpr uint8_t OFFSET_C_FIELD = 1;
 constexpr uint8_t OFFSET_M_FIELD = 2;
 constexpr uint8_t OFFSET_METER_ID = 4;
+constexpr uint8_t OFFSET_VERSION = 8;
+constexpr uint8_t OFFSET_DEVICE_TYPE = 9;
+constexpr uint8_t OFFSET_ACCESS_NUMBER = 13;
 constexpr uint8_t OFFSET_CIPHER_START = 17;
 
+// Bytes after the L-field needed to see the A-field: C(1) + M(2) + A(4)
+constexpr uint8_t EARLY_REJECT_READ_BYTES = OFFSET_METER_ID + 4 - 1;
+
+// Bytes after the L-field needed for a census entry: C, M, A, version, device type
+constexpr uint8_t CENSUS_READ_BYTES = OFFSET_DEVICE_TYPE;
+
 // ============================================================================
 // Packet Ring Buffer Configuration
 // ============================================================================
 
-constexpr uint8_t PACKET_RING_SIZE = 4;  // Handle burst of 4 packets
+constexpr uint8_t PACKET_RING_SIZE = 4;  // Default: handle burst of 4 packets (power of two)
+
+// ============================================================================
+// Keystream Prediction Configuration
+// ============================================================================
+
+// Longest ciphertext a MAX_PACKET_SIZE telegram can carry (L-field minus header and CRC)
+constexpr uint8_t MAX_CIPHER_SIZE = MAX_PACKET_SIZE - OFFSET_CIPHER_START - CRC_SIZE + 1;
+// Keystream bytes kept per slot. Multical21 frames carry 19 (compact) or 26
+// (long) bytes of ciphertext; longer telegrams take the normal CTR path, so
+// a larger MAX_PACKET_SIZE does not grow every meter's slots.
+constexpr uint8_t KEYSTREAM_MAX_SIZE = MAX_CIPHER_SIZE < 32 ? MAX_CIPHER_SIZE : 32;
+constexpr uint8_t KEYSTREAM_SLOTS = 2;  // Predicted access numbers kept (next, and one missed)
+
+// ============================================================================
+// Meter Census Configuration
+// ============================================================================
+
+constexpr uint16_t CENSUS_SIZE = 64;  // Default table slots (power of two)
+
+// ============================================================================
+// Pipelined Decode Configuration
+// ============================================================================
+
+constexpr uint8_t STREAM_DECODE_CHUNK = 16;  // FIFO bytes per burst, one AES block
 
 // ============================================================================
 // Shared Data Structures
 // ============================================================================
 
+/**
+ * @brief Multical21 frame format, detected from the plaintext marker byte
+ */
+enum class FrameType : uint8_t {
+  UNKNOWN,
+  COMPACT,
+  LONG,
+};
+
+/**
+ * @brief Frame type name for logging and text output
+ */
+inline const char *frame_type_to_string(FrameType frame_type) {
+  switch (frame_type) {
+    case FrameType::COMPACT:
+      return "compact";
+    case FrameType::LONG:
+      return "long";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief wM-Bus mode the radio listens in
+ */
+enum class RadioMode : uint8_t {
+  C1,  // 868.95 MHz, NRZ, Frame Format B (Multical21 default)
+  T1,  // 868.3 MHz, 3-out-of-6, Frame Format A
+};
+
+constexpr uint8_t RADIO_MODE_COUNT = 2;
+
+/**
+ * @brief Mode name for logging
+ */
+inline const char *radio_mode_to_string(RadioMode mode) {
+  switch (mode) {
+    case RadioMode::C1:
+      return "C1";
+    case RadioMode::T1:
+      return "T1";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief How far a telegram was decoded while it was read from the FIFO
+ */
+enum class DecodeVerdict : uint8_t {
+  NONE,        // Not decoded during the read; CRC and decryption still to do
+  CRC_FAILED,
+  CRC_OK,      // CRC checked, payload still encrypted (not our meter, or no key)
+  DECRYPTED,   // CRC checked and payload decrypted in place
+};
+
 /**
  * @brief Packet buffer structure for ISR-to-loop communication
  */
 struct PacketBuffer {
   uint8_t data[MAX_PACKET_SIZE + 1];  // L-field + payload
-  uint8_t length;
+  uint16_t length;
   uint32_t timestamp;
+  int16_t rssi_dbm;  // Signal strength of this telegram (RSSI_UNKNOWN_DBM: not measured)
+  uint8_t lqi;       // Link quality indicator, lower is better (LQI_UNKNOWN: not measured)
+  bool radio_crc_ok;  // CRC_OK status bit from the radio
+  DecodeVerdict verdict;  // Work already done by the pipelined decoder
   bool valid;
 };
 
@@ -130,7 +344,7 @@ struct MeterStats {
   // Frame type analysis
   uint32_t compact_frame_count;
   uint32_t long_frame_count;
-  std::string last_frame_type;  // "compact" or "long"
+  FrameType last_frame_type;
 };
 
 }  // namespace multical21_wmbus
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include <cstdint>
+
+namespace esphome {
+namespace multical21_wmbus {
+
+/**
+ * @brief What the supervision tick should do about the radio
+ */
+enum class WatchdogAction : uint8_t {
+  NONE,     // Telegrams are flowing; no SPI traffic needed
+  PROBE,    // Stream went quiet: check MARCSTATE/RXBYTES over SPI
+  RECOVER,  // Quiet for much longer than expected: full reset and reconfigure
+};
+
+/**
+ * @brief Packet-stream watchdog for the radio
+ *
+ * Every telegram read from the radio feeds the watchdog. The radio is only
+ * probed over SPI once the stream has been quiet for longer than the
+ * expected silence window, learned from the configured meters' transmit
+ * intervals, and then at most once per window. A full recovery follows if
+ * the silence lasts WATCHDOG_RECOVER_FACTOR windows. Each recovery that
+ * brings no telegram doubles the wait before the next one (up to
+ * WATCHDOG_MAX_BACKOFF doublings), so a meter that has gone away for good
+ * does not keep the radio in a reset loop.
+ *
+ * The watchdog also counts the supervision ticks it skipped, i.e. the
+ * status reads a fixed-interval health check would have made.
+ *
+ * Thread Safety: not thread-safe; use from loop() only.
+ */
+class WMBusWatchdog {
+ public:
+  /// Status reads per probe (MARCSTATE, RXBYTES, RSSI)
+  static constexpr uint8_t SPI_TRANSACTIONS_PER_PROBE = 3;
+
+  /**
+   * @brief Start supervising
+   *
+   * @param now Current time in milliseconds
+   */
+  void start(uint32_t now) {
+    this->started_ms_ = now;
+    this->last_feed_ms_ = now;
+    this->last_probe_ms_ = now;
+  }
+
+  /**
+   * @brief A telegram was read from the radio
+   *
+   * @param now Current time in milliseconds
+   */
+  void feed(uint32_t now) {
+    this->last_feed_ms_ = now;
+    this->last_probe_ms_ = now;
+    this->backoff_ = 0;
+  }
+
+  /**
+   * @brief Set the expected silence window from a learned transmit interval
+   *
+   * @param interval_ms Shortest average interval of the configured meters,
+   *                    or 0 while none has been learned
+   */
+  void set_expected_interval(uint32_t interval_ms) {
+    if (interval_ms == 0) {
+      this->silence_window_ms_ = WATCHDOG_DEFAULT_SILENCE_MS;
+      return;
+    }
+    uint32_t window_ms = interval_ms * WATCHDOG_SILENCE_FACTOR;
+    if (window_ms < WATCHDOG_MIN_SILENCE_MS) {
+      window_ms = WATCHDOG_MIN_SILENCE_MS;
+    } else if (window_ms > WATCHDOG_DEFAULT_SILENCE_MS) {
+      window_ms = WATCHDOG_DEFAULT_SILENCE_MS;
+    }
+    this->silence_window_ms_ = window_ms;
+  }
+
+  /**
+   * @brief Decide what to do on a supervision tick
+   *
+   * @param now Current time in milliseconds
+   * @return NONE while telegrams arrive within the silence window
+   */
+  WatchdogAction check(uint32_t now) {
+    uint32_t quiet_ms = now - this->last_feed_ms_;
+    if (quiet_ms >= (this->silence_window_ms_ * WATCHDOG_RECOVER_FACTOR) << this->backoff_) {
+      this->recoveries_++;
+      if (this->backoff_ < WATCHDOG_MAX_BACKOFF) {
+        this->backoff_++;
+      }
+      // Give the fresh configuration a full window before probing again
+      this->last_feed_ms_ = now;
+      this->last_probe_ms_ = now;
+      return WatchdogAction::RECOVER;
+    }
+    if (now - this->last_probe_ms_ >= this->silence_window_ms_) {
+      this->probes_++;
+      this->last_probe_ms_ = now;
+      return WatchdogAction::PROBE;
+    }
+    this->skipped_probes_++;
+    return WatchdogAction::NONE;
+  }
+
+  uint32_t get_silence_window_ms() const { return this->silence_window_ms_; }
+  uint32_t get_quiet_ms(uint32_t now) const { return now - this->last_feed_ms_; }
+  uint32_t get_probe_count() const { return this->probes_; }
+  uint32_t get_recovery_count() const { return this->recoveries_; }
+
+  /**
+   * @brief Recoveries in a row that brought no telegram back (saturates)
+   */
+  uint8_t get_consecutive_recoveries() const { return this->backoff_; }
+
+  /**
+   * @brief SPI transactions not spent on status reads since start()
+   */
+  uint32_t get_spi_transactions_saved() const { return this->skipped_probes_ * SPI_TRANSACTIONS_PER_PROBE; }
+
+  /**
+   * @brief SPI transactions saved per hour of uptime
+   *
+   * @param now Current time in milliseconds
+   */
+  float get_spi_transactions_saved_per_hour(uint32_t now) const {
+    uint32_t uptime_ms = now - this->started_ms_;
+    if (uptime_ms == 0) {
+      return 0.0f;
+    }
+    return this->get_spi_transactions_saved() * 3600000.0f / uptime_ms;
+  }
+
+ protected:
+  uint32_t started_ms_{0};
+  uint32_t last_feed_ms_{0};
+  uint32_t last_probe_ms_{0};
+  uint32_t silence_window_ms_{WATCHDOG_DEFAULT_SILENCE_MS};
+  uint32_t probes_{0};
+  uint32_t recoveries_{0};
+  uint32_t skipped_probes_{0};
+  uint8_t backoff_{0};  // Recoveries in a row without a telegram
+};
+
+}  // namespace multical21_wmbus
+}  // namespace esphome
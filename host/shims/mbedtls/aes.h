@@ -0,0 +1,22 @@
+#pragma once
+
+// Minimal stand-in for mbedTLS's AES API, used by the host build when the
+// real library is not installed. Covers only what WMBusCrypto calls:
+// AES-128 encryption key schedule and CTR mode.
+
+#include <cstddef>
+#include <cstdint>
+
+#define MBEDTLS_ERR_AES_INVALID_KEY_LENGTH -0x0020
+#define MBEDTLS_ERR_AES_BAD_INPUT_DATA -0x0021
+
+struct mbedtls_aes_context {
+  uint8_t round_keys[176];  // AES-128: 11 round keys
+  bool key_set;
+};
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx);
+void mbedtls_aes_free(mbedtls_aes_context *ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off, unsigned char nonce_counter[16],
+                          unsigned char stream_block[16], const unsigned char *input, unsigned char *output);
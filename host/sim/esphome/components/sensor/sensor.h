@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    if (this->callback_) {
+      this->callback_(state);
+    }
+  }
+
+  /// Called with every published state; one callback per sensor is enough here
+  void add_on_state_callback(std::function<void(float)> &&callback) { this->callback_ = std::move(callback); }
+
+  bool has_state() const { return this->has_state_; }
+
+  float state{NAN};
+
+ protected:
+  std::function<void(float)> callback_;
+  bool has_state_{false};
+};
+
+}  // namespace sensor
+}  // namespace esphome
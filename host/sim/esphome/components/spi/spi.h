@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace wmbus_host {
+
+// SPI bus of the host simulation (sim_platform.cpp): every byte takes its
+// clock time on the virtual clock on its way to the simulated device
+void sim_spi_select();
+void sim_spi_deselect();
+void sim_spi_write(uint8_t data, uint32_t byte_ns);
+uint8_t sim_spi_read(uint32_t byte_ns);
+
+}  // namespace wmbus_host
+
+namespace esphome {
+namespace spi {
+
+enum BitOrder { BIT_ORDER_LSB_FIRST, BIT_ORDER_MSB_FIRST };
+enum ClockPolarity { CLOCK_POLARITY_LOW, CLOCK_POLARITY_HIGH };
+enum ClockPhase { CLOCK_PHASE_LEADING, CLOCK_PHASE_TRAILING };
+enum DataRate : uint32_t { DATA_RATE_1MHZ = 1000000, DATA_RATE_4MHZ = 4000000, DATA_RATE_8MHZ = 8000000 };
+
+template<BitOrder BIT_ORDER, ClockPolarity CLOCK_POLARITY, ClockPhase CLOCK_PHASE, DataRate DATA_RATE>
+class SPIDevice {
+ public:
+  static constexpr uint32_t BYTE_NS = 8000000000ull / DATA_RATE;
+
+  void spi_setup() {}
+  void enable() { wmbus_host::sim_spi_select(); }
+  void disable() { wmbus_host::sim_spi_deselect(); }
+  uint8_t read_byte() { return wmbus_host::sim_spi_read(BYTE_NS); }
+  void write_byte(uint8_t data) { wmbus_host::sim_spi_write(data, BYTE_NS); }
+  void read_array(uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      data[i] = wmbus_host::sim_spi_read(BYTE_NS);
+    }
+  }
+  void write_array(const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      wmbus_host::sim_spi_write(data[i], BYTE_NS);
+    }
+  }
+};
+
+}  // namespace spi
+}  // namespace esphome
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor {
+ public:
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->has_state_ = true;
+    if (this->callback_) {
+      this->callback_(this->state);
+    }
+  }
+
+  void add_on_state_callback(std::function<void(const std::string &)> &&callback) {
+    this->callback_ = std::move(callback);
+  }
+
+  bool has_state() const { return this->has_state_; }
+
+  std::string state;
+
+ protected:
+  std::function<void(const std::string &)> callback_;
+  bool has_state_{false};
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
@@ -0,0 +1,4 @@
+#pragma once
+
+// Generated by ESPHome from the YAML on target; the host simulation takes
+// the component's options from compile definitions instead.
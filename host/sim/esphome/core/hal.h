@@ -0,0 +1,29 @@
+#pragma once
+
+// Arduino-style HAL of the host simulation: time is the virtual clock in
+// sim_platform.h, GPIO levels are driven by the simulated radio.
+
+#include <cstdint>
+
+#define IRAM_ATTR
+#define INPUT 0x01
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint32_t millis();
+uint32_t micros();
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalPinToInterrupt(uint8_t pin);
+int digitalRead(uint8_t pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+
+namespace esphome {
+
+uint32_t arch_get_cpu_cycle_count();
+uint32_t arch_get_cpu_freq_hz();
+
+}  // namespace esphome
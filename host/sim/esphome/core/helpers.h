@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+/**
+ * @brief Keeps the main loop spinning instead of sleeping between passes
+ *
+ * The simulated loop runs a pass every SimLoopTiming::high_frequency_pass_us
+ * while any requester is started.
+ */
+class HighFrequencyLoopRequester {
+ public:
+  void start();
+  void stop();
+  static bool is_high_frequency();
+
+ protected:
+  bool started_{false};
+};
+
+}  // namespace esphome
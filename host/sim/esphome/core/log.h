@@ -0,0 +1,43 @@
+#pragma once
+
+// ESPHome logger macros for the host simulation. Messages are counted per
+// level and printed to stderr up to the level set with sim_set_log_level().
+
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+namespace wmbus_host {
+
+enum SimLogLevel : uint8_t {
+  SIM_LOG_NONE = 0,
+  SIM_LOG_ERROR,
+  SIM_LOG_WARN,
+  SIM_LOG_INFO,
+  SIM_LOG_CONFIG,
+  SIM_LOG_DEBUG,
+  SIM_LOG_VERBOSE,
+  SIM_LOG_VERY_VERBOSE,
+  SIM_LOG_LEVEL_COUNT,
+};
+
+void sim_log(SimLogLevel level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+}  // namespace wmbus_host
+
+#define ESP_LOGE(tag, format, ...) ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGCONFIG(tag, format, ...) \
+  ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_CONFIG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+#define ESP_LOGVV(tag, format, ...) \
+  ::wmbus_host::sim_log(::wmbus_host::SIM_LOG_VERY_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#define LOG_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) { \
+    ESP_LOGCONFIG(TAG, "%s%s", prefix, type); \
+  }
+#define LOG_TEXT_SENSOR(prefix, type, obj) LOG_SENSOR(prefix, type, obj)
+
+#define YESNO(b) ((b) ? "YES" : "NO")
@@ -0,0 +1,287 @@
+#include "replay_harness.h"
+#include "alloc_counter.h"
+#include "multical21_wmbus.h"
+#include "test_telegram.h"
+#include "virtual_cc1101.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace wmbus_host {
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint8_t GDO0_PIN = 4;
+constexpr uint8_t GDO2_PIN = 5;
+constexpr uint32_t FOREIGN_METER_ID = 0x22222222;
+constexpr uint32_t BASE_LITERS = 100000;  // Telegram n reports BASE_LITERS + n
+constexpr uint64_t FIRST_TELEGRAM_NS = 1000000000ull;  // Setup and the first RX entry are long done
+constexpr uint64_t SETTLE_NS = 1000000000ull;          // Run on after the last telegram
+constexpr uint32_t UPDATE_INTERVAL_MS = 60000;
+constexpr uint64_t NOT_SEEN = UINT64_MAX;
+
+// Bytes after the sync word: the two the component reads as a preamble, then the telegram
+constexpr uint8_t AIR_HEADER[2] = {0x54, 0xCD};
+
+struct Telegram {
+  uint64_t sync_end_ns;
+  uint64_t air_end_ns;
+  uint64_t interrupt_ns;
+  uint64_t published_ns;
+  bool foreign;
+};
+
+ReplayLatency percentiles(std::vector<uint32_t> &samples) {
+  ReplayLatency latency;
+  latency.samples = static_cast<uint32_t>(samples.size());
+  if (samples.empty()) {
+    return latency;
+  }
+  std::sort(samples.begin(), samples.end());
+  // Nearest rank
+  auto rank = [&samples](uint32_t percent) { return samples[(samples.size() * percent + 99) / 100 - 1]; };
+  latency.p50_us = rank(50);
+  latency.p99_us = rank(99);
+  latency.max_us = samples.back();
+  return latency;
+}
+
+void print_latency(FILE *out, const char *name, const ReplayLatency &latency, bool last) {
+  fprintf(out, "    \"%s\": {\"samples\": %u, \"p50_us\": %u, \"p99_us\": %u, \"max_us\": %u}%s\n", name,
+          (unsigned) latency.samples, (unsigned) latency.p50_us, (unsigned) latency.p99_us,
+          (unsigned) latency.max_us, last ? "" : ",");
+}
+
+}  // namespace
+
+const char *replay_rx_path_to_string(ReplayRxPath path) {
+  switch (path) {
+    case ReplayRxPath::PACKET:
+      return "default";
+    case ReplayRxPath::CONTINUOUS_RX:
+      return "continuous_rx";
+    case ReplayRxPath::FIFO_STREAMING:
+      return "gdo2";
+    default:
+      return "unknown";
+  }
+}
+
+ReplayReport run_replay(const ReplayConfig &config) {
+  static_assert(METER_COUNT == 2, "The sim library is built for two meters");
+
+  sim_reset(config.timing);
+  SimClock &clock = sim_clock();
+  VirtualCC1101 radio(clock);
+  clock.set_source(&radio);
+  sim_attach_spi(&radio);
+
+  // Air traffic, all of it built before the run so the allocation count is the component's
+  std::vector<Telegram> telegrams;
+  telegrams.reserve(config.telegrams);
+  radio.reserve_frames(config.telegrams);
+  uint8_t access_numbers[METER_COUNT + 1] = {};
+  uint32_t own_sent = 0;
+  uint64_t previous_end_ns = 0;
+  uint32_t burst_size = config.burst_size != 0 ? config.burst_size : 1;
+  for (uint32_t i = 0; i < config.telegrams; i++) {
+    bool foreign = config.foreign_every != 0 && (i + 1) % config.foreign_every == 0;
+    size_t meter = foreign ? METER_COUNT : own_sent % METER_COUNT;
+    TestReading reading;
+    reading.total_liters = BASE_LITERS + i;
+    reading.long_frame = config.long_every != 0 && (i + 1) % config.long_every == 0;
+
+    uint8_t frame[sizeof(AIR_HEADER) + MAX_PACKET_SIZE + 1];
+    memcpy(frame, AIR_HEADER, sizeof(AIR_HEADER));
+    size_t size = sizeof(AIR_HEADER) + build_telegram(&frame[sizeof(AIR_HEADER)],
+                                                      foreign ? FOREIGN_METER_ID : METER_IDS[meter],
+                                                      access_numbers[meter]++, reading);
+
+    uint64_t sync_end_ns;
+    if (i % burst_size == 0) {
+      sync_end_ns = FIRST_TELEGRAM_NS + (i / burst_size) * config.burst_interval_ms * 1000000ull;
+    } else {
+      sync_end_ns = previous_end_ns + config.burst_gap_us * 1000ull + VirtualCC1101::SYNC_ACQUIRE_NS;
+    }
+    // A burst that would start before the last one ended follows it instead
+    uint64_t earliest_ns = previous_end_ns + VirtualCC1101::SYNC_ACQUIRE_NS;
+    sync_end_ns = sync_end_ns > earliest_ns ? sync_end_ns : earliest_ns;
+    previous_end_ns = sync_end_ns + size * VirtualCC1101::BYTE_NS;
+
+    radio.transmit(sync_end_ns, frame, static_cast<uint16_t>(size), config.rssi_dbm);
+    telegrams.push_back(Telegram{sync_end_ns, previous_end_ns, NOT_SEEN, NOT_SEEN, foreign});
+    own_sent += foreign ? 0 : 1;
+  }
+
+  // Component as codegen would set it up
+  Multical21WMBusComponent component;
+  component.set_update_interval(UPDATE_INTERVAL_MS);
+  component.set_gdo0_pin(GDO0_PIN);
+  if (config.rx_path == ReplayRxPath::CONTINUOUS_RX) {
+    component.set_continuous_rx(true);
+  } else if (config.rx_path == ReplayRxPath::FIFO_STREAMING) {
+    component.set_gdo2_pin(GDO2_PIN);
+  }
+  component.set_early_reject(config.early_reject);
+  component.set_pipelined_decode(config.pipelined_decode);
+  component.set_keystream_prediction(config.keystream_prediction);
+
+  ReplayReport report;
+  WMBusMeter meter_0(METER_IDS[0]);
+  WMBusMeter meter_1(METER_IDS[1]);
+  WMBusMeter *meters[METER_COUNT] = {&meter_0, &meter_1};
+  esphome::sensor::Sensor totals[METER_COUNT];
+  const std::vector<uint8_t> key(TEST_KEY.begin(), TEST_KEY.end());
+  for (size_t m = 0; m < METER_COUNT; m++) {
+    meters[m]->set_aes_key(key);
+    meters[m]->set_total_consumption_sensor(&totals[m]);
+    totals[m].add_on_state_callback([&telegrams, &report, &clock](float m3) {
+      long index = lroundf(m3 * 1000.0f) - static_cast<long>(BASE_LITERS);
+      if (index < 0 || static_cast<size_t>(index) >= telegrams.size() || telegrams[index].foreign) {
+        report.unmatched_publishes++;
+        return;
+      }
+      if (telegrams[index].published_ns != NOT_SEEN) {
+        report.duplicate_publishes++;
+        return;
+      }
+      telegrams[index].published_ns = clock.now_ns();
+      report.published++;
+    });
+    component.add_meter(meters[m]);
+  }
+
+  // GDO pins are wired to the component's interrupt pins; the first
+  // interrupting edge while a telegram is being received starts its latency
+  radio.set_gdo_callback([&](uint8_t gdo, bool level) {
+    bool interrupts = gdo == 0 ? !level : (level && config.rx_path == ReplayRxPath::FIFO_STREAMING);
+    int32_t frame = radio.get_current_frame();
+    if (interrupts && frame >= 0 && telegrams[frame].interrupt_ns == NOT_SEEN) {
+      telegrams[frame].interrupt_ns = clock.now_ns();
+    }
+    sim_drive_pin(gdo == 0 ? GDO0_PIN : GDO2_PIN, level);
+  });
+
+  std::vector<uint32_t> interrupt_latencies;
+  std::vector<uint32_t> air_latencies;
+  interrupt_latencies.reserve(config.telegrams);
+  air_latencies.reserve(config.telegrams);
+
+  SimApplication &app = sim_app();
+  app.register_component(&component);
+  app.setup();
+  uint64_t allocations_before = allocation_count();
+  uint32_t clock_edges_before = radio.get_clock_edge_count();  // Power-on clock output until setup() reset the chip
+
+  uint64_t end_ns = previous_end_ns + SETTLE_NS;
+  if (config.upset_at_ms != 0) {
+    app.run_until(config.upset_at_ms * 1000000ull);
+    radio.upset_register(CC1101_FREQ0, radio.get_register(CC1101_FREQ0) ^ 0x01);
+  }
+  app.run_until(end_ns);
+  report.allocations = allocation_count() - allocations_before;
+
+  for (const Telegram &telegram : telegrams) {
+    if (telegram.foreign) {
+      continue;
+    }
+    if (telegram.published_ns == NOT_SEEN) {
+      report.lost++;
+      continue;
+    }
+    air_latencies.push_back(static_cast<uint32_t>((telegram.published_ns - telegram.air_end_ns) / 1000));
+    if (telegram.interrupt_ns != NOT_SEEN) {
+      interrupt_latencies.push_back(static_cast<uint32_t>((telegram.published_ns - telegram.interrupt_ns) / 1000));
+    }
+  }
+  report.telegrams_sent = own_sent;
+  report.foreign_sent = config.telegrams - own_sent;
+  report.loss_percent = own_sent != 0 ? 100.0f * report.lost / own_sent : 0.0f;
+  report.interrupt_to_publish = percentiles(interrupt_latencies);
+  report.air_end_to_publish = percentiles(air_latencies);
+  report.allocations_per_telegram = config.telegrams != 0 ? static_cast<float>(report.allocations) / config.telegrams : 0.0f;
+
+  report.syncs = radio.get_sync_count();
+  report.missed = radio.get_missed_count();
+  report.late_rx = radio.get_late_rx_count();
+  report.fifo_overflows = radio.get_overflow_count();
+  report.errata_duplicates = radio.get_errata_duplicate_count();
+  report.fifo_underflows = radio.get_fifo_underflow_count();
+  report.fifo_bytes_read = radio.get_fifo_bytes_read();
+  report.ignored_strobes = radio.get_ignored_strobe_count();
+  report.clock_edges = radio.get_clock_edge_count() - clock_edges_before;
+  report.spi_transactions = radio.get_spi_transaction_count();
+  for (WMBusMeter *meter : meters) {
+    report.keystream_hits += meter->get_crypto().get_keystream_hits();
+  }
+  report.gdo0_interrupts = sim_interrupt_count(GDO0_PIN);
+  report.gdo2_interrupts = sim_interrupt_count(GDO2_PIN);
+  report.loop_passes = app.get_loop_passes();
+  report.early_wakes = app.get_early_wakes();
+  report.warnings = sim_log_count(SIM_LOG_WARN);
+  report.errors = sim_log_count(SIM_LOG_ERROR);
+  report.simulated_ms = clock.now_ns() / 1000000;
+
+  // Nothing may call back into this frame's locals after the return
+  clock.set_source(nullptr);
+  sim_attach_spi(nullptr);
+  sim_reset(config.timing);
+  return report;
+}
+
+void print_replay_json(FILE *out, const ReplayConfig &config, const ReplayReport &report) {
+  fprintf(out, "{\n");
+  fprintf(out, "  \"config\": {\n");
+  fprintf(out, "    \"rx_path\": \"%s\",\n", replay_rx_path_to_string(config.rx_path));
+  fprintf(out, "    \"telegrams\": %u,\n", (unsigned) config.telegrams);
+  fprintf(out, "    \"burst_size\": %u,\n", (unsigned) config.burst_size);
+  fprintf(out, "    \"burst_gap_us\": %u,\n", (unsigned) config.burst_gap_us);
+  fprintf(out, "    \"burst_interval_ms\": %u,\n", (unsigned) config.burst_interval_ms);
+  fprintf(out, "    \"foreign_every\": %u,\n", (unsigned) config.foreign_every);
+  fprintf(out, "    \"long_every\": %u,\n", (unsigned) config.long_every);
+  fprintf(out, "    \"early_reject\": %s,\n", config.early_reject ? "true" : "false");
+  fprintf(out, "    \"pipelined_decode\": %s,\n", config.pipelined_decode ? "true" : "false");
+  fprintf(out, "    \"keystream_prediction\": %s,\n", config.keystream_prediction ? "true" : "false");
+  fprintf(out, "    \"wake_model\": \"%s\",\n", sim_wake_model_to_string(config.timing.wake_model));
+  fprintf(out, "    \"loop_interval_us\": %u,\n", (unsigned) config.timing.loop_interval_us);
+  fprintf(out, "    \"seed\": %u\n", (unsigned) config.timing.seed);
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"telegrams_sent\": %u,\n", (unsigned) report.telegrams_sent);
+  fprintf(out, "  \"foreign_sent\": %u,\n", (unsigned) report.foreign_sent);
+  fprintf(out, "  \"published\": %u,\n", (unsigned) report.published);
+  fprintf(out, "  \"lost\": %u,\n", (unsigned) report.lost);
+  fprintf(out, "  \"loss_percent\": %.2f,\n", report.loss_percent);
+  fprintf(out, "  \"duplicate_publishes\": %u,\n", (unsigned) report.duplicate_publishes);
+  fprintf(out, "  \"unmatched_publishes\": %u,\n", (unsigned) report.unmatched_publishes);
+  fprintf(out, "  \"keystream_hits\": %u,\n", (unsigned) report.keystream_hits);
+  fprintf(out, "  \"latency\": {\n");
+  print_latency(out, "interrupt_to_publish", report.interrupt_to_publish, false);
+  print_latency(out, "air_end_to_publish", report.air_end_to_publish, true);
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"allocations\": %llu,\n", (unsigned long long) report.allocations);
+  fprintf(out, "  \"allocations_per_telegram\": %.3f,\n", report.allocations_per_telegram);
+  fprintf(out, "  \"radio\": {\n");
+  fprintf(out, "    \"syncs\": %u,\n", (unsigned) report.syncs);
+  fprintf(out, "    \"missed\": %u,\n", (unsigned) report.missed);
+  fprintf(out, "    \"late_rx\": %u,\n", (unsigned) report.late_rx);
+  fprintf(out, "    \"fifo_overflows\": %u,\n", (unsigned) report.fifo_overflows);
+  fprintf(out, "    \"errata_duplicates\": %u,\n", (unsigned) report.errata_duplicates);
+  fprintf(out, "    \"fifo_underflows\": %u,\n", (unsigned) report.fifo_underflows);
+  fprintf(out, "    \"fifo_bytes_read\": %u,\n", (unsigned) report.fifo_bytes_read);
+  fprintf(out, "    \"ignored_strobes\": %u,\n", (unsigned) report.ignored_strobes);
+  fprintf(out, "    \"clock_edges\": %u,\n", (unsigned) report.clock_edges);
+  fprintf(out, "    \"spi_transactions\": %u\n", (unsigned) report.spi_transactions);
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"gdo0_interrupts\": %u,\n", (unsigned) report.gdo0_interrupts);
+  fprintf(out, "  \"gdo2_interrupts\": %u,\n", (unsigned) report.gdo2_interrupts);
+  fprintf(out, "  \"loop_passes\": %u,\n", (unsigned) report.loop_passes);
+  fprintf(out, "  \"early_wakes\": %u,\n", (unsigned) report.early_wakes);
+  fprintf(out, "  \"warnings\": %u,\n", (unsigned) report.warnings);
+  fprintf(out, "  \"errors\": %u,\n", (unsigned) report.errors);
+  fprintf(out, "  \"simulated_ms\": %llu\n", (unsigned long long) report.simulated_ms);
+  fprintf(out, "}\n");
+}
+
+}  // namespace wmbus_host
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "sim_platform.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace wmbus_host {
+
+/// Receive path of the component under test
+enum class ReplayRxPath : uint8_t {
+  PACKET,          // Default: GDO0 end of packet, IDLE, read, restart RX
+  CONTINUOUS_RX,   // continuous_rx: true
+  FIFO_STREAMING,  // gdo2_pin set
+};
+
+const char *replay_rx_path_to_string(ReplayRxPath path);
+
+/**
+ * @brief Traffic and component options of one replay run
+ *
+ * Telegrams go out in bursts: burst_size telegrams with burst_gap_us of
+ * silence between one telegram's last byte and the next one's preamble,
+ * a new burst every burst_interval_ms. Telegrams alternate between the two
+ * configured meters (MULTICAL21_WMBUS_METER_IDS of the sim library).
+ */
+struct ReplayConfig {
+  ReplayRxPath rx_path{ReplayRxPath::PACKET};
+  uint32_t telegrams{200};
+  uint32_t burst_size{1};
+  uint32_t burst_gap_us{2000};
+  uint32_t burst_interval_ms{1000};
+  uint32_t foreign_every{0};  // Every n-th telegram is from an unconfigured meter (0: none)
+  uint32_t long_every{8};     // Every n-th telegram is a long frame (0: compact only)
+  int16_t rssi_dbm{-70};
+  uint32_t upset_at_ms{0};    // Corrupt a radio register then, so the register check recovers (0: never)
+  bool early_reject{false};
+  bool pipelined_decode{false};
+  bool keystream_prediction{false};
+  SimLoopTiming timing;
+};
+
+/// Percentiles in microseconds
+struct ReplayLatency {
+  uint32_t samples{0};
+  uint32_t p50_us{0};
+  uint32_t p99_us{0};
+  uint32_t max_us{0};
+};
+
+struct ReplayReport {
+  uint32_t telegrams_sent{0};  // Telegrams of the configured meters
+  uint32_t foreign_sent{0};
+  uint32_t published{0};
+  uint32_t lost{0};
+  float loss_percent{0.0f};
+  uint32_t duplicate_publishes{0};
+  uint32_t unmatched_publishes{0};  // Totals that match no transmitted telegram (a bad decode)
+
+  ReplayLatency interrupt_to_publish;  // First GDO interrupt edge of the telegram to publish_state()
+  ReplayLatency air_end_to_publish;    // Telegram's last byte on the air to publish_state()
+
+  uint64_t allocations{0};  // operator new calls between setup() and the end of the run
+  float allocations_per_telegram{0.0f};
+
+  uint32_t syncs{0};
+  uint32_t missed{0};   // Telegrams on the air while the radio was not searching for a sync word
+  uint32_t late_rx{0};  // Telegrams whose sync word came before RX had settled
+  uint32_t fifo_overflows{0};
+  uint32_t errata_duplicates{0};
+  uint32_t fifo_underflows{0};
+  uint32_t fifo_bytes_read{0};
+  uint32_t ignored_strobes{0};
+  uint32_t clock_edges{0};  // Clock output edges on a GDO pin after setup()
+  uint32_t spi_transactions{0};
+  uint32_t keystream_hits{0};  // Decrypts served from a precomputed keystream, all meters
+  uint32_t gdo0_interrupts{0};
+  uint32_t gdo2_interrupts{0};
+  uint32_t loop_passes{0};
+  uint32_t early_wakes{0};
+  uint32_t warnings{0};
+  uint32_t errors{0};
+  uint64_t simulated_ms{0};
+};
+
+/**
+ * @brief Run the component against a VirtualCC1101 for one traffic pattern
+ *
+ * setup(), loop(), intervals and interrupt handlers run as on target, on
+ * the virtual clock: SPI bytes take their 4 MHz clock time, the radio
+ * receives at 100 kbps, and loop() wakes after an interrupt with the
+ * latency of the configured wake model. C1 only; T1 is not modelled.
+ */
+ReplayReport run_replay(const ReplayConfig &config);
+
+void print_replay_json(FILE *out, const ReplayConfig &config, const ReplayReport &report);
+
+}  // namespace wmbus_host
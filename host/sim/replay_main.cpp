@@ -0,0 +1,126 @@
+// wmbus_replay: run the component against the simulated CC1101 for one
+// traffic pattern and print the report as JSON.
+//
+//   wmbus_replay --rx-path continuous_rx --burst-size 4 --burst-gap-us 300
+#include "replay_harness.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace wmbus_host;
+
+namespace {
+
+void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --rx-path default|continuous_rx|gdo2   Receive path (default: default)\n"
+          "  --telegrams N                          Telegrams to send (default: 200)\n"
+          "  --burst-size N                         Telegrams per burst (default: 1)\n"
+          "  --burst-gap-us N                       Silence between telegrams of a burst (default: 2000)\n"
+          "  --burst-interval-ms N                  Time between burst starts (default: 1000)\n"
+          "  --foreign-every N                      Every N-th telegram from an unknown meter (default: 0)\n"
+          "  --long-every N                         Every N-th telegram a long frame (default: 8)\n"
+          "  --upset-at-ms N                        Corrupt a radio register at N ms (default: never)\n"
+          "  --wake fast|slow|poll                  Loop wake latency after an interrupt (default: fast)\n"
+          "  --loop-interval-us N                   Main loop interval (default: 16000)\n"
+          "  --seed N                               Wake latency seed (default: 1)\n"
+          "  --early-reject, --pipelined-decode, --keystream-prediction\n"
+          "  --log debug|info|warn                  Print the component's log to stderr\n",
+          program);
+}
+
+bool parse_rx_path(const char *value, ReplayRxPath &path) {
+  for (ReplayRxPath candidate : {ReplayRxPath::PACKET, ReplayRxPath::CONTINUOUS_RX, ReplayRxPath::FIFO_STREAMING}) {
+    if (strcmp(value, replay_rx_path_to_string(candidate)) == 0) {
+      path = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_wake_model(const char *value, SimWakeModel &model) {
+  for (SimWakeModel candidate : {SimWakeModel::FAST, SimWakeModel::SLOW, SimWakeModel::POLL}) {
+    if (strcmp(value, sim_wake_model_to_string(candidate)) == 0) {
+      model = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool parse_log_level(const char *value, SimLogLevel &level) {
+  if (strcmp(value, "debug") == 0) {
+    level = SIM_LOG_DEBUG;
+  } else if (strcmp(value, "info") == 0) {
+    level = SIM_LOG_INFO;
+  } else if (strcmp(value, "warn") == 0) {
+    level = SIM_LOG_WARN;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ReplayConfig config;
+  SimLogLevel log_level = SIM_LOG_NONE;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    bool ok = true;
+    if (strcmp(arg, "--early-reject") == 0) {
+      config.early_reject = true;
+      continue;
+    } else if (strcmp(arg, "--pipelined-decode") == 0) {
+      config.pipelined_decode = true;
+      continue;
+    } else if (strcmp(arg, "--keystream-prediction") == 0) {
+      config.keystream_prediction = true;
+      continue;
+    } else if (strcmp(arg, "--help") == 0 || value == nullptr) {
+      usage(argv[0]);
+      return strcmp(arg, "--help") == 0 ? 0 : 1;
+    } else if (strcmp(arg, "--rx-path") == 0) {
+      ok = parse_rx_path(value, config.rx_path);
+    } else if (strcmp(arg, "--wake") == 0) {
+      ok = parse_wake_model(value, config.timing.wake_model);
+    } else if (strcmp(arg, "--log") == 0) {
+      ok = parse_log_level(value, log_level);
+    } else if (strcmp(arg, "--telegrams") == 0) {
+      config.telegrams = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--burst-size") == 0) {
+      config.burst_size = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--burst-gap-us") == 0) {
+      config.burst_gap_us = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--burst-interval-ms") == 0) {
+      config.burst_interval_ms = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--foreign-every") == 0) {
+      config.foreign_every = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--long-every") == 0) {
+      config.long_every = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--upset-at-ms") == 0) {
+      config.upset_at_ms = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--loop-interval-us") == 0) {
+      config.timing.loop_interval_us = strtoul(value, nullptr, 0);
+    } else if (strcmp(arg, "--seed") == 0) {
+      config.timing.seed = strtoul(value, nullptr, 0);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, "Invalid option: %s %s\n", arg, value);
+      usage(argv[0]);
+      return 1;
+    }
+    i++;
+  }
+
+  sim_set_log_level(log_level);
+  ReplayReport report = run_replay(config);
+  print_replay_json(stdout, config, report);
+  return 0;
+}
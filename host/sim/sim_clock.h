@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+
+namespace wmbus_host {
+
+/**
+ * @brief Something that changes state at points in virtual time
+ */
+class SimEventSource {
+ public:
+  virtual ~SimEventSource() = default;
+
+  /// Time of the next event (UINT64_MAX: none)
+  virtual uint64_t next_event_ns() = 0;
+
+  /// Handle every event due at or before now_ns
+  virtual void run_events(uint64_t now_ns) = 0;
+};
+
+/**
+ * @brief Virtual time in nanoseconds
+ *
+ * Nothing happens between events: advancing the clock runs the attached
+ * source's events in order, each with the clock set to its own time, so
+ * code they call (e.g. an interrupt handler reading micros()) sees the
+ * moment the event happened.
+ */
+class SimClock {
+ public:
+  uint64_t now_ns() const { return this->now_ns_; }
+  void set_source(SimEventSource *source) { this->source_ = source; }
+
+  /// Run every event up to and including target_ns, then stop there
+  void advance_to(uint64_t target_ns) { this->wait_until(target_ns, UINT64_MAX); }
+  void advance_by(uint64_t ns) { this->advance_to(this->now_ns_ + ns); }
+
+  /**
+   * @brief Like advance_to(), but stop early once the clock reaches wake_ns
+   *
+   * wake_ns is re-read after every event, so an event may bring it forward.
+   */
+  void wait_until(uint64_t target_ns, const uint64_t &wake_ns) {
+    while (true) {
+      uint64_t stop_ns = target_ns < wake_ns ? target_ns : wake_ns;
+      if (stop_ns < this->now_ns_) {
+        return;  // Already past the wake time
+      }
+      uint64_t event_ns = this->source_ != nullptr ? this->source_->next_event_ns() : UINT64_MAX;
+      if (event_ns > stop_ns) {
+        this->now_ns_ = stop_ns;
+        return;
+      }
+      this->now_ns_ = event_ns > this->now_ns_ ? event_ns : this->now_ns_;
+      this->source_->run_events(this->now_ns_);
+    }
+  }
+
+ protected:
+  uint64_t now_ns_{0};
+  SimEventSource *source_{nullptr};
+};
+
+}  // namespace wmbus_host
@@ -0,0 +1,309 @@
+#include "sim_platform.h"
+#include "esphome/components/spi/spi.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include <cstdarg>
+#include <cstdio>
+
+namespace wmbus_host {
+
+namespace {
+
+constexpr uint8_t PIN_COUNT = 64;
+constexpr uint32_t CPU_FREQ_HZ = 240000000;  // ESP32 at 240 MHz
+
+struct Pin {
+  bool level;
+  void (*isr)();
+  int mode;
+  uint32_t interrupts;
+};
+
+SimClock clock_;
+SimApplication app_;
+Pin pins_[PIN_COUNT];
+esphome::multical21_wmbus::CC1101Bus *spi_device_{nullptr};
+SimLogLevel log_level_{SIM_LOG_NONE};
+uint32_t log_counts_[SIM_LOG_LEVEL_COUNT];
+
+const char *const LOG_LETTERS = "-EWICDVV";
+
+}  // namespace
+
+SimClock &sim_clock() { return clock_; }
+SimApplication &sim_app() { return app_; }
+
+const char *sim_wake_model_to_string(SimWakeModel model) {
+  switch (model) {
+    case SimWakeModel::FAST:
+      return "fast";
+    case SimWakeModel::SLOW:
+      return "slow";
+    case SimWakeModel::POLL:
+      return "poll";
+    default:
+      return "unknown";
+  }
+}
+
+void sim_reset(const SimLoopTiming &timing) {
+  clock_ = SimClock();
+  for (Pin &pin : pins_) {
+    pin = Pin{};
+  }
+  spi_device_ = nullptr;
+  for (uint32_t &count : log_counts_) {
+    count = 0;
+  }
+  app_.reset(timing);
+}
+
+void sim_attach_spi(esphome::multical21_wmbus::CC1101Bus *device) { spi_device_ = device; }
+
+void sim_drive_pin(uint8_t pin, bool level) {
+  Pin &p = pins_[pin % PIN_COUNT];
+  if (p.level == level) {
+    return;
+  }
+  p.level = level;
+  if (p.isr == nullptr) {
+    return;  // Edges while detached are lost, as with a GPIO interrupt that is off
+  }
+  if (p.mode == CHANGE || (p.mode == RISING && level) || (p.mode == FALLING && !level)) {
+    p.interrupts++;
+    p.isr();
+  }
+}
+
+bool sim_pin_level(uint8_t pin) { return pins_[pin % PIN_COUNT].level; }
+uint32_t sim_interrupt_count(uint8_t pin) { return pins_[pin % PIN_COUNT].interrupts; }
+
+void sim_set_log_level(SimLogLevel level) { log_level_ = level; }
+uint32_t sim_log_count(SimLogLevel level) { return log_counts_[level]; }
+
+void sim_log(SimLogLevel level, const char *tag, const char *format, ...) {
+  log_counts_[level]++;
+  if (level > log_level_) {
+    return;
+  }
+  uint64_t now_us = clock_.now_ns() / 1000;
+  fprintf(stderr, "[%10llu.%06llu][%c][%s] ", (unsigned long long) (now_us / 1000000),
+          (unsigned long long) (now_us % 1000000), LOG_LETTERS[level], tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void sim_spi_select() {
+  if (spi_device_ != nullptr) {
+    spi_device_->cc1101_select();
+  }
+}
+
+void sim_spi_deselect() {
+  if (spi_device_ != nullptr) {
+    spi_device_->cc1101_deselect();
+  }
+}
+
+void sim_spi_write(uint8_t data, uint32_t byte_ns) {
+  clock_.advance_by(byte_ns);
+  if (spi_device_ != nullptr) {
+    spi_device_->cc1101_write_byte(data);
+  }
+}
+
+uint8_t sim_spi_read(uint32_t byte_ns) {
+  clock_.advance_by(byte_ns);
+  return spi_device_ != nullptr ? spi_device_->cc1101_read_byte() : 0xFF;
+}
+
+// ============================================================================
+// Application
+// ============================================================================
+
+void SimApplication::reset(const SimLoopTiming &timing) {
+  this->timing_ = timing;
+  this->components_.clear();
+  this->scheduled_.clear();
+  this->wake_ns_ = UINT64_MAX;
+  this->random_state_ = timing.seed != 0 ? timing.seed : 1;
+  this->high_frequency_requests_ = 0;
+  this->loop_passes_ = 0;
+  this->early_wakes_ = 0;
+}
+
+void SimApplication::setup() {
+  for (esphome::Component *component : this->components_) {
+    component->setup();
+    auto *polling = dynamic_cast<esphome::PollingComponent *>(component);
+    if (polling != nullptr && polling->get_update_interval() != 0) {
+      this->schedule(component, "update", polling->get_update_interval(), true, [polling]() { polling->update(); });
+    }
+  }
+}
+
+void SimApplication::run_until(uint64_t end_ns) {
+  while (clock_.now_ns() < end_ns) {
+    uint64_t pass_started_ns = clock_.now_ns();
+    this->wake_ns_ = UINT64_MAX;
+    this->run_scheduler_();
+    for (esphome::Component *component : this->components_) {
+      if (component->is_loop_enabled()) {
+        component->loop();
+      }
+    }
+    this->loop_passes_++;
+
+    uint64_t next_ns = this->is_high_frequency() ? clock_.now_ns() + this->timing_.high_frequency_pass_us * 1000ull
+                                                 : pass_started_ns + this->timing_.loop_interval_us * 1000ull;
+    next_ns = next_ns < end_ns ? next_ns : end_ns;
+    clock_.wait_until(next_ns, this->wake_ns_);
+    if (clock_.now_ns() < next_ns) {
+      this->early_wakes_++;
+    }
+  }
+}
+
+void SimApplication::run_scheduler_() {
+  uint64_t now_ns = clock_.now_ns();
+  // Index loop: a callback may append to the deque
+  for (size_t i = 0; i < this->scheduled_.size(); i++) {
+    if (this->scheduled_[i].cancelled || this->scheduled_[i].due_ns > now_ns) {
+      continue;
+    }
+    if (this->scheduled_[i].repeat) {
+      this->scheduled_[i].due_ns += this->scheduled_[i].interval_ms * 1000000ull;
+    } else {
+      this->scheduled_[i].cancelled = true;
+    }
+    this->scheduled_[i].callback();
+  }
+}
+
+void SimApplication::schedule(esphome::Component *component, const std::string &name, uint32_t delay_ms, bool repeat,
+                              std::function<void()> &&callback) {
+  this->cancel(component, name, repeat);
+  this->scheduled_.push_back(
+      Scheduled{component, name, delay_ms, clock_.now_ns() + delay_ms * 1000000ull, repeat, false, std::move(callback)});
+}
+
+bool SimApplication::cancel(esphome::Component *component, const std::string &name, bool repeat) {
+  bool found = false;
+  for (Scheduled &item : this->scheduled_) {
+    if (!item.cancelled && item.component == component && item.repeat == repeat && item.name == name) {
+      item.cancelled = true;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void SimApplication::wake_from_interrupt() {
+  if (this->timing_.wake_model == SimWakeModel::POLL) {
+    return;
+  }
+  uint64_t wake_ns = clock_.now_ns() + this->draw_wake_latency_us_() * 1000ull;
+  this->wake_ns_ = wake_ns < this->wake_ns_ ? wake_ns : this->wake_ns_;
+}
+
+void SimApplication::request_high_frequency(bool start) {
+  if (start) {
+    this->high_frequency_requests_++;
+  } else if (this->high_frequency_requests_ > 0) {
+    this->high_frequency_requests_--;
+  }
+}
+
+uint32_t SimApplication::draw_wake_latency_us_() {
+  // xorshift32: same draws on every host for a given seed
+  auto next = [this]() {
+    this->random_state_ ^= this->random_state_ << 13;
+    this->random_state_ ^= this->random_state_ >> 17;
+    this->random_state_ ^= this->random_state_ << 5;
+    return this->random_state_;
+  };
+  uint32_t tier = next() % 100;
+  uint32_t fraction = next() % 1000;
+  uint32_t slow_share = this->timing_.wake_model == SimWakeModel::SLOW ? 10 : 1;
+  uint32_t slowest_share = this->timing_.wake_model == SimWakeModel::SLOW ? 2 : 0;
+  if (tier < 100 - slow_share) {
+    return 300 * fraction / 1000;
+  }
+  if (tier < 100 - slowest_share) {
+    return 300 + 1700 * fraction / 1000;
+  }
+  return 2000 + 6000 * fraction / 1000;
+}
+
+}  // namespace wmbus_host
+
+// ============================================================================
+// ESPHome and Arduino API on the virtual clock
+// ============================================================================
+
+using wmbus_host::sim_app;
+using wmbus_host::sim_clock;
+
+void delay(uint32_t ms) { sim_clock().advance_by(ms * 1000000ull); }
+void delayMicroseconds(uint32_t us) { sim_clock().advance_by(us * 1000ull); }
+uint32_t millis() { return static_cast<uint32_t>(sim_clock().now_ns() / 1000000); }
+uint32_t micros() { return static_cast<uint32_t>(sim_clock().now_ns() / 1000); }
+void pinMode(uint8_t, uint8_t) {}
+int digitalPinToInterrupt(uint8_t pin) { return pin; }
+int digitalRead(uint8_t pin) { return wmbus_host::sim_pin_level(pin) ? 1 : 0; }
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+  wmbus_host::Pin &pin = wmbus_host::pins_[interrupt % wmbus_host::PIN_COUNT];
+  pin.isr = isr;
+  pin.mode = mode;
+}
+
+void detachInterrupt(int interrupt) { wmbus_host::pins_[interrupt % wmbus_host::PIN_COUNT].isr = nullptr; }
+
+namespace esphome {
+
+namespace setup_priority {
+const float DATA = 600.0f;
+}  // namespace setup_priority
+
+uint32_t arch_get_cpu_cycle_count() {
+  return static_cast<uint32_t>(sim_clock().now_ns() * (wmbus_host::CPU_FREQ_HZ / 1000000) / 1000);
+}
+uint32_t arch_get_cpu_freq_hz() { return wmbus_host::CPU_FREQ_HZ; }
+
+void Component::enable_loop_soon_any_context() {
+  this->loop_enabled_ = true;
+  sim_app().wake_from_interrupt();
+}
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  sim_app().schedule(this, name, interval, true, std::move(f));
+}
+
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  sim_app().schedule(this, name, timeout, false, std::move(f));
+}
+
+bool Component::cancel_interval(const std::string &name) { return sim_app().cancel(this, name, true); }
+bool Component::cancel_timeout(const std::string &name) { return sim_app().cancel(this, name, false); }
+
+void HighFrequencyLoopRequester::start() {
+  if (!this->started_) {
+    this->started_ = true;
+    sim_app().request_high_frequency(true);
+  }
+}
+
+void HighFrequencyLoopRequester::stop() {
+  if (this->started_) {
+    this->started_ = false;
+    sim_app().request_high_frequency(false);
+  }
+}
+
+bool HighFrequencyLoopRequester::is_high_frequency() { return sim_app().is_high_frequency(); }
+
+}  // namespace esphome
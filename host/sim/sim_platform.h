@@ -0,0 +1,118 @@
+#pragma once
+
+#include "cc1101_bus.h"
+#include "sim_clock.h"
+#include "esphome/core/component.h"
+#include "esphome/core/log.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace wmbus_host {
+
+/**
+ * @brief Time from an interrupt's enable_loop_soon_any_context() to the next loop() pass
+ *
+ * FAST and SLOW are the two models the FIFO streaming loss figures in the
+ * README were measured against. POLL never wakes early: the interrupt is
+ * only seen at the next regular pass, loop_interval_us after the last one.
+ */
+enum class SimWakeModel : uint8_t {
+  FAST,  // 99% under 0.3 ms, 1% up to 2 ms
+  SLOW,  // 90% under 0.3 ms, 8% up to 2 ms, 2% up to 8 ms
+  POLL,
+};
+
+const char *sim_wake_model_to_string(SimWakeModel model);
+
+/**
+ * @brief Main loop timing of the simulated ESPHome application
+ */
+struct SimLoopTiming {
+  uint32_t loop_interval_us{16000};       // ESPHome's default loop_interval
+  uint32_t high_frequency_pass_us{100};   // Pass length while a HighFrequencyLoopRequester runs
+  SimWakeModel wake_model{SimWakeModel::FAST};
+  uint32_t seed{1};                       // Wake latency draws are reproducible per seed
+};
+
+/// Virtual clock that micros(), millis(), delay() and the SPI bus run on
+SimClock &sim_clock();
+
+/**
+ * @brief Reset the platform: clock to zero, pins low, no interrupts, no
+ * scheduled callbacks, no SPI device, log counters cleared
+ */
+void sim_reset(const SimLoopTiming &timing = SimLoopTiming{});
+
+/// Route SPI transactions to a simulated device (e.g. VirtualCC1101)
+void sim_attach_spi(esphome::multical21_wmbus::CC1101Bus *device);
+
+/**
+ * @brief Drive a GPIO input, running its interrupt handler on a matching edge
+ */
+void sim_drive_pin(uint8_t pin, bool level);
+bool sim_pin_level(uint8_t pin);
+uint32_t sim_interrupt_count(uint8_t pin);
+
+/// Print log messages up to this level to stderr (default: none)
+void sim_set_log_level(SimLogLevel level);
+uint32_t sim_log_count(SimLogLevel level);
+
+/**
+ * @brief Scheduler and main loop of the simulated application
+ *
+ * run_until() repeats what App.loop() does on target: due intervals and
+ * timeouts, then every component's loop(), then waiting for the next pass.
+ * The wait ends after loop_interval_us (high_frequency_pass_us while a
+ * HighFrequencyLoopRequester runs), or earlier when an interrupt calls
+ * enable_loop_soon_any_context(), after a latency drawn from the wake model.
+ */
+class SimApplication {
+ public:
+  void reset(const SimLoopTiming &timing);
+  void register_component(esphome::Component *component) { this->components_.push_back(component); }
+
+  /// setup() of every component, then the update() interval of polling components
+  void setup();
+  void run_until(uint64_t end_ns);
+
+  uint32_t get_loop_passes() const { return this->loop_passes_; }
+  uint32_t get_early_wakes() const { return this->early_wakes_; }
+
+  // Used by the Component and HighFrequencyLoopRequester shims
+  void schedule(esphome::Component *component, const std::string &name, uint32_t delay_ms, bool repeat,
+                std::function<void()> &&callback);
+  bool cancel(esphome::Component *component, const std::string &name, bool repeat);
+  void wake_from_interrupt();
+  void request_high_frequency(bool start);
+  bool is_high_frequency() const { return this->high_frequency_requests_ > 0; }
+
+ protected:
+  struct Scheduled {
+    esphome::Component *component;
+    std::string name;
+    uint32_t interval_ms;
+    uint64_t due_ns;
+    bool repeat;
+    bool cancelled;
+    std::function<void()> callback;
+  };
+
+  void run_scheduler_();
+  uint32_t draw_wake_latency_us_();
+
+  SimLoopTiming timing_;
+  std::vector<esphome::Component *> components_;
+  std::deque<Scheduled> scheduled_;  // Callbacks may schedule more while they run
+  uint64_t wake_ns_{UINT64_MAX};
+  uint32_t random_state_{1};
+  uint32_t high_frequency_requests_{0};
+  uint32_t loop_passes_{0};
+  uint32_t early_wakes_{0};
+};
+
+SimApplication &sim_app();
+
+}  // namespace wmbus_host
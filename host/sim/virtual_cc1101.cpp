@@ -0,0 +1,526 @@
+#include "virtual_cc1101.h"
+#include <cstring>
+
+namespace wmbus_host {
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+// Power-on values of the configuration registers (datasheet table 43)
+const uint8_t RESET_VALUES[CC1101_CONFIG_REGISTER_COUNT] = {
+    0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04,  // 0x00-0x07
+    0x45, 0x00, 0x00, 0x0F, 0x00, 0x1E, 0xC4, 0xEC,  // 0x08-0x0F
+    0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30,  // 0x10-0x17
+    0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B,  // 0x18-0x1F
+    0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41,  // 0x20-0x27
+    0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B,        // 0x28-0x2E
+};
+
+constexpr uint8_t STROBE_FIRST = CC1101_SRES;
+constexpr uint8_t STROBE_LAST = 0x3D;  // SNOP
+constexpr uint8_t PARTNUM = 0x30;
+constexpr uint8_t VERSION = 0x31;
+constexpr uint8_t PARTNUM_VALUE = 0x00;
+constexpr uint8_t VERSION_VALUE = 0x14;
+constexpr uint8_t GDO_INVERT = 0x40;
+constexpr uint8_t GDO_SIGNAL_MASK = 0x3F;
+constexpr uint8_t GDO_RX_FIFO_THRESHOLD = 0x00;
+constexpr uint8_t GDO_RX_FIFO_THRESHOLD_OR_END = 0x01;
+constexpr uint8_t GDO_SYNC_TO_END = 0x06;
+constexpr uint8_t GDO_CHIP_RDYN = 0x29;
+constexpr uint8_t GDO_HIGH_IMPEDANCE = 0x2E;
+constexpr uint8_t GDO_CLK_XOSC_192 = 0x3F;
+constexpr uint8_t MCSM1_RXOFF_SHIFT = 2;
+constexpr uint8_t RXOFF_STAY_IN_RX = 0x03;
+constexpr uint8_t MCSM0_CAL_FROM_IDLE = 0x10;
+constexpr uint8_t LENGTH_FIXED = 0x00;
+constexpr uint8_t LENGTH_VARIABLE = 0x01;
+constexpr uint8_t RXBYTES_OVERFLOW = 0x80;
+constexpr uint8_t FRAME_LQI = 0x04;  // Clean signal; lower is better
+
+}  // namespace
+
+VirtualCC1101::VirtualCC1101(SimClock &clock) : clock_(clock) { this->reset_(); }
+
+void VirtualCC1101::transmit(uint64_t sync_end_ns, const uint8_t *bytes, uint16_t length, int16_t rssi_dbm) {
+  Frame frame;
+  frame.sync_end_ns = sync_end_ns;
+  frame.length = length < MAX_FRAME_SIZE ? length : MAX_FRAME_SIZE;
+  frame.rssi_dbm = rssi_dbm;
+  memcpy(frame.data, bytes, frame.length);
+  this->frames_.push_back(frame);
+}
+
+uint32_t VirtualCC1101::get_strobe_count(uint8_t strobe) const {
+  if (strobe < STROBE_FIRST || strobe > STROBE_LAST) {
+    return 0;
+  }
+  return this->strobes_[strobe - STROBE_FIRST];
+}
+
+void VirtualCC1101::reset_() {
+  memcpy(this->registers_, RESET_VALUES, sizeof(this->registers_));
+  this->marcstate_ = MARCSTATE_IDLE;
+  this->transition_ns_ = UINT64_MAX;
+  this->fifo_head_ = 0;
+  this->fifo_count_ = 0;
+  this->overflow_ = false;
+  this->in_packet_ = false;
+  this->next_byte_ns_ = UINT64_MAX;
+  this->rssi_ = dbm_to_rssi(NOISE_FLOOR_DBM);
+  this->lqi_ = 0;
+  this->power_down_on_deselect_ = false;
+  this->update_gdo_();
+}
+
+// ============================================================================
+// SPI
+// ============================================================================
+
+void VirtualCC1101::cc1101_select() {
+  this->selected_ = true;
+  this->header_expected_ = true;
+  this->spi_transactions_++;
+  if (this->marcstate_ == MARCSTATE_SLEEP && this->transition_ns_ == UINT64_MAX) {
+    // CSn low starts the crystal; the chip answers once it has settled
+    this->transition_ns_ = this->clock_.now_ns() + XOSC_START_NS;
+    this->transition_state_ = MARCSTATE_IDLE;
+    this->transition_calibrates_ = false;
+  }
+}
+
+void VirtualCC1101::cc1101_deselect() {
+  this->selected_ = false;
+  if (this->power_down_on_deselect_) {
+    this->power_down_on_deselect_ = false;
+    if (this->marcstate_ == MARCSTATE_IDLE) {
+      // TEST2..TEST0 and the FIFO do not survive SLEEP
+      memcpy(&this->registers_[CC1101_TEST2], &RESET_VALUES[CC1101_TEST2], 3);
+      this->fifo_count_ = 0;
+      this->overflow_ = false;
+      this->marcstate_ = MARCSTATE_SLEEP;
+      this->update_gdo_();
+    }
+  }
+}
+
+void VirtualCC1101::cc1101_write_byte(uint8_t data) {
+  if (!this->selected_ || !this->responding_()) {
+    return;  // Asleep until the crystal has started, or still resetting
+  }
+  if (this->header_expected_) {
+    this->address_ = data & 0x3F;
+    this->reading_ = (data & CC1101_READ_SINGLE) != 0;
+    this->burst_ = (data & CC1101_WRITE_BURST) != 0;
+    if (this->address_ >= STROBE_FIRST && this->address_ <= STROBE_LAST && !this->burst_) {
+      this->strobe_(this->address_);  // Next byte is a header again
+      return;
+    }
+    this->header_expected_ = false;
+    return;
+  }
+  if (this->reading_) {
+    return;  // Dummy byte of a read
+  }
+  this->write_register_(this->address_, data);
+  if (this->burst_ && this->address_ < CC1101_CONFIG_REGISTER_COUNT) {
+    this->address_++;
+  }
+}
+
+uint8_t VirtualCC1101::cc1101_read_byte() {
+  if (!this->selected_ || !this->responding_() || this->header_expected_ || !this->reading_) {
+    return 0xFF;
+  }
+  uint8_t value = this->read_register_(this->address_);
+  // Status registers and the FIFO keep their address; configuration bursts advance
+  if (this->burst_ && this->address_ < CC1101_CONFIG_REGISTER_COUNT) {
+    this->address_++;
+  }
+  return value;
+}
+
+void VirtualCC1101::cc1101_read_array(uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    data[i] = this->cc1101_read_byte();
+  }
+}
+
+void VirtualCC1101::cc1101_write_array(const uint8_t *data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    this->cc1101_write_byte(data[i]);
+  }
+}
+
+void VirtualCC1101::write_register_(uint8_t address, uint8_t value) {
+  if (address >= CC1101_CONFIG_REGISTER_COUNT) {
+    return;  // TX FIFO or read-only
+  }
+  if (this->dropped_writes_[address] != 0) {
+    this->dropped_writes_[address]--;
+    return;
+  }
+  this->registers_[address] = value;
+  if (address <= CC1101_IOCFG0 || address == CC1101_FIFOTHR) {
+    this->update_gdo_();
+  }
+}
+
+uint8_t VirtualCC1101::read_register_(uint8_t address) {
+  if (address == CC1101_RXFIFO) {
+    return this->read_fifo_();
+  }
+  if (address < CC1101_CONFIG_REGISTER_COUNT) {
+    return this->registers_[address];
+  }
+  if (!this->burst_) {
+    return 0;  // Strobe address; handled as a header
+  }
+  switch (address) {
+    case PARTNUM:
+      return PARTNUM_VALUE;
+    case VERSION:
+      return VERSION_VALUE;
+    case CC1101_LQI:
+      return this->lqi_;
+    case CC1101_RSSI:
+      return this->rssi_;
+    case CC1101_MARCSTATE:
+      return this->marcstate_;
+    case CC1101_RXBYTES:
+      return this->fifo_count_ | (this->overflow_ ? RXBYTES_OVERFLOW : 0);
+    default:
+      return 0;
+  }
+}
+
+uint8_t VirtualCC1101::read_fifo_() {
+  this->fifo_bytes_read_++;
+  if (this->fifo_count_ == 0) {
+    this->fifo_underflows_++;
+    return 0;
+  }
+  uint8_t value = this->fifo_[this->fifo_head_];
+  if (this->errata_ && this->in_packet_ && this->fifo_count_ == 1) {
+    // Emptied while a packet arrives: the byte stays and is read again
+    this->errata_duplicates_++;
+    return value;
+  }
+  this->fifo_head_ = (this->fifo_head_ + 1) % CC1101_FIFO_SIZE;
+  this->fifo_count_--;
+  this->update_gdo_();
+  return value;
+}
+
+// ============================================================================
+// Strobes and state transitions
+// ============================================================================
+
+void VirtualCC1101::strobe_(uint8_t strobe) {
+  this->strobes_[strobe - STROBE_FIRST]++;
+  uint64_t now_ns = this->clock_.now_ns();
+  bool idle = this->marcstate_ == MARCSTATE_IDLE && this->transition_ns_ == UINT64_MAX;
+
+  switch (strobe) {
+    case CC1101_SRES:
+      this->reset_();
+      this->reset_done_ns_ = now_ns + RESET_BUSY_NS;
+      break;
+
+    case CC1101_SCAL:
+      if (!idle) {
+        this->ignored_strobes_++;
+        break;
+      }
+      this->marcstate_ = MARCSTATE_STARTCAL;
+      this->transition_ns_ = now_ns + SCAL_NS;
+      this->transition_state_ = MARCSTATE_IDLE;
+      this->transition_calibrates_ = true;
+      break;
+
+    case CC1101_SRX: {
+      if (!idle) {
+        this->ignored_strobes_++;
+        break;
+      }
+      bool calibrate = (this->registers_[CC1101_MCSM0] & MCSM0_FS_AUTOCAL_MASK) == MCSM0_CAL_FROM_IDLE;
+      this->marcstate_ = calibrate ? MARCSTATE_STARTCAL : MARCSTATE_FS_LOCK;
+      this->transition_ns_ = now_ns + (calibrate ? RX_CALIBRATE_NS : RX_SETTLE_NS);
+      this->transition_state_ = MARCSTATE_RX;
+      this->transition_calibrates_ = calibrate;
+      break;
+    }
+
+    case CC1101_SIDLE:
+      // Aborts a packet, a calibration or an overflow; the FIFO keeps its bytes
+      this->transition_ns_ = UINT64_MAX;
+      this->in_packet_ = false;
+      this->next_byte_ns_ = UINT64_MAX;
+      this->marcstate_ = MARCSTATE_IDLE;
+      this->update_gdo_();
+      break;
+
+    case CC1101_SPWD:
+      this->power_down_on_deselect_ = true;
+      break;
+
+    case CC1101_SFRX:
+      if (this->marcstate_ != MARCSTATE_IDLE && this->marcstate_ != MARCSTATE_RXFIFO_OVERFLOW) {
+        this->ignored_strobes_++;  // Only legal in IDLE and RXFIFO_OVERFLOW
+        break;
+      }
+      this->fifo_count_ = 0;
+      this->overflow_ = false;
+      this->marcstate_ = MARCSTATE_IDLE;
+      this->update_gdo_();
+      break;
+
+    default:
+      break;  // TX, XOFF, WOR and SNOP do not matter here
+  }
+}
+
+void VirtualCC1101::calibrate_() {
+  // Calibration results depend on the frequency, so C1 and T1 differ
+  uint8_t *fscal = &this->registers_[CC1101_FSCAL3];
+  fscal[0] = (fscal[0] & 0xF0) | 0x09;
+  fscal[2] = 0x10 + (this->registers_[CC1101_FREQ1] ^ this->registers_[CC1101_FREQ0]) % 0x20;
+}
+
+void VirtualCC1101::enter_rx_() {
+  this->marcstate_ = MARCSTATE_RX;
+  this->rx_since_ns_ = this->clock_.now_ns();
+  this->rssi_ = dbm_to_rssi(NOISE_FLOOR_DBM);
+}
+
+// ============================================================================
+// Reception
+// ============================================================================
+
+uint64_t VirtualCC1101::next_event_ns() {
+  uint64_t next_ns = this->transition_ns_;
+  if (this->in_packet_ && this->next_byte_ns_ < next_ns) {
+    next_ns = this->next_byte_ns_;
+  }
+  if (this->marcstate_ == MARCSTATE_RX && !this->in_packet_) {
+    // Frames whose sync word went by while the radio was not searching are gone
+    uint64_t now_ns = this->clock_.now_ns();
+    while (this->next_frame_ < this->frames_.size() && this->frames_[this->next_frame_].sync_end_ns < now_ns) {
+      this->next_frame_++;
+      this->missed_++;
+    }
+    if (this->next_frame_ < this->frames_.size() && this->frames_[this->next_frame_].sync_end_ns < next_ns) {
+      next_ns = this->frames_[this->next_frame_].sync_end_ns;
+    }
+  }
+  if (this->next_clock_ns_ < next_ns) {
+    next_ns = this->next_clock_ns_;
+  }
+  return next_ns;
+}
+
+void VirtualCC1101::run_events(uint64_t now_ns) {
+  while (this->next_event_ns() <= now_ns) {
+    if (this->transition_ns_ <= now_ns) {
+      this->transition_ns_ = UINT64_MAX;
+      if (this->transition_calibrates_) {
+        this->calibrate_();
+      }
+      if (this->transition_state_ == MARCSTATE_RX) {
+        this->enter_rx_();
+      } else {
+        this->marcstate_ = this->transition_state_;
+      }
+      this->update_gdo_();
+      continue;
+    }
+    if (this->in_packet_ && this->next_byte_ns_ <= now_ns) {
+      this->receive_byte_();
+      continue;
+    }
+    if (this->next_clock_ns_ <= now_ns) {
+      this->clock_level_ = !this->clock_level_;
+      this->next_clock_ns_ += CLOCK_HALF_PERIOD_NS;
+      this->update_gdo_();
+      continue;
+    }
+    // Only a sync word is left
+    size_t frame = this->next_frame_++;
+    if (this->frames_[frame].sync_end_ns < this->rx_since_ns_ + SYNC_ACQUIRE_NS) {
+      this->late_rx_++;  // RX entered too late to catch preamble and sync word
+      continue;
+    }
+    this->start_packet_(frame);
+  }
+}
+
+void VirtualCC1101::start_packet_(size_t frame) {
+  this->current_frame_ = static_cast<int32_t>(frame);
+  this->in_packet_ = true;
+  this->packet_bytes_ = 0;
+  this->next_byte_ns_ = this->frames_[frame].sync_end_ns + BYTE_NS;
+  this->packet_rssi_ = dbm_to_rssi(this->frames_[frame].rssi_dbm);
+  this->rssi_ = this->packet_rssi_;
+  this->lqi_ = FRAME_LQI;
+  this->syncs_++;
+  this->update_gdo_();
+}
+
+void VirtualCC1101::receive_byte_() {
+  const Frame &frame = this->frames_[this->current_frame_];
+  uint8_t value;
+  if (this->packet_bytes_ < frame.length) {
+    value = frame.data[this->packet_bytes_];
+  } else {
+    value = this->noise_();  // Transmitter is done; the demodulator keeps going
+    this->rssi_ = dbm_to_rssi(NOISE_FLOOR_DBM);
+  }
+  this->packet_bytes_++;
+  if (this->packet_bytes_ == 1) {
+    this->length_field_ = value;
+  }
+  this->push_fifo_(value);
+  if (!this->in_packet_) {
+    return;  // Overflowed
+  }
+
+  uint8_t length_config = this->registers_[CC1101_PKTCTRL0] & PKTCTRL0_LENGTH_CONFIG_MASK;
+  uint16_t packet_length = UINT16_MAX;
+  if (length_config == LENGTH_FIXED) {
+    // 8-bit byte counter: PKTLEN 0 is 256, and a PKTLEN already passed only matches after a wrap
+    uint16_t pktlen = this->registers_[CC1101_PKTLEN] != 0 ? this->registers_[CC1101_PKTLEN] : 256;
+    if ((this->packet_bytes_ & 0xFF) == (pktlen & 0xFF)) {
+      packet_length = this->packet_bytes_;
+    }
+  } else if (length_config == LENGTH_VARIABLE) {
+    packet_length = 1 + this->length_field_;
+  }
+  if (this->packet_bytes_ >= packet_length) {
+    this->end_packet_();
+    return;
+  }
+  this->next_byte_ns_ += BYTE_NS;
+  this->update_gdo_();
+}
+
+void VirtualCC1101::end_packet_() {
+  this->in_packet_ = false;
+  this->next_byte_ns_ = UINT64_MAX;
+  this->lqi_ |= LQI_CRC_OK;  // CRC check is disabled, so CRC_OK is always set
+  if (this->registers_[CC1101_PKTCTRL1] & PKTCTRL1_APPEND_STATUS) {
+    this->push_fifo_(this->packet_rssi_);
+    this->push_fifo_(this->lqi_);
+  }
+  if (this->marcstate_ == MARCSTATE_RXFIFO_OVERFLOW) {
+    return;  // No room for the status bytes
+  }
+  if (this->fifo_count_ > 0) {
+    this->threshold_or_end_ = true;
+  }
+  if (((this->registers_[CC1101_MCSM1] >> MCSM1_RXOFF_SHIFT) & 0x03) == RXOFF_STAY_IN_RX) {
+    this->enter_rx_();  // Straight back to sync search
+  } else {
+    this->marcstate_ = MARCSTATE_IDLE;
+  }
+  this->update_gdo_();
+}
+
+void VirtualCC1101::push_fifo_(uint8_t value) {
+  if (this->fifo_count_ == CC1101_FIFO_SIZE) {
+    this->overflow_ = true;
+    this->overflows_++;
+    this->in_packet_ = false;
+    this->next_byte_ns_ = UINT64_MAX;
+    this->marcstate_ = MARCSTATE_RXFIFO_OVERFLOW;
+    this->update_gdo_();
+    return;
+  }
+  this->fifo_[(this->fifo_head_ + this->fifo_count_) % CC1101_FIFO_SIZE] = value;
+  this->fifo_count_++;
+}
+
+// ============================================================================
+// GDO pins
+// ============================================================================
+
+uint8_t VirtualCC1101::rx_threshold_() const {
+  return 4 * ((this->registers_[CC1101_FIFOTHR] & 0x0F) + 1);
+}
+
+bool VirtualCC1101::gdo_signal_(uint8_t config) const {
+  switch (config & GDO_SIGNAL_MASK) {
+    case GDO_RX_FIFO_THRESHOLD:
+      return this->fifo_count_ >= this->rx_threshold_();
+    case GDO_RX_FIFO_THRESHOLD_OR_END:
+      return this->threshold_or_end_;
+    case GDO_SYNC_TO_END:
+      return this->in_packet_;
+    case GDO_CHIP_RDYN:
+      return this->marcstate_ == MARCSTATE_SLEEP;
+    case GDO_CLK_XOSC_192:
+      return this->clock_level_;
+    default:
+      return false;
+  }
+}
+
+bool VirtualCC1101::clock_output_() const {
+  if (this->marcstate_ == MARCSTATE_SLEEP) {
+    return false;  // Crystal is off
+  }
+  return (this->registers_[CC1101_IOCFG0] & GDO_SIGNAL_MASK) == GDO_CLK_XOSC_192 ||
+         (this->registers_[CC1101_IOCFG2] & GDO_SIGNAL_MASK) == GDO_CLK_XOSC_192;
+}
+
+bool VirtualCC1101::responding_() const {
+  return this->marcstate_ != MARCSTATE_SLEEP && this->clock_.now_ns() >= this->reset_done_ns_;
+}
+
+void VirtualCC1101::update_gdo_() {
+  if (this->fifo_count_ == 0) {
+    this->threshold_or_end_ = false;
+  } else if (this->fifo_count_ >= this->rx_threshold_()) {
+    this->threshold_or_end_ = true;
+  }
+
+  bool clock = this->clock_output_();
+  if (clock && this->next_clock_ns_ == UINT64_MAX) {
+    this->next_clock_ns_ = this->clock_.now_ns() + CLOCK_HALF_PERIOD_NS;
+  } else if (!clock) {
+    this->next_clock_ns_ = UINT64_MAX;
+  }
+
+  const uint8_t configs[2] = {this->registers_[CC1101_IOCFG0], this->registers_[CC1101_IOCFG2]};
+  for (uint8_t i = 0; i < 2; i++) {
+    bool level = false;
+    if ((configs[i] & GDO_SIGNAL_MASK) != GDO_HIGH_IMPEDANCE) {
+      level = this->gdo_signal_(configs[i]) != ((configs[i] & GDO_INVERT) != 0);
+    }
+    if (level == this->gdo_levels_[i]) {
+      continue;
+    }
+    this->gdo_levels_[i] = level;
+    this->gdo_edges_[i]++;
+    if ((configs[i] & GDO_SIGNAL_MASK) == GDO_CLK_XOSC_192) {
+      this->clock_edges_++;
+    }
+    if (this->gdo_callback_) {
+      this->gdo_callback_(i == 0 ? 0 : 2, level);
+    }
+  }
+}
+
+uint8_t VirtualCC1101::noise_() {
+  this->noise_state_ ^= this->noise_state_ << 13;
+  this->noise_state_ ^= this->noise_state_ >> 17;
+  this->noise_state_ ^= this->noise_state_ << 5;
+  return static_cast<uint8_t>(this->noise_state_);
+}
+
+uint8_t VirtualCC1101::dbm_to_rssi(int16_t dbm) {
+  // Inverse of CC1101Radio::rssi_to_dbm(): offset 74 dB, 0.5 dB steps, two's complement
+  return static_cast<uint8_t>(static_cast<int8_t>((dbm + 74) * 2));
+}
+
+}  // namespace wmbus_host
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "cc1101_bus.h"
+#include "sim_clock.h"
+#include "wmbus_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace wmbus_host {
+
+/**
+ * @brief Simulated CC1101 behind the CC1101Bus SPI transport
+ *
+ * Models what the receive path depends on, on a SimClock:
+ * - Header/strobe/burst SPI protocol, the configuration registers with their
+ *   reset values, and the status registers (PARTNUM, VERSION, RSSI, LQI,
+ *   MARCSTATE, RXBYTES with the 0x80 overflow bit)
+ * - MARCSTATE transitions with their datasheet durations: SRX with and
+ *   without FS_AUTOCAL calibration, SCAL, SIDLE, SFRX (IDLE and overflow
+ *   only), SPWD on CSn high and the crystal start-up on wake, SRES (SPI
+ *   is ignored until the reset is done)
+ * - Reception of transmitted frames at 100 kbps: sync detection only if RX
+ *   was entered early enough, noise after the frame's last byte, fixed,
+ *   variable and infinite length (PKTLEN/PKTCTRL0 are read per byte, so a
+ *   switch mid-packet takes effect), APPEND_STATUS and MCSM1.RXOFF_MODE
+ * - The 64-byte RX FIFO with overflow (MARCSTATE 0x11, reception stops) and
+ *   the errata: reading the FIFO empty while a packet is still arriving
+ *   duplicates the last byte
+ * - GDO0 and GDO2 for the signals the component uses (0x00, 0x01, 0x06,
+ *   0x29, 0x2E and the 0x3F reset clock output), with the 0x40 inversion;
+ *   every level change is passed to the GDO callback
+ *
+ * Not modelled: TX, CRC and address filtering, carrier sense, and
+ * collisions between overlapping frames (the first one synced wins).
+ */
+class VirtualCC1101 : public esphome::multical21_wmbus::CC1101Bus, public SimEventSource {
+ public:
+  static constexpr uint64_t BYTE_NS = esphome::multical21_wmbus::C1_BYTE_US * 1000ull;  // 100 kbps
+  static constexpr uint64_t SYNC_ACQUIRE_NS = 32 * BYTE_NS / 8;  // Preamble for bit sync plus the sync word
+  static constexpr uint64_t RX_CALIBRATE_NS = 799000;  // IDLE -> RX with calibration (datasheet table 34)
+  static constexpr uint64_t RX_SETTLE_NS = 88400;      // IDLE -> RX without calibration
+  static constexpr uint64_t SCAL_NS = 712000;          // Manual calibration
+  static constexpr uint64_t XOSC_START_NS = 150000;    // SLEEP -> IDLE after CSn goes low
+  static constexpr uint64_t RESET_BUSY_NS = 50000;     // SRES until SO goes low (no datasheet figure; errs long)
+  static constexpr uint64_t CLOCK_HALF_PERIOD_NS = 3692;  // CLK_XOSC/192 at 26 MHz
+  static constexpr uint16_t MAX_FRAME_SIZE = 258;      // 2 bytes after the sync word + L-field + 255
+  static constexpr int16_t NOISE_FLOOR_DBM = -105;
+
+  static constexpr uint8_t MARCSTATE_SLEEP = 0x00;
+  static constexpr uint8_t MARCSTATE_STARTCAL = 0x08;
+  static constexpr uint8_t MARCSTATE_FS_LOCK = 0x0A;
+
+  using GdoCallback = std::function<void(uint8_t gdo, bool level)>;
+
+  explicit VirtualCC1101(SimClock &clock);
+
+  /// Level changes of GDO0 (gdo 0) and GDO2 (gdo 2)
+  void set_gdo_callback(GdoCallback &&callback) { this->gdo_callback_ = std::move(callback); }
+
+  /**
+   * @brief Put a frame on the air
+   *
+   * Frames must be transmitted in order of sync_end_ns.
+   *
+   * @param sync_end_ns Time the last bit of the sync word arrives
+   * @param bytes Bytes after the sync word
+   * @param rssi_dbm Signal level while the frame is on the air
+   */
+  void transmit(uint64_t sync_end_ns, const uint8_t *bytes, uint16_t length, int16_t rssi_dbm);
+  void reserve_frames(size_t count) { this->frames_.reserve(count); }
+
+  /// Reading the FIFO empty mid-packet duplicates the last byte (on by default)
+  void set_errata(bool errata) { this->errata_ = errata; }
+
+  /// Lose the next count SPI writes to a configuration register, as a glitch on the bus would
+  void drop_writes(uint8_t reg, uint32_t count) { this->dropped_writes_[reg] = count; }
+
+  /// Change a configuration register behind the driver's back, as a supply glitch would
+  void upset_register(uint8_t reg, uint8_t value) {
+    this->registers_[reg] = value;
+    this->update_gdo_();
+  }
+
+  // CC1101Bus
+  void cc1101_select() override;
+  void cc1101_deselect() override;
+  void cc1101_write_byte(uint8_t data) override;
+  uint8_t cc1101_read_byte() override;
+  void cc1101_read_array(uint8_t *data, size_t length) override;
+  void cc1101_write_array(const uint8_t *data, size_t length) override;
+
+  // SimEventSource
+  uint64_t next_event_ns() override;
+  void run_events(uint64_t now_ns) override;
+
+  uint8_t get_marcstate() const { return this->marcstate_; }
+  uint8_t get_register(uint8_t reg) const { return this->registers_[reg]; }
+  uint8_t get_fifo_count() const { return this->fifo_count_; }
+  bool get_gdo_level(uint8_t gdo) const { return this->gdo_levels_[gdo == 0 ? 0 : 1]; }
+
+  /// Frame being received, or the last one synced (-1: none yet)
+  int32_t get_current_frame() const { return this->current_frame_; }
+  size_t get_frame_count() const { return this->frames_.size(); }
+  uint32_t get_sync_count() const { return this->syncs_; }
+  /// Frames whose sync word went by while the radio was not searching (not in RX, or receiving)
+  uint32_t get_missed_count() const { return this->missed_; }
+  /// Frames whose sync word came too soon after RX was entered
+  uint32_t get_late_rx_count() const { return this->late_rx_; }
+  uint32_t get_overflow_count() const { return this->overflows_; }
+  uint32_t get_errata_duplicate_count() const { return this->errata_duplicates_; }
+  uint32_t get_fifo_underflow_count() const { return this->fifo_underflows_; }
+  /// RX FIFO bytes clocked out over SPI, duplicates and underflows included
+  uint32_t get_fifo_bytes_read() const { return this->fifo_bytes_read_; }
+  uint32_t get_ignored_strobe_count() const { return this->ignored_strobes_; }
+  uint32_t get_strobe_count(uint8_t strobe) const;
+  uint32_t get_gdo_edge_count(uint8_t gdo) const { return this->gdo_edges_[gdo == 0 ? 0 : 1]; }
+  /// Clock output edges that reached a GDO pin
+  uint32_t get_clock_edge_count() const { return this->clock_edges_; }
+  uint32_t get_spi_transaction_count() const { return this->spi_transactions_; }
+
+ protected:
+  struct Frame {
+    uint64_t sync_end_ns;
+    uint16_t length;
+    int16_t rssi_dbm;
+    uint8_t data[MAX_FRAME_SIZE];
+  };
+
+  void reset_();
+  void strobe_(uint8_t strobe);
+  void write_register_(uint8_t address, uint8_t value);
+  uint8_t read_register_(uint8_t address);
+  uint8_t read_fifo_();
+  void receive_byte_();
+  void start_packet_(size_t frame);
+  void end_packet_();
+  void push_fifo_(uint8_t value);
+  void enter_rx_();
+  void calibrate_();
+  void update_gdo_();
+  bool gdo_signal_(uint8_t config) const;
+  uint8_t rx_threshold_() const;
+  bool clock_output_() const;
+  bool responding_() const;
+  uint8_t noise_();
+  static uint8_t dbm_to_rssi(int16_t dbm);
+
+  SimClock &clock_;
+  GdoCallback gdo_callback_;
+  bool errata_{true};
+
+  uint8_t registers_[esphome::multical21_wmbus::CC1101_CONFIG_REGISTER_COUNT];
+  uint32_t dropped_writes_[esphome::multical21_wmbus::CC1101_CONFIG_REGISTER_COUNT]{};
+  uint8_t marcstate_{esphome::multical21_wmbus::MARCSTATE_IDLE};
+  uint64_t transition_ns_{UINT64_MAX};  // Pending STARTCAL/FS_LOCK/wake transition
+  uint8_t transition_state_{esphome::multical21_wmbus::MARCSTATE_IDLE};
+  bool transition_calibrates_{false};
+  uint64_t rx_since_ns_{0};
+  uint64_t reset_done_ns_{0};  // SRES in progress until then
+
+  // SPI transaction
+  bool selected_{false};
+  bool header_expected_{true};
+  uint8_t address_{0};
+  bool reading_{false};
+  bool burst_{false};
+  bool power_down_on_deselect_{false};
+
+  // RX FIFO
+  uint8_t fifo_[esphome::multical21_wmbus::CC1101_FIFO_SIZE];
+  uint8_t fifo_head_{0};
+  uint8_t fifo_count_{0};
+  bool overflow_{false};
+
+  // Air and packet handling
+  std::vector<Frame> frames_;
+  size_t next_frame_{0};
+  int32_t current_frame_{-1};
+  bool in_packet_{false};
+  uint16_t packet_bytes_{0};
+  uint8_t length_field_{0};  // First byte of the packet, the length in variable length mode
+  uint64_t next_byte_ns_{UINT64_MAX};
+  uint8_t rssi_{0};
+  uint8_t packet_rssi_{0};  // RSSI at sync, appended with the status bytes
+  uint8_t lqi_{0};
+  uint32_t noise_state_{0x2545F491};
+
+  // GDO pins (index 0: GDO0, 1: GDO2)
+  bool gdo_levels_[2]{};
+  bool threshold_or_end_{false};  // Signal 0x01: set at threshold or end of packet, cleared when empty
+  bool clock_level_{false};
+  uint64_t next_clock_ns_{UINT64_MAX};
+
+  uint32_t syncs_{0};
+  uint32_t missed_{0};
+  uint32_t late_rx_{0};
+  uint32_t overflows_{0};
+  uint32_t errata_duplicates_{0};
+  uint32_t fifo_underflows_{0};
+  uint32_t fifo_bytes_read_{0};
+  uint32_t ignored_strobes_{0};
+  uint32_t strobes_[14]{};
+  uint32_t gdo_edges_[2]{};
+  uint32_t clock_edges_{0};
+  uint32_t spi_transactions_{0};
+};
+
+}  // namespace wmbus_host
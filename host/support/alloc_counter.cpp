@@ -0,0 +1,26 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions so benchmarks and tests can check
+// that the telegram path never touches the heap. The array, nothrow and
+// sized forms all forward to these two by default.
+
+static std::atomic<uint64_t> allocations{0};
+
+namespace wmbus_host {
+
+uint64_t allocation_count() { return allocations.load(std::memory_order_relaxed); }
+
+}  // namespace wmbus_host
+
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
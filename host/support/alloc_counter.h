@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace wmbus_host {
+
+/**
+ * @brief Heap allocations made through operator new since start-up
+ *
+ * Only counts in executables that link alloc_counter.cpp, which replaces
+ * the global operator new/delete.
+ */
+uint64_t allocation_count();
+
+}  // namespace wmbus_host
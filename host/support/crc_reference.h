@@ -0,0 +1,63 @@
+#pragma once
+
+#include "wmbus_types.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace wmbus_host {
+
+/**
+ * @brief CRC-16-EN-13757-4, bit-serial as in spec section 6.1
+ *
+ * The augmented form the component used before the table-driven
+ * WMBusCrypto::crc_update(): 16 zero bits in, one bit per step, 16 zero bits
+ * out. Kept as the reference the table is checked against.
+ */
+inline uint16_t crc_bit_serial(const uint8_t *data, size_t length) {
+  const uint16_t poly = esphome::multical21_wmbus::CRC_POLY;
+  uint16_t crc = 0x0000;
+
+  // Initial CRC calculation
+  for (int i = 0; i < 16; i++) {
+    bool bit = crc & 1;
+    if (bit) {
+      crc ^= poly;
+    }
+    crc >>= 1;
+    if (bit) {
+      crc |= 0x8000;
+    }
+  }
+
+  // Process each byte
+  for (size_t i = 0; i < length; i++) {
+    uint8_t c = data[i];
+
+    for (int j = 7; j >= 0; j--) {
+      bool bit = crc & 0x8000;
+      crc <<= 1;
+      if (c & (1 << j)) {
+        crc |= 1;
+      }
+      if (bit) {
+        crc ^= poly;
+      }
+    }
+  }
+
+  // Final CRC calculation
+  for (int i = 0; i < 16; i++) {
+    bool bit = crc & 0x8000;
+    crc <<= 1;
+    if (bit) {
+      crc ^= poly;
+    }
+  }
+
+  // Final XOR
+  crc ^= 0xFFFF;
+
+  return crc & 0xFFFF;
+}
+
+}  // namespace wmbus_host
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "wmbus_crypto.h"
+#include "wmbus_types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace wmbus_host {
+
+/// AES key the synthetic telegrams are encrypted with
+constexpr std::array<uint8_t, 16> TEST_KEY = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                              0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+constexpr uint32_t TEST_METER_ID = 0x12345678;
+
+/// Plaintext lengths of the two Multical21 frame types
+constexpr uint8_t COMPACT_PLAINTEXT_SIZE = 19;
+constexpr uint8_t LONG_PLAINTEXT_SIZE = 26;
+
+/**
+ * @brief Readings a synthetic telegram carries
+ */
+struct TestReading {
+  uint32_t total_liters{123456};
+  uint32_t target_liters{120000};
+  int8_t flow_temperature_c{12};
+  int8_t ambient_temperature_c{21};
+  uint8_t info_codes{0x00};
+  bool long_frame{false};
+};
+
+/**
+ * @brief Build an encrypted Multical21 C1 telegram
+ *
+ * Uses the header layout the component decodes (see
+ * WMBUS_IMPLEMENTATION_SPEC.md): M-field "KAM", meter ID little-endian,
+ * access number at OFFSET_ACCESS_NUMBER, AES-CTR payload from
+ * OFFSET_CIPHER_START and the CRC over everything before it.
+ *
+ * @param frame Output, at least L + 1 bytes (45 for a long frame)
+ * @return Bytes written (L-field value + 1)
+ */
+inline size_t build_telegram(uint8_t *frame, uint32_t meter_id, uint8_t access_number, const TestReading &reading,
+                             const std::array<uint8_t, 16> &key = TEST_KEY) {
+  using namespace esphome::multical21_wmbus;
+
+  uint8_t plaintext[LONG_PLAINTEXT_SIZE] = {};
+  uint8_t length;
+  uint8_t pos_info, pos_total, pos_target, pos_flow, pos_ambient;
+  if (reading.long_frame) {
+    length = LONG_PLAINTEXT_SIZE;
+    plaintext[2] = 0x78;
+    pos_info = 6, pos_total = 10, pos_target = 16, pos_flow = 22, pos_ambient = 25;
+  } else {
+    length = COMPACT_PLAINTEXT_SIZE;
+    plaintext[2] = 0x79;
+    pos_info = 7, pos_total = 9, pos_target = 13, pos_flow = 17, pos_ambient = 18;
+  }
+  plaintext[pos_info] = reading.info_codes;
+  for (int i = 0; i < 4; i++) {
+    plaintext[pos_total + i] = static_cast<uint8_t>(reading.total_liters >> (8 * i));
+    plaintext[pos_target + i] = static_cast<uint8_t>(reading.target_liters >> (8 * i));
+  }
+  plaintext[pos_flow] = static_cast<uint8_t>(reading.flow_temperature_c);
+  plaintext[pos_ambient] = static_cast<uint8_t>(reading.ambient_temperature_c);
+
+  uint8_t l_field = OFFSET_CIPHER_START - 1 + length + CRC_SIZE;
+  frame[0] = l_field;
+  frame[OFFSET_C_FIELD] = 0x44;
+  frame[OFFSET_M_FIELD] = 0x2D;  // "KAM"
+  frame[OFFSET_M_FIELD + 1] = 0x2C;
+  for (int i = 0; i < 4; i++) {
+    frame[OFFSET_METER_ID + i] = static_cast<uint8_t>(meter_id >> (8 * i));
+  }
+  frame[OFFSET_VERSION] = 0x1B;
+  frame[OFFSET_DEVICE_TYPE] = 0x16;  // Cold water
+  frame[10] = 0x8D;
+  frame[11] = 0x20;
+  frame[12] = 0x00;
+  frame[OFFSET_ACCESS_NUMBER] = access_number;
+  frame[OFFSET_ACCESS_NUMBER + 1] = 0x00;  // Status
+  frame[OFFSET_ACCESS_NUMBER + 2] = 0x10;  // Configuration: mode 5
+  frame[OFFSET_ACCESS_NUMBER + 3] = 0x00;
+
+  // CTR is symmetric: "decrypting" the plaintext encrypts it
+  WMBusCrypto crypto;
+  crypto.set_key(key);
+  crypto.begin_stream(frame, length);
+  crypto.stream_decrypt(plaintext, &frame[OFFSET_CIPHER_START], length);
+
+  uint16_t crc = WMBusCrypto::calculate_crc(frame, l_field - 1);
+  frame[l_field - 1] = static_cast<uint8_t>(crc >> 8);
+  frame[l_field] = static_cast<uint8_t>(crc & 0xFF);
+  return l_field + 1;
+}
+
+}  // namespace wmbus_host
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "wmbus_crypto.h"
+#include "wmbus_t1_decoder.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace wmbus_host {
+
+/// EN 13757-4 table 10, nibble -> 6-chip symbol, written out independently of the decoder's copy
+constexpr uint8_t SYMBOLS_3OF6[16] = {
+    0b010110, 0b001101, 0b001110, 0b001011, 0b011100, 0b011001, 0b011010, 0b010011,
+    0b101100, 0b100101, 0b100110, 0b100011, 0b110100, 0b110001, 0b110010, 0b101001,
+};
+
+/**
+ * @brief Chip at a bit position of the raw FIFO bytes (MSB first)
+ */
+inline uint8_t chip_at(const uint8_t *raw, size_t bit) { return (raw[bit / 8] >> (7 - bit % 8)) & 1; }
+
+/**
+ * @brief 3-out-of-6 decoder, one chip and one symbol at a time
+ *
+ * The straightforward form the table decoder is checked against: gather 6
+ * chips, search the symbol table for them.
+ */
+inline bool decode_3of6_bit_serial(const uint8_t *raw, uint8_t *out, size_t count) {
+  size_t bit = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t byte = 0;
+    for (int half = 0; half < 2; half++) {
+      uint8_t symbol = 0;
+      for (int chip = 0; chip < 6; chip++) {
+        symbol = static_cast<uint8_t>((symbol << 1) | chip_at(raw, bit++));
+      }
+      int nibble = -1;
+      for (int n = 0; n < 16; n++) {
+        if (SYMBOLS_3OF6[n] == symbol) {
+          nibble = n;
+          break;
+        }
+      }
+      if (nibble < 0) {
+        return false;
+      }
+      byte = static_cast<uint8_t>((byte << 4) | nibble);
+    }
+    out[i] = byte;
+  }
+  return true;
+}
+
+/**
+ * @brief Encode bytes into 3-out-of-6 chips, as a T1 meter sends them
+ *
+ * @param raw Output, WMBusT1Decoder::encoded_size(count) bytes; a trailing
+ *            half byte is zero-padded
+ */
+inline void encode_3of6(const uint8_t *data, size_t count, uint8_t *raw) {
+  size_t bit = 0;
+  for (size_t i = 0; i < esphome::multical21_wmbus::WMBusT1Decoder::encoded_size(count); i++) {
+    raw[i] = 0;
+  }
+  for (size_t i = 0; i < count; i++) {
+    uint16_t chips = static_cast<uint16_t>((SYMBOLS_3OF6[data[i] >> 4] << 6) | SYMBOLS_3OF6[data[i] & 0x0F]);
+    for (int chip = 11; chip >= 0; chip--, bit++) {
+      raw[bit / 8] |= static_cast<uint8_t>(((chips >> chip) & 1) << (7 - bit % 8));
+    }
+  }
+}
+
+/**
+ * @brief Split a telegram into Frame Format A blocks with their CRCs
+ *
+ * @param data L-field (data bytes after it, no CRCs) and data
+ * @param frame Output, WMBusT1Decoder::frame_size(data[0]) bytes
+ */
+inline void build_frame_a(const uint8_t *data, uint8_t *frame) {
+  using esphome::multical21_wmbus::WMBusCrypto;
+  using esphome::multical21_wmbus::WMBusT1Decoder;
+  size_t left = data[0] + 1;
+  size_t block = WMBusT1Decoder::FIRST_BLOCK_SIZE;
+  while (left > 0) {
+    block = block < left ? block : left;
+    for (size_t i = 0; i < block; i++) {
+      frame[i] = data[i];
+    }
+    uint16_t crc = WMBusCrypto::calculate_crc(data, static_cast<uint8_t>(block));
+    frame[block] = static_cast<uint8_t>(crc >> 8);
+    frame[block + 1] = static_cast<uint8_t>(crc);
+    data += block;
+    frame += block + 2;
+    left -= block;
+    block = WMBusT1Decoder::BLOCK_SIZE;
+  }
+}
+
+}  // namespace wmbus_host
@@ -0,0 +1,136 @@
+#include "wmbus_census.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint16_t KAM = 0x2C2D;
+constexpr size_t SLOTS = 8;
+using Census = WMBusCensus<SLOTS>;
+
+/// Home slot as WMBusCensus computes it, to build probe chains on purpose
+size_t home_slot(uint32_t meter_id, uint16_t manufacturer) {
+  uint32_t key = meter_id ^ (static_cast<uint32_t>(manufacturer) * 0x9E3779B9u);
+  return ((key * 2654435761u) >> 16) & (SLOTS - 1);
+}
+
+/// The first count IDs from 0x10000000 up whose home is slot
+std::vector<uint32_t> ids_with_home(size_t slot, size_t count) {
+  std::vector<uint32_t> ids;
+  for (uint32_t id = 0x10000000; ids.size() < count; id++) {
+    if (home_slot(id, KAM) == slot) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+bool listed(const Census &census, uint32_t meter_id) {
+  std::string json;
+  census.to_json(json, 0);
+  char needle[16];
+  snprintf(needle, sizeof(needle), "\"%08X\"", (unsigned) meter_id);
+  return json.find(needle) != std::string::npos;
+}
+
+}  // namespace
+
+TEST(Census, EvictsTheLeastRecentlyHeardMeter) {
+  Census census;
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < Census::MAX_ENTRIES; i++) {
+    ids.push_back(0x20000000 + i * 0x1F3D5);
+    census.record(ids.back(), KAM, 27, 22, -70, 1000 + i);
+  }
+  ASSERT_EQ(census.size(), Census::MAX_ENTRIES);
+  census.record(ids[0], KAM, 27, 22, -70, 2000);  // Oldest heard again
+
+  census.record(0x30000001, KAM, 27, 22, -70, 3000);
+  EXPECT_EQ(census.size(), Census::MAX_ENTRIES);
+  EXPECT_EQ(census.get_eviction_count(), 1u);
+  EXPECT_TRUE(listed(census, ids[0]));
+  EXPECT_FALSE(listed(census, ids[1]));
+  EXPECT_TRUE(listed(census, 0x30000001));
+
+  census.record(0x30000002, KAM, 27, 22, -70, 3001);
+  EXPECT_EQ(census.get_eviction_count(), 2u);
+  EXPECT_FALSE(listed(census, ids[2]));
+  for (size_t i = 3; i < ids.size(); i++) {
+    EXPECT_TRUE(listed(census, ids[i])) << i;
+  }
+}
+
+TEST(Census, EraseKeepsAWrappedProbeChainReachable) {
+  // One probe chain from the last slot across the wrap: A (home 7) at 7,
+  // B and C (home 0) at 0 and 1, D (home 7) at 2, then E and F (home 3).
+  // Evicting A must leave B and C where they are (their home is behind the
+  // hole only cyclically) and pull D back to slot 7.
+  Census census;
+  std::vector<uint32_t> last_home = ids_with_home(SLOTS - 1, 3);
+  std::vector<uint32_t> zero_home = ids_with_home(0, 2);
+  std::vector<uint32_t> behind = ids_with_home(3, 2);
+  std::vector<uint32_t> wrapped = {last_home[0], zero_home[0], zero_home[1], last_home[1]};
+  uint32_t now = 1000;
+  for (uint32_t id : wrapped) {
+    census.record(id, KAM, 27, 22, -70, now++);
+  }
+  for (uint32_t id : behind) {
+    census.record(id, KAM, 27, 22, -70, now++);
+  }
+  ASSERT_EQ(census.size(), Census::MAX_ENTRIES);
+
+  uint32_t newcomer = last_home[2];
+  census.record(newcomer, KAM, 27, 22, -70, now++);
+  EXPECT_EQ(census.get_eviction_count(), 1u);
+  EXPECT_FALSE(listed(census, wrapped[0]));
+
+  // Every remaining meter is still found: hearing it again counts, it does
+  // not insert a second entry or evict anything
+  for (size_t i = 1; i < wrapped.size(); i++) {
+    census.record(wrapped[i], KAM, 27, 22, -70, now++);
+  }
+  for (uint32_t id : behind) {
+    census.record(id, KAM, 27, 22, -70, now++);
+  }
+  census.record(newcomer, KAM, 27, 22, -70, now++);
+  EXPECT_EQ(census.size(), Census::MAX_ENTRIES);
+  EXPECT_EQ(census.get_eviction_count(), 1u);
+
+  std::string json;
+  census.to_json(json, now);
+  size_t twice = 0;
+  for (size_t at = json.find("\"count\":2"); at != std::string::npos; at = json.find("\"count\":2", at + 1)) {
+    twice++;
+  }
+  EXPECT_EQ(twice, Census::MAX_ENTRIES);
+}
+
+TEST(Census, WritesEveryMeterAsJson) {
+  Census census;
+  std::string json;
+  census.to_json(json, 0);
+  EXPECT_EQ(json, "[]");
+
+  // No measured RSSI yet (default receive path)
+  census.record(0x12345678, KAM, 27, 22, RSSI_UNKNOWN_DBM, 1000);
+  json.clear();
+  census.to_json(json, 1000);
+  EXPECT_EQ(json, "[{\"id\":\"12345678\",\"mfr\":\"KAM\",\"ver\":27,\"type\":22,\"count\":1,"
+                  "\"age_s\":0,\"interval_s\":0,\"rssi\":null,\"rssi_avg\":null}]");
+
+  // The first measured value starts the average, later ones move it by 1/8
+  census.record(0x12345678, KAM, 27, 22, -71, 17000);
+  census.record(0x12345678, KAM, 27, 22, -79, 33000);
+  census.record(0x00000042, KAM, 1, 7, -60, 40000);
+  json.clear();
+  census.to_json(json, 45000);
+  std::string first = "{\"id\":\"12345678\",\"mfr\":\"KAM\",\"ver\":27,\"type\":22,\"count\":3,"
+                      "\"age_s\":12,\"interval_s\":16,\"rssi\":-79,\"rssi_avg\":-72.0}";
+  std::string second = "{\"id\":\"00000042\",\"mfr\":\"KAM\",\"ver\":1,\"type\":7,\"count\":1,"
+                       "\"age_s\":5,\"interval_s\":0,\"rssi\":-60,\"rssi_avg\":-60.0}";
+  // Slot order, not arrival order
+  EXPECT_TRUE(json == "[" + first + "," + second + "]" || json == "[" + second + "," + first + "]") << json;
+}
@@ -0,0 +1,58 @@
+#include "crc_reference.h"
+#include "test_telegram.h"
+#include "wmbus_crypto.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+
+using namespace esphome::multical21_wmbus;
+
+TEST(Crc, CheckValue) {
+  // Catalogued check value of CRC-16/EN-13757
+  const char *check = "123456789";
+  EXPECT_EQ(WMBusCrypto::calculate_crc(reinterpret_cast<const uint8_t *>(check), 9), 0xC2B7);
+  EXPECT_EQ(wmbus_host::crc_bit_serial(reinterpret_cast<const uint8_t *>(check), 9), 0xC2B7);
+}
+
+TEST(Crc, EmptyInput) { EXPECT_EQ(WMBusCrypto::calculate_crc(nullptr, 0), 0xFFFF); }
+
+TEST(Crc, TableMatchesBitSerialForEverySingleByte) {
+  for (int value = 0; value < 256; value++) {
+    uint8_t byte = static_cast<uint8_t>(value);
+    ASSERT_EQ(WMBusCrypto::calculate_crc(&byte, 1), wmbus_host::crc_bit_serial(&byte, 1)) << "byte " << value;
+  }
+}
+
+TEST(Crc, TableMatchesBitSerialForRandomData) {
+  std::mt19937 rng(13757);
+  uint8_t data[255];
+  for (int round = 0; round < 2000; round++) {
+    uint8_t length = static_cast<uint8_t>(rng() % sizeof(data) + 1);
+    for (uint8_t i = 0; i < length; i++) {
+      data[i] = static_cast<uint8_t>(rng());
+    }
+    ASSERT_EQ(WMBusCrypto::calculate_crc(data, length), wmbus_host::crc_bit_serial(data, length))
+        << "length " << static_cast<int>(length);
+  }
+}
+
+TEST(Crc, ChunkedUpdateMatchesWhole) {
+  uint8_t data[64];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+  for (size_t split = 0; split <= sizeof(data); split++) {
+    uint16_t state = WMBusCrypto::crc_update(WMBusCrypto::CRC_INIT, data, split);
+    state = WMBusCrypto::crc_update(state, &data[split], sizeof(data) - split);
+    ASSERT_EQ(WMBusCrypto::crc_finalize(state), WMBusCrypto::calculate_crc(data, sizeof(data))) << "split " << split;
+  }
+}
+
+TEST(Crc, TelegramTrailerVerifies) {
+  uint8_t frame[MAX_PACKET_SIZE + 1];
+  wmbus_host::build_telegram(frame, wmbus_host::TEST_METER_ID, 7, wmbus_host::TestReading{});
+  uint8_t length = frame[0];
+  uint16_t trailer = (frame[length - 1] << 8) | frame[length];
+  EXPECT_EQ(WMBusCrypto::calculate_crc(frame, length - 1), trailer);
+  EXPECT_EQ(wmbus_host::crc_bit_serial(frame, length - 1), trailer);
+}
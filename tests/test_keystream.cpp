@@ -0,0 +1,114 @@
+#include "test_telegram.h"
+#include "wmbus_crypto.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+struct Telegram {
+  uint8_t frame[MAX_PACKET_SIZE + 1];
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length;
+};
+
+Telegram make(uint8_t access_number, bool long_frame) {
+  Telegram telegram{};
+  wmbus_host::TestReading reading;
+  reading.long_frame = long_frame;
+  reading.total_liters = 1000u + access_number;
+  wmbus_host::build_telegram(telegram.frame, wmbus_host::TEST_METER_ID, access_number, reading);
+  return telegram;
+}
+
+// Decrypts and checks the plaintext against a context without prediction
+bool decrypt(WMBusCrypto &crypto, Telegram &telegram) {
+  EXPECT_TRUE(crypto.decrypt_packet(telegram.frame, telegram.frame[0], telegram.plaintext,
+                                    telegram.plaintext_length));
+  WMBusCrypto reference;
+  reference.set_key(wmbus_host::TEST_KEY);
+  uint8_t expected[MAX_PACKET_SIZE];
+  uint8_t expected_length = 0;
+  reference.decrypt_packet(telegram.frame, telegram.frame[0], expected, expected_length);
+  EXPECT_EQ(telegram.plaintext_length, expected_length);
+  EXPECT_EQ(memcmp(telegram.plaintext, expected, expected_length), 0);
+  return crypto.last_decrypt_was_hit();
+}
+
+void predict(WMBusCrypto &crypto, const Telegram &telegram) {
+  crypto.predict_next(telegram.frame);
+  crypto.precompute_keystream();
+}
+
+}  // namespace
+
+TEST(Keystream, NextAccessNumberIsAHit) {
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  Telegram first = make(10, false);
+  EXPECT_FALSE(decrypt(crypto, first));
+  predict(crypto, first);
+
+  Telegram next = make(11, false);
+  EXPECT_TRUE(decrypt(crypto, next));
+  EXPECT_EQ(crypto.get_keystream_hits(), 1u);
+}
+
+TEST(Keystream, AccessNumberWrapsLikeTheMeter) {
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  Telegram last = make(255, false);
+  predict(crypto, last);
+
+  Telegram wrapped = make(0, false);
+  EXPECT_TRUE(decrypt(crypto, wrapped));
+}
+
+TEST(Keystream, SlotsGrowToTheLongestFrameSeen) {
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+
+  // Slots sized for compact frames cannot serve a long one
+  predict(crypto, make(1, false));
+  Telegram long_frame = make(2, true);
+  EXPECT_FALSE(decrypt(crypto, long_frame));
+  EXPECT_EQ(crypto.get_keystream_misses(), 1u);
+
+  // Once a long frame was seen, both frame types hit
+  predict(crypto, long_frame);
+  Telegram compact = make(3, false);
+  EXPECT_TRUE(decrypt(crypto, compact));
+  predict(crypto, compact);
+  Telegram long_again = make(4, true);
+  EXPECT_TRUE(decrypt(crypto, long_again));
+}
+
+TEST(Keystream, TelegramLongerThanTheSlotsIsNotPredicted) {
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  Telegram telegram = make(5, true);
+  telegram.frame[0] = OFFSET_CIPHER_START - 1 + KEYSTREAM_MAX_SIZE + 1 + CRC_SIZE;
+
+  crypto.predict_next(telegram.frame);
+  EXPECT_FALSE(crypto.is_precompute_pending());
+  Telegram next = make(6, true);
+  EXPECT_FALSE(decrypt(crypto, next));
+  EXPECT_EQ(crypto.get_keystream_misses(), 0u);  // No prediction, no miss
+}
+
+TEST(Keystream, SlotsDoNotScaleWithTheMaximumPacketSize) {
+  // Long Multical21 frames fit; the rest of a MAX_PACKET_SIZE frame does not cost RAM per meter
+  EXPECT_GE(KEYSTREAM_MAX_SIZE, wmbus_host::LONG_PLAINTEXT_SIZE);
+  EXPECT_LE(KEYSTREAM_MAX_SIZE, 32);
+}
+
+TEST(Keystream, NewKeyDropsThePrediction) {
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  predict(crypto, make(7, false));
+  crypto.set_key(wmbus_host::TEST_KEY);
+
+  Telegram next = make(8, false);
+  EXPECT_FALSE(decrypt(crypto, next));
+}
@@ -0,0 +1,82 @@
+#include "wmbus_latency.h"
+#include <gtest/gtest.h>
+
+using namespace esphome::multical21_wmbus;
+
+TEST(LatencyHistogram, EmptyHistogramReportsZero) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.get_count(), 0u);
+  EXPECT_EQ(histogram.percentile(1), 0u);
+  EXPECT_EQ(histogram.percentile(50), 0u);
+  EXPECT_EQ(histogram.percentile(99), 0u);
+  EXPECT_EQ(histogram.percentile(100), 0u);
+}
+
+TEST(LatencyHistogram, BucketsAreHalfOpenPowersOfTwo) {
+  struct Case {
+    uint32_t cycles;
+    uint8_t bucket;
+  };
+  const Case cases[] = {
+      {0, 0}, {1, 1}, {2, 2}, {3, 2}, {4, 3}, {7, 3}, {8, 4},
+      {1023, 10}, {1024, 11}, {0x7FFFFFFF, 31}, {0x80000000, 32}, {0xFFFFFFFF, 32},
+  };
+  for (const Case &c : cases) {
+    LatencyHistogram histogram;
+    histogram.record(c.cycles);
+    EXPECT_EQ(histogram.get_bucket(c.bucket), 1u) << c.cycles;
+    EXPECT_LE(c.cycles, LatencyHistogram::bucket_upper_bound(c.bucket));
+    if (c.bucket > 0) {
+      EXPECT_GT(c.cycles, LatencyHistogram::bucket_upper_bound(c.bucket - 1));
+    }
+  }
+  EXPECT_EQ(LatencyHistogram::bucket_upper_bound(0), 0u);
+  EXPECT_EQ(LatencyHistogram::bucket_upper_bound(32), 0xFFFFFFFFu);
+}
+
+TEST(LatencyHistogram, PercentileIsTheBucketBoundCappedAtTheMaximum) {
+  LatencyHistogram histogram;
+  histogram.record(5);
+  // Bucket [4, 8) would say 7, but nothing above 5 was seen
+  EXPECT_EQ(histogram.percentile(50), 5u);
+  EXPECT_EQ(histogram.percentile(1), 5u);
+
+  histogram.record(0);
+  EXPECT_EQ(histogram.percentile(50), 0u);  // Rank 1 of 2
+  EXPECT_EQ(histogram.percentile(51), 5u);  // Rank 2 of 2
+
+  histogram.record(9);
+  EXPECT_EQ(histogram.percentile(66), 7u);   // Rank 2 of 3: bound of [4, 8)
+  EXPECT_EQ(histogram.percentile(100), 9u);  // Bound of [8, 16) capped at 9
+  EXPECT_EQ(histogram.get_max(), 9u);
+}
+
+TEST(LatencyHistogram, RankIsRoundedUp) {
+  // 98 fast samples and 2 slow ones: p98 is still fast, p99 is not
+  LatencyHistogram histogram;
+  for (int i = 0; i < 98; i++) {
+    histogram.record(10);
+  }
+  histogram.record(1000);
+  histogram.record(1000);
+  EXPECT_EQ(histogram.get_count(), 100u);
+  EXPECT_EQ(histogram.percentile(50), 15u);
+  EXPECT_EQ(histogram.percentile(98), 15u);
+  EXPECT_EQ(histogram.percentile(99), 1000u);
+
+  // One more fast sample: p98 is rank 99 of 101, the last fast one
+  histogram.record(10);
+  EXPECT_EQ(histogram.percentile(98), 15u);
+  EXPECT_EQ(histogram.percentile(99), 1000u);  // ceil(101 * 0.99) = 100
+}
+
+TEST(LatencyHistogram, StagesAreKeptApart) {
+  WMBusLatencyStats stats;
+  stats.record(LatencyStage::CRC, 100);
+  stats.record(LatencyStage::AES, 5000);
+  stats.record(LatencyStage::AES, 6000);
+  EXPECT_EQ(stats.get(LatencyStage::CRC).get_count(), 1u);
+  EXPECT_EQ(stats.get(LatencyStage::AES).get_count(), 2u);
+  EXPECT_EQ(stats.get(LatencyStage::AES).percentile(50), 6000u);  // [4096, 8192) capped at 6000
+  EXPECT_EQ(stats.get(LatencyStage::TOTAL).percentile(99), 0u);
+}
@@ -0,0 +1,34 @@
+// Built with a table of consecutive and scattered IDs (see CMakeLists.txt)
+
+#include "wmbus_meter_table.h"
+#include <gtest/gtest.h>
+
+using namespace esphome::multical21_wmbus;
+
+TEST(MeterTable, FindsEveryConfiguredMeter) {
+  for (size_t i = 0; i < METER_COUNT; i++) {
+    EXPECT_EQ(find_meter_index(METER_IDS[i]), static_cast<int>(i)) << std::hex << METER_IDS[i];
+  }
+}
+
+TEST(MeterTable, RejectsOtherMeters) {
+  for (size_t i = 0; i < METER_COUNT; i++) {
+    uint32_t neighbour = METER_IDS[i] + 1;
+    if (i + 1 < METER_COUNT && METER_IDS[i + 1] == neighbour) {
+      continue;
+    }
+    EXPECT_EQ(find_meter_index(neighbour), -1) << std::hex << neighbour;
+  }
+  EXPECT_EQ(find_meter_index(0x00000000), -1);
+  EXPECT_EQ(find_meter_index(0xFFFFFFFF), -1);
+}
+
+TEST(MeterTable, LookupIsConstexpr) {
+  static_assert(find_meter_index(METER_IDS[METER_COUNT - 1]) == static_cast<int>(METER_COUNT - 1), "");
+  static_assert(METER_HASH_SIZE >= 2 * METER_COUNT, "");
+}
+
+TEST(MeterTable, DecodesLittleEndianAField) {
+  const uint8_t a_field[4] = {0x78, 0x56, 0x34, 0x12};
+  EXPECT_EQ(meter_id_from_le(a_field), 0x12345678u);
+}
@@ -0,0 +1,105 @@
+#include "wmbus_mode_scheduler.h"
+#include <gtest/gtest.h>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint32_t INTERVAL_MS = 16000;
+
+// Two captures one interval apart: interval learned
+void learn(WMBusModeScheduler &scheduler, uint32_t start_ms, uint8_t access_number) {
+  scheduler.record(0, start_ms, access_number);
+  scheduler.record(0, start_ms + INTERVAL_MS, static_cast<uint8_t>(access_number + 1));
+}
+
+}  // namespace
+
+TEST(ModeScheduler, LearnsTheIntervalFromTheFirstGap) {
+  WMBusModeScheduler scheduler;
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, 0u);
+  learn(scheduler, 1000, 10);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS);
+  EXPECT_EQ(scheduler.get_entry(0).captures, 2u);
+}
+
+TEST(ModeScheduler, GapsSpanningMissesKeepTheInterval) {
+  WMBusModeScheduler scheduler;
+  learn(scheduler, 1000, 10);
+  // Two and three intervals: telegrams 12, 14 missed
+  scheduler.record(0, 1000 + 3 * INTERVAL_MS, 13);
+  scheduler.record(0, 1000 + 6 * INTERVAL_MS, 16);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS);
+}
+
+TEST(ModeScheduler, IgnoresRepeatedCopies) {
+  WMBusModeScheduler scheduler;
+  learn(scheduler, 1000, 10);
+  uint32_t last_ms = 1000 + INTERVAL_MS;
+
+  // Repeater copy of telegram 11, 300 ms later
+  EXPECT_FALSE(scheduler.record(0, last_ms + 300, 11));
+  // Different access number, but closer than any real interval
+  EXPECT_FALSE(scheduler.record(0, last_ms + 400, 99));
+
+  const ScheduleEntry &entry = scheduler.get_entry(0);
+  EXPECT_EQ(entry.interval_ms, INTERVAL_MS);
+  EXPECT_EQ(entry.last_seen_ms, last_ms);
+  EXPECT_EQ(entry.captures, 2u);
+  EXPECT_EQ(scheduler.get_ignored_count(), 2u);
+
+  // The next real telegram is measured from the original
+  EXPECT_TRUE(scheduler.record(0, last_ms + INTERVAL_MS, 12));
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS);
+}
+
+TEST(ModeScheduler, SameAccessNumberAfterWrapIsNotACopy) {
+  WMBusModeScheduler scheduler;
+  learn(scheduler, 1000, 10);
+  // 256 telegrams later the access number comes round again
+  EXPECT_TRUE(scheduler.record(0, 1000 + 257 * INTERVAL_MS, 11));
+  EXPECT_EQ(scheduler.get_ignored_count(), 0u);
+}
+
+TEST(ModeScheduler, OneShortGapDoesNotReplaceTheInterval) {
+  WMBusModeScheduler scheduler;
+  learn(scheduler, 1000, 10);
+  uint32_t now = 1000 + INTERVAL_MS;
+
+  // A stray telegram 5 s after the last one
+  now += 5000;
+  scheduler.record(0, now, 12);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS);
+
+  // Back on the beat: the next gap is not short, the candidate is dropped
+  now += INTERVAL_MS - 5000;
+  scheduler.record(0, now, 13);
+  now += 5000;
+  scheduler.record(0, now, 14);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS);
+}
+
+TEST(ModeScheduler, ConfirmedShortGapReplacesTheInterval) {
+  WMBusModeScheduler scheduler;
+  // First gap spanned a missed telegram: 32 s learned for a 16 s meter
+  scheduler.record(0, 1000, 10);
+  scheduler.record(0, 1000 + 2 * INTERVAL_MS, 12);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, 2 * INTERVAL_MS);
+
+  uint32_t now = 1000 + 2 * INTERVAL_MS;
+  scheduler.record(0, now += INTERVAL_MS, 13);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, 2 * INTERVAL_MS);
+  scheduler.record(0, now += INTERVAL_MS + 40, 14);
+  EXPECT_EQ(scheduler.get_entry(0).interval_ms, INTERVAL_MS + 40);
+}
+
+TEST(ModeScheduler, CaptureRateCountsIgnoredCopiesOnce) {
+  WMBusModeScheduler scheduler;
+  uint32_t now = 1000;
+  for (uint8_t access_number = 0; access_number < 10; access_number++, now += INTERVAL_MS) {
+    scheduler.record(0, now, access_number);
+    scheduler.record(0, now + 200, access_number);  // Every telegram also via a repeater
+  }
+  EXPECT_FLOAT_EQ(scheduler.get_capture_rate(RadioMode::C1, now - INTERVAL_MS + 100), 100.0f);
+  EXPECT_EQ(scheduler.get_entry(0).captures, 10u);
+}
@@ -0,0 +1,201 @@
+#include "wmbus_packet_buffer.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint32_t STRESS_PACKETS = 200000;
+
+// Sequence number in the first four bytes, the rest derived from it so a
+// slot read while the producer writes it shows up as a mismatch
+void fill_packet(uint8_t *data, uint16_t &length, uint32_t seq) {
+  length = static_cast<uint16_t>(8 + seq % (MAX_PACKET_SIZE - 7));
+  memcpy(data, &seq, sizeof(seq));
+  for (uint16_t i = sizeof(seq); i < length; i++) {
+    data[i] = static_cast<uint8_t>(seq * 31 + i);
+  }
+}
+
+bool check_packet(const PacketBuffer &packet, uint32_t &seq) {
+  memcpy(&seq, packet.data, sizeof(seq));
+  if (packet.length != 8 + seq % (MAX_PACKET_SIZE - 7) || packet.timestamp != seq) {
+    return false;
+  }
+  for (uint16_t i = sizeof(seq); i < packet.length; i++) {
+    if (packet.data[i] != static_cast<uint8_t>(seq * 31 + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(PacketBuffer, DropsWhenFullAndCountsThem) {
+  WMBusPacketBuffer<4> ring;
+  PacketBuffer packet{};
+  for (uint32_t seq = 0; seq < 4; seq++) {
+    fill_packet(packet.data, packet.length, seq);
+    packet.timestamp = seq;
+    EXPECT_TRUE(ring.push(packet));
+  }
+  EXPECT_TRUE(ring.is_full());
+  EXPECT_FALSE(ring.push(packet));
+  EXPECT_EQ(ring.reserve(), nullptr);
+  EXPECT_EQ(ring.get_drop_count(), 2u);
+  EXPECT_EQ(ring.get_high_water_mark(), 4u);
+
+  PacketBuffer out{};
+  for (uint32_t expected = 0; expected < 4; expected++) {
+    uint32_t seq;
+    ASSERT_TRUE(ring.pop(out));
+    ASSERT_TRUE(check_packet(out, seq));
+    EXPECT_EQ(seq, expected);
+  }
+  EXPECT_FALSE(ring.pop(out));
+  EXPECT_TRUE(ring.is_empty());
+}
+
+TEST(PacketBuffer, HighWaterMarkKeepsPeak) {
+  WMBusPacketBuffer<8> ring;
+  PacketBuffer packet{};
+  packet.length = 1;
+  for (int i = 0; i < 3; i++) {
+    ring.push(packet);
+  }
+  PacketBuffer out{};
+  while (ring.pop(out)) {
+  }
+  ring.push(packet);
+  EXPECT_EQ(ring.get_high_water_mark(), 3u);
+  EXPECT_EQ(ring.size(), 1u);
+  EXPECT_EQ(ring.get_drop_count(), 0u);
+}
+
+TEST(PacketBuffer, IndicesWrapAround) {
+  WMBusPacketBuffer<4> ring;
+  PacketBuffer packet{};
+  PacketBuffer out{};
+  for (uint32_t seq = 0; seq < 1000; seq++) {
+    fill_packet(packet.data, packet.length, seq);
+    packet.timestamp = seq;
+    ASSERT_TRUE(ring.push(packet));
+    uint32_t got;
+    ASSERT_TRUE(ring.pop(out));
+    ASSERT_TRUE(check_packet(out, got));
+    ASSERT_EQ(got, seq);
+  }
+  EXPECT_EQ(ring.get_high_water_mark(), 1u);
+}
+
+// Producer retries until every packet is in: nothing may be lost or
+// reordered, and every failed attempt is a counted drop
+TEST(PacketBufferStress, RetryingProducerLosesNothing) {
+  WMBusPacketBuffer<4> ring;
+  uint32_t failed_pushes = 0;
+
+  std::thread producer([&] {
+    PacketBuffer packet{};
+    for (uint32_t seq = 0; seq < STRESS_PACKETS; seq++) {
+      // Alternate the copying and in-place producer paths
+      if (seq % 2 == 0) {
+        fill_packet(packet.data, packet.length, seq);
+        packet.timestamp = seq;
+        while (!ring.push(packet)) {
+          failed_pushes++;
+          std::this_thread::yield();
+        }
+      } else {
+        PacketBuffer *slot;
+        while ((slot = ring.reserve()) == nullptr) {
+          failed_pushes++;
+          std::this_thread::yield();
+        }
+        uint16_t length;
+        fill_packet(slot->data, length, seq);
+        ring.commit(length, seq);
+      }
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t corrupt = 0;
+  uint32_t out_of_order = 0;
+  PacketBuffer out{};
+  while (expected < STRESS_PACKETS) {
+    uint32_t seq;
+    bool ok;
+    if (expected % 3 == 0) {
+      if (!ring.pop(out)) {
+        std::this_thread::yield();
+        continue;
+      }
+      ok = check_packet(out, seq);
+    } else {
+      const PacketBuffer *slot = ring.peek();
+      if (slot == nullptr) {
+        std::this_thread::yield();
+        continue;
+      }
+      ok = check_packet(*slot, seq);
+      ring.release();
+    }
+    corrupt += ok ? 0 : 1;
+    out_of_order += seq == expected ? 0 : 1;
+    expected = seq + 1;
+  }
+  producer.join();
+
+  EXPECT_EQ(corrupt, 0u);
+  EXPECT_EQ(out_of_order, 0u);
+  EXPECT_TRUE(ring.is_empty());
+  EXPECT_EQ(ring.get_drop_count(), failed_pushes);
+  EXPECT_GE(ring.get_high_water_mark(), 1u);
+  EXPECT_LE(ring.get_high_water_mark(), 4u);
+}
+
+// Producer never waits, like the ISR: whatever arrives is in order and
+// intact, and received + dropped accounts for every packet
+TEST(PacketBufferStress, DroppingProducerAccountsForEveryPacket) {
+  WMBusPacketBuffer<4> ring;
+  uint32_t rejected = 0;
+
+  std::thread producer([&] {
+    PacketBuffer packet{};
+    for (uint32_t seq = 0; seq < STRESS_PACKETS; seq++) {
+      fill_packet(packet.data, packet.length, seq);
+      packet.timestamp = seq;
+      rejected += ring.push(packet) ? 0 : 1;
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t corrupt = 0;
+  uint32_t out_of_order = 0;
+  int64_t last_seq = -1;
+  PacketBuffer out{};
+  auto drain = [&] {
+    uint32_t seq;
+    while (ring.pop(out)) {
+      corrupt += check_packet(out, seq) ? 0 : 1;
+      out_of_order += static_cast<int64_t>(seq) > last_seq ? 0 : 1;
+      last_seq = seq;
+      received++;
+    }
+  };
+  while (last_seq + 1 < static_cast<int64_t>(STRESS_PACKETS) && received + ring.get_drop_count() < STRESS_PACKETS) {
+    drain();
+    std::this_thread::yield();
+  }
+  producer.join();
+  drain();
+
+  EXPECT_EQ(corrupt, 0u);
+  EXPECT_EQ(out_of_order, 0u);
+  EXPECT_EQ(ring.get_drop_count(), rejected);
+  EXPECT_EQ(received + ring.get_drop_count(), STRESS_PACKETS);
+  EXPECT_LE(ring.get_high_water_mark(), 4u);
+}
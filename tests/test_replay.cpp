@@ -0,0 +1,173 @@
+#include "replay_harness.h"
+#include <gtest/gtest.h>
+
+using namespace wmbus_host;
+
+namespace {
+
+constexpr ReplayRxPath RX_PATHS[] = {ReplayRxPath::PACKET, ReplayRxPath::CONTINUOUS_RX, ReplayRxPath::FIFO_STREAMING};
+
+}  // namespace
+
+TEST(Replay, EveryTelegramIsPublishedAtOnePerSecond) {
+  for (ReplayRxPath rx_path : RX_PATHS) {
+    SCOPED_TRACE(replay_rx_path_to_string(rx_path));
+    ReplayConfig config;
+    config.rx_path = rx_path;
+    config.telegrams = 100;
+    config.foreign_every = 5;
+    ReplayReport report = run_replay(config);
+
+    EXPECT_EQ(report.telegrams_sent, 80u);
+    EXPECT_EQ(report.published, 80u);
+    EXPECT_EQ(report.lost, 0u);
+    EXPECT_EQ(report.duplicate_publishes, 0u);
+    EXPECT_EQ(report.warnings, 0u);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(report.syncs, 100u);
+    EXPECT_EQ(report.fifo_underflows, 0u);
+    EXPECT_EQ(report.clock_edges, 0u);
+
+    // One interrupt per telegram on GDO0 (plus GDO2 thresholds for long ones)
+    EXPECT_EQ(report.gdo0_interrupts, 100u);
+    EXPECT_EQ(report.interrupt_to_publish.samples, 80u);
+    EXPECT_EQ(report.air_end_to_publish.samples, 80u);
+    EXPECT_GT(report.air_end_to_publish.p50_us, 0u);
+    EXPECT_LT(report.air_end_to_publish.max_us, 10000u);
+
+    // The receive path, meters and sensors included, stays off the heap
+    EXPECT_EQ(report.allocations, 0u);
+  }
+}
+
+TEST(Replay, RegisterRecoveryDoesNotStormTheInterrupt) {
+  for (ReplayRxPath rx_path : RX_PATHS) {
+    SCOPED_TRACE(replay_rx_path_to_string(rx_path));
+    ReplayConfig config;
+    config.rx_path = rx_path;
+    config.telegrams = 80;
+    config.upset_at_ms = 20500;  // Found by the register check at 60 s
+    ReplayReport report = run_replay(config);
+
+    // SRES turns the clock output on until the IOCFG rewrite goes through
+    // once the chip has finished its reset (VirtualCC1101::RESET_BUSY_NS):
+    // ~14 edges for the reset, ~14 per rewrite attempt. Without the rewrite
+    // it would run until configure_() 10 ms later, ~2700 edges
+    EXPECT_GT(report.clock_edges, 0u);
+    EXPECT_LT(report.clock_edges, 40u);
+    EXPECT_LT(report.gdo0_interrupts, 80u + 40u);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(report.warnings, 1u);  // The check's mismatch, found although a telegram just restarted RX
+    EXPECT_EQ(report.lost, 0u);  // Frequency is not modelled; the restart itself costs nothing
+  }
+}
+
+TEST(Replay, RxRestartIsPolledUntilTheRadioIsBack) {
+  // Four telegrams 6 ms apart: each restart must be seen through before the
+  // next one arrives, and a telegram that fills the FIFO before the state
+  // machine has looked again still counts as RX reached
+  for (ReplayRxPath rx_path : RX_PATHS) {
+    SCOPED_TRACE(replay_rx_path_to_string(rx_path));
+    ReplayConfig config;
+    config.rx_path = rx_path;
+    config.telegrams = 200;
+    config.burst_size = 4;
+    config.burst_gap_us = 6000;
+    ReplayReport report = run_replay(config);
+
+    EXPECT_EQ(report.lost, 0u);
+    EXPECT_EQ(report.warnings, 0u);
+    EXPECT_EQ(report.errors, 0u);
+  }
+}
+
+TEST(Replay, ContinuousRxKeepsBackToBackTelegrams) {
+  ReplayConfig config;
+  config.rx_path = ReplayRxPath::CONTINUOUS_RX;
+  config.telegrams = 200;
+  config.burst_size = 4;
+  config.burst_gap_us = 2000;  // Longer than the fixed frame's padding after a compact telegram
+  config.long_every = 0;
+  ReplayReport report = run_replay(config);
+
+  EXPECT_EQ(report.lost, 0u);
+  EXPECT_EQ(report.fifo_overflows, 0u);
+  EXPECT_EQ(report.errata_duplicates, 0u);
+  EXPECT_EQ(report.allocations, 0u);
+}
+
+TEST(Replay, RestartAfterEachTelegramMissesTightBursts) {
+  ReplayConfig config;
+  config.rx_path = ReplayRxPath::FIFO_STREAMING;
+  config.telegrams = 200;
+  config.burst_size = 4;
+  config.burst_gap_us = 300;  // Shorter than IDLE -> RX with calibration
+  ReplayReport report = run_replay(config);
+
+  EXPECT_GT(report.lost, 0u);
+  EXPECT_GT(report.late_rx + report.missed, 0u);
+  EXPECT_EQ(report.published + report.lost, report.telegrams_sent);
+}
+
+TEST(Replay, SameSeedSameReport) {
+  ReplayConfig config;
+  config.telegrams = 50;
+  config.timing.wake_model = SimWakeModel::SLOW;
+  config.timing.seed = 7;
+  ReplayReport first = run_replay(config);
+  ReplayReport second = run_replay(config);
+  EXPECT_EQ(first.published, second.published);
+  EXPECT_EQ(first.air_end_to_publish.p50_us, second.air_end_to_publish.p50_us);
+  EXPECT_EQ(first.air_end_to_publish.max_us, second.air_end_to_publish.max_us);
+  EXPECT_EQ(first.spi_transactions, second.spi_transactions);
+
+  config.timing.seed = 8;
+  ReplayReport other = run_replay(config);
+  EXPECT_NE(first.air_end_to_publish.max_us, other.air_end_to_publish.max_us);
+}
+
+TEST(Replay, DecodeOptionsPublishWhatTheDefaultPathDoes) {
+  // early_reject, pipelined_decode and keystream_prediction one at a time
+  // and all together, against the same traffic without them
+  for (ReplayRxPath rx_path : RX_PATHS) {
+    SCOPED_TRACE(replay_rx_path_to_string(rx_path));
+    ReplayConfig config;
+    config.rx_path = rx_path;
+    config.telegrams = 120;
+    config.foreign_every = 3;
+    config.long_every = 4;
+    ReplayReport baseline = run_replay(config);
+    ASSERT_EQ(baseline.lost, 0u);
+    ASSERT_EQ(baseline.unmatched_publishes, 0u);
+
+    for (int option = 0; option < 4; option++) {
+      ReplayConfig variant = config;
+      variant.early_reject = option == 0 || option == 3;
+      variant.pipelined_decode = option == 1 || option == 3;
+      variant.keystream_prediction = option == 2 || option == 3;
+      SCOPED_TRACE(::testing::Message() << "early_reject " << variant.early_reject << ", pipelined_decode "
+                                        << variant.pipelined_decode << ", keystream_prediction "
+                                        << variant.keystream_prediction);
+      ReplayReport report = run_replay(variant);
+
+      // Every telegram decodes to the value it was built with, as without the option
+      EXPECT_EQ(report.published, baseline.published);
+      EXPECT_EQ(report.lost, 0u);
+      EXPECT_EQ(report.duplicate_publishes, 0u);
+      EXPECT_EQ(report.unmatched_publishes, 0u);
+      EXPECT_EQ(report.warnings, 0u);
+      EXPECT_EQ(report.errors, 0u);
+      EXPECT_EQ(report.allocations, 0u);
+
+      // ... and the option did take effect: foreign telegrams are flushed
+      // after the A-field (continuous RX drains every frame anyway), and
+      // all but each meter's first two telegrams hit a predicted keystream
+      if (variant.early_reject && rx_path != ReplayRxPath::CONTINUOUS_RX) {
+        EXPECT_LT(report.fifo_bytes_read, baseline.fifo_bytes_read);
+      } else {
+        EXPECT_EQ(report.fifo_bytes_read, baseline.fifo_bytes_read);
+      }
+      EXPECT_EQ(report.keystream_hits, variant.keystream_prediction ? report.published - 4 : 0u);
+    }
+  }
+}
@@ -0,0 +1,259 @@
+#include "wmbus_mode_scheduler.h"
+#include "wmbus_rx_window.h"
+#include <gtest/gtest.h>
+#include <set>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint32_t STEP_MS = 10;
+constexpr uint32_t CAPTURE_DELAY_MS = 50;  // Airtime plus FIFO read, within RX_WINDOW_SETTLE_MS
+constexpr uint32_t GUARD_MS = 500;
+
+/**
+ * One meter and the radio on a simulated millisecond clock
+ *
+ * The radio follows the component's update_rx_window_(): it wakes when a
+ * window opens within RX_WINDOW_WAKE_LEAD_MS and powers down when the next
+ * one is further off than the wake lead plus RX_WINDOW_MIN_OFF_MS. A
+ * telegram is captured if the radio listens when it is sent.
+ */
+class RxWindowSim {
+ public:
+  explicit RxWindowSim(uint32_t interval_ms) : interval_ms_(interval_ms) { this->window.set_guard_ms(GUARD_MS); }
+
+  void run_until(uint32_t end_ms) {
+    for (; this->now < end_ms; this->now += STEP_MS) {
+      this->step_();
+    }
+  }
+
+  /// Run until the meter has sent count more telegrams and the last one was handled
+  void run_telegrams(uint32_t count) {
+    uint32_t target = this->sent_ + count;
+    while (this->sent_ < target || this->capture_pending_) {
+      this->step_();
+      this->now += STEP_MS;
+    }
+  }
+
+  void skip_telegram(uint32_t number) { this->skipped_.insert(number); }
+  void set_interval_ms(uint32_t interval_ms) { this->interval_ms_ = interval_ms; }
+
+  uint32_t sent() const { return this->sent_; }
+  uint32_t captured() const { return this->captured_; }
+  uint32_t lost() const { return this->lost_; }
+  uint32_t listened_ms() const { return this->listened_ms_; }
+  uint32_t learned_interval_ms() const { return this->scheduler.get_entry(0).interval_ms; }
+
+  WMBusModeScheduler scheduler;
+  WMBusRxWindow window;
+  uint32_t now{1000};
+  bool listening{true};
+  uint32_t opens_in{0};
+
+ protected:
+  void step_() {
+    if (static_cast<int32_t>(this->now - this->next_tx_ms_) >= 0) {
+      uint32_t number = this->sent_++;
+      if (this->skipped_.count(number) != 0) {
+        // Meter did not send this one
+      } else if (this->listening) {
+        this->capture_ms_ = this->now + CAPTURE_DELAY_MS;
+        this->capture_access_number_ = static_cast<uint8_t>(number);
+        this->capture_pending_ = true;
+      } else {
+        this->lost_++;
+      }
+      // Transmit jitter of up to +-40 ms
+      this->next_tx_ms_ += this->interval_ms_ + (number * 37) % 81 - 40;
+    }
+    if (this->capture_pending_ && static_cast<int32_t>(this->now - this->capture_ms_) >= 0) {
+      this->capture_pending_ = false;
+      this->captured_++;
+      this->scheduler.record(0, this->capture_ms_, this->capture_access_number_);
+    }
+
+    this->window.account(this->now, this->listening);
+    this->listened_ms_ += this->listening ? STEP_MS : 0;
+    this->opens_in = this->window.update(this->scheduler, this->now);
+    if (!this->listening && this->opens_in <= RX_WINDOW_WAKE_LEAD_MS) {
+      this->listening = true;
+    } else if (this->listening && !this->capture_pending_ &&
+               this->opens_in > RX_WINDOW_WAKE_LEAD_MS + RX_WINDOW_MIN_OFF_MS) {
+      this->listening = false;
+    }
+  }
+
+  uint32_t interval_ms_;
+  uint32_t next_tx_ms_{5000};
+  uint32_t sent_{0};
+  uint32_t captured_{0};
+  uint32_t lost_{0};
+  uint32_t listened_ms_{0};
+  uint32_t capture_ms_{0};
+  uint8_t capture_access_number_{0};
+  bool capture_pending_{false};
+  std::set<uint32_t> skipped_;
+};
+
+}  // namespace
+
+TEST(RxWindow, ListensUntilTheIntervalIsLearned) {
+  RxWindowSim sim(16000);
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 1000);
+  EXPECT_TRUE(sim.listening);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), 0u);
+
+  // Second capture arms the window with the configured guard
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 1000);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), GUARD_MS);
+  EXPECT_FALSE(sim.listening);
+  EXPECT_GT(sim.opens_in, 10000u);
+}
+
+TEST(RxWindow, CatchesEveryTelegramOfASteadyMeter) {
+  RxWindowSim sim(16000);
+  sim.run_telegrams(100);
+
+  EXPECT_EQ(sim.lost(), 0u);
+  EXPECT_EQ(sim.window.get_misses(), 0u);
+  // Two captures learn the interval, every later one is a window hit
+  EXPECT_EQ(sim.window.get_hits(), sim.captured() - 2);
+  EXPECT_FLOAT_EQ(sim.window.get_hit_rate(), 100.0f);
+  // A 1.1 s window every 16 s
+  EXPECT_LT(sim.window.get_duty_cycle(), 12.0f);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), GUARD_MS);
+}
+
+TEST(RxWindow, MissDoublesTheGuardAndHitsShrinkItBack) {
+  RxWindowSim sim(16000);
+  sim.run_telegrams(5);
+  sim.skip_telegram(sim.sent());
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 2000);  // Window closes
+
+  EXPECT_EQ(sim.window.get_misses(), 1u);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), 2 * GUARD_MS);
+
+  // The next telegram is still caught in its (wider) window
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 1000);
+  EXPECT_EQ(sim.window.get_misses(), 1u);
+  uint32_t after_one_hit = sim.window.get_widest_guard_ms();
+  EXPECT_LT(after_one_hit, 2 * GUARD_MS);
+  EXPECT_GT(after_one_hit, GUARD_MS);
+
+  // 1/32 of the excess per hit: back at the configured guard
+  sim.run_telegrams(300);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), GUARD_MS);
+  EXPECT_EQ(sim.lost(), 0u);
+}
+
+TEST(RxWindow, GuardNeverExceedsAQuarterInterval) {
+  RxWindowSim sim(3000);
+  sim.run_telegrams(5);
+  sim.skip_telegram(sim.sent());
+  sim.skip_telegram(sim.sent() + 1);
+  sim.run_telegrams(2);
+  sim.run_until(sim.now + 1500);
+
+  // 500 -> 1000 would exceed 3000 / 4
+  EXPECT_EQ(sim.window.get_misses(), 2u);
+  EXPECT_EQ(sim.window.get_widest_guard_ms(), sim.learned_interval_ms() / RX_WINDOW_MAX_GUARD_DIVISOR);
+}
+
+TEST(RxWindow, ConfiguredGuardAboveAQuarterIntervalIsClamped) {
+  RxWindowSim sim(16000);
+  sim.window.set_guard_ms(5000);
+  sim.run_telegrams(5);
+  EXPECT_NEAR(sim.window.get_widest_guard_ms(), 16000 / RX_WINDOW_MAX_GUARD_DIVISOR, 50);
+
+  // A miss cannot widen it further, and hits afterwards are not misread as
+  // misses by shrinking towards the larger configured guard
+  sim.skip_telegram(sim.sent());
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 5000);
+  EXPECT_EQ(sim.window.get_misses(), 1u);
+  sim.run_telegrams(50);
+  EXPECT_EQ(sim.window.get_misses(), 1u);
+  EXPECT_EQ(sim.window.get_hits(), sim.captured() - 2);
+  EXPECT_EQ(sim.lost(), 0u);
+  EXPECT_NEAR(sim.window.get_widest_guard_ms(), 16000 / RX_WINDOW_MAX_GUARD_DIVISOR, 50);
+}
+
+TEST(RxWindow, RelearnsAfterConsecutiveMisses) {
+  RxWindowSim sim(16000);
+  sim.run_telegrams(5);
+  uint32_t first_silent = sim.sent();
+  for (uint32_t i = 0; i < RX_WINDOW_RELEARN_MISSES + 2; i++) {
+    sim.skip_telegram(first_silent + i);
+  }
+
+  // Radio stays on from the last judged miss until the meter is heard again;
+  // by then the guard has doubled to 4 s
+  sim.run_telegrams(RX_WINDOW_RELEARN_MISSES);
+  sim.run_until(sim.now + 4500);
+  EXPECT_EQ(sim.window.get_misses(), RX_WINDOW_RELEARN_MISSES);
+  uint32_t listened_before = sim.listened_ms();
+  uint32_t silent_from = sim.now;
+  sim.run_telegrams(2);
+  EXPECT_TRUE(sim.listening);
+  EXPECT_EQ(sim.listened_ms() - listened_before, sim.now - silent_from);
+  EXPECT_EQ(sim.window.get_misses(), RX_WINDOW_RELEARN_MISSES);
+
+  // First telegram after the silence is caught and re-arms the window
+  sim.run_telegrams(1);
+  sim.run_until(sim.now + 1000);
+  EXPECT_EQ(sim.captured(), 6u);
+  EXPECT_FALSE(sim.listening);
+
+  uint32_t hits_before = sim.window.get_hits();
+  sim.run_telegrams(10);
+  EXPECT_EQ(sim.window.get_hits() - hits_before, 10u);
+  EXPECT_EQ(sim.window.get_misses(), RX_WINDOW_RELEARN_MISSES);
+  EXPECT_EQ(sim.lost(), 0u);
+}
+
+TEST(RxWindow, SurveyFindsAMeterThatSendsMoreOften) {
+  RxWindowSim sim(16000);
+  sim.run_telegrams(10);
+
+  // Meter now sends every 8 s; every other telegram still lands in a window
+  sim.set_interval_ms(8000);
+  sim.run_until(RX_WINDOW_SURVEY_INTERVAL_MS - 1000);
+  EXPECT_EQ(sim.window.get_survey_count(), 0u);
+  EXPECT_EQ(sim.window.get_misses(), 0u);
+  EXPECT_GT(sim.lost(), 0u);
+  EXPECT_NEAR(sim.learned_interval_ms(), 16000, 100);
+
+  // The hourly survey listens through two intervals plus guard and sees
+  // two 8 s gaps in a row
+  sim.run_until(RX_WINDOW_SURVEY_INTERVAL_MS + 40000);
+  EXPECT_EQ(sim.window.get_survey_count(), 1u);
+  EXPECT_NEAR(sim.learned_interval_ms(), 8000, 100);
+
+  uint32_t lost_before = sim.lost();
+  sim.run_telegrams(50);
+  EXPECT_EQ(sim.lost(), lost_before);
+}
+
+TEST(RxWindow, SurveyKeepsTheRadioOnForTwoIntervals) {
+  RxWindowSim sim(16000);
+  sim.run_until(RX_WINDOW_SURVEY_INTERVAL_MS + 100);
+  EXPECT_EQ(sim.window.get_survey_count(), 1u);
+
+  // Listening throughout, not just in the regular window
+  uint32_t listened_before = sim.listened_ms();
+  uint32_t survey_from = sim.now;
+  sim.run_until(RX_WINDOW_SURVEY_INTERVAL_MS + 32000);
+  EXPECT_EQ(sim.listened_ms() - listened_before, sim.now - survey_from);
+
+  // Afterwards the radio is duty-cycled again
+  sim.run_until(RX_WINDOW_SURVEY_INTERVAL_MS + 600000);
+  EXPECT_EQ(sim.window.get_survey_count(), 1u);
+  EXPECT_LT(sim.listened_ms() - listened_before, 32500u + 600000u / 8);
+}
@@ -0,0 +1,100 @@
+#include "test_telegram.h"
+#include "wmbus_crypto.h"
+#include "wmbus_stream_decoder.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+struct Telegram {
+  uint8_t frame[MAX_PACKET_SIZE + 1];
+  size_t size;
+};
+
+Telegram make(bool long_frame) {
+  Telegram telegram{};
+  wmbus_host::TestReading reading;
+  reading.long_frame = long_frame;
+  telegram.size = wmbus_host::build_telegram(telegram.frame, wmbus_host::TEST_METER_ID, 42, reading);
+  return telegram;
+}
+
+/// Feed the telegram as the FIFO read would, chunk bytes at a time
+DecodeVerdict stream(Telegram &telegram, WMBusCrypto *crypto, size_t chunk) {
+  WMBusStreamDecoder decoder;
+  decoder.begin(telegram.frame);
+  decoder.set_crypto(crypto);
+  while (decoder.get_position() < telegram.size) {
+    size_t left = telegram.size - decoder.get_position();
+    decoder.feed(telegram.frame, static_cast<uint8_t>(left < chunk ? left : chunk));
+  }
+  return decoder.finish(telegram.frame);
+}
+
+constexpr size_t CHUNKS[] = {1, 2, 3, 7, 16, 32, MAX_PACKET_SIZE + 1};
+
+}  // namespace
+
+TEST(StreamDecoder, ChunkedFeedMatchesWholePacketDecode) {
+  for (bool long_frame : {false, true}) {
+    Telegram original = make(long_frame);
+    uint8_t length = original.frame[0];
+    ASSERT_EQ(WMBusCrypto::calculate_crc(original.frame, length - 1),
+              (original.frame[length - 1] << 8) | original.frame[length]);
+
+    WMBusCrypto reference;
+    reference.set_key(wmbus_host::TEST_KEY);
+    uint8_t plaintext[MAX_PACKET_SIZE];
+    uint8_t plaintext_length = 0;
+    ASSERT_TRUE(reference.decrypt_packet(original.frame, length, plaintext, plaintext_length));
+
+    for (size_t chunk : CHUNKS) {
+      SCOPED_TRACE(chunk);
+      Telegram telegram = original;
+      WMBusCrypto crypto;
+      crypto.set_key(wmbus_host::TEST_KEY);
+      EXPECT_EQ(stream(telegram, &crypto, chunk), DecodeVerdict::DECRYPTED);
+      // Header and CRC untouched, ciphertext replaced by the plaintext
+      EXPECT_EQ(memcmp(telegram.frame, original.frame, OFFSET_CIPHER_START), 0);
+      EXPECT_EQ(memcmp(&telegram.frame[OFFSET_CIPHER_START], plaintext, plaintext_length), 0);
+      EXPECT_EQ(memcmp(&telegram.frame[length - 1], &original.frame[length - 1], CRC_SIZE), 0);
+    }
+  }
+}
+
+TEST(StreamDecoder, WithoutAKeyOnlyTheCrcIsChecked) {
+  Telegram original = make(false);
+  for (size_t chunk : CHUNKS) {
+    SCOPED_TRACE(chunk);
+    Telegram telegram = original;
+    EXPECT_EQ(stream(telegram, nullptr, chunk), DecodeVerdict::CRC_OK);
+    EXPECT_EQ(memcmp(telegram.frame, original.frame, original.size), 0);
+  }
+}
+
+TEST(StreamDecoder, AnyCorruptedByteFailsTheCrc) {
+  Telegram original = make(true);
+  for (size_t i = 1; i < original.size; i++) {
+    SCOPED_TRACE(i);
+    Telegram telegram = original;
+    telegram.frame[i] ^= 0x10;
+    WMBusCrypto crypto;
+    crypto.set_key(wmbus_host::TEST_KEY);
+    EXPECT_EQ(stream(telegram, &crypto, 7), DecodeVerdict::CRC_FAILED);
+  }
+}
+
+TEST(StreamDecoder, IncompleteTelegramHasNoVerdict) {
+  Telegram telegram = make(false);
+  WMBusStreamDecoder decoder;
+  decoder.begin(telegram.frame);
+  decoder.feed(telegram.frame, static_cast<uint8_t>(telegram.size - 2));
+  EXPECT_EQ(decoder.finish(telegram.frame), DecodeVerdict::NONE);
+  EXPECT_FALSE(decoder.is_active());
+
+  decoder.begin(telegram.frame);
+  decoder.reset();
+  EXPECT_EQ(decoder.finish(telegram.frame), DecodeVerdict::NONE);
+}
@@ -0,0 +1,141 @@
+#include "crc_reference.h"
+#include "test_telegram.h"
+#include "three_of_six_reference.h"
+#include "wmbus_t1_decoder.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+
+using namespace esphome::multical21_wmbus;
+
+TEST(T1Decoder, KnownVectors) {
+  // Nibbles 1, 2, 3, 4 -> 001101 001110 001011 011100
+  const uint8_t pair_raw[3] = {0x34, 0xE2, 0xDC};
+  uint8_t out[2];
+  ASSERT_TRUE(WMBusT1Decoder::decode(pair_raw, out, 2));
+  EXPECT_EQ(out[0], 0x12);
+  EXPECT_EQ(out[1], 0x34);
+
+  // Odd count: A, B -> 100110 100011, then padding
+  const uint8_t single_raw[2] = {0x9A, 0x30};
+  ASSERT_TRUE(WMBusT1Decoder::decode(single_raw, out, 1));
+  EXPECT_EQ(out[0], 0xAB);
+
+  // 0, F -> 010110 101001
+  const uint8_t zero_f_raw[2] = {0x5A, 0x90};
+  ASSERT_TRUE(WMBusT1Decoder::decode(zero_f_raw, out, 1));
+  EXPECT_EQ(out[0], 0x0F);
+}
+
+TEST(T1Decoder, RejectsInvalidSymbols) {
+  uint8_t out[2];
+  const uint8_t all_zero[3] = {0x00, 0x00, 0x00};
+  EXPECT_FALSE(WMBusT1Decoder::decode(all_zero, out, 2));
+  // Valid first byte, second byte's low symbol has four ones (111100)
+  const uint8_t bad_low[3] = {0x34, 0xE2, 0xFC};
+  EXPECT_FALSE(WMBusT1Decoder::decode(bad_low, out, 2));
+}
+
+TEST(T1Decoder, TableMatchesBitSerialForEveryChipPattern) {
+  // Every 12-chip pattern as the last (odd) byte, so each table entry is hit
+  for (uint16_t chips = 0; chips < 4096; chips++) {
+    const uint8_t raw[2] = {static_cast<uint8_t>(chips >> 4), static_cast<uint8_t>((chips & 0x0F) << 4)};
+    uint8_t table_out = 0;
+    uint8_t reference_out = 0;
+    bool table_ok = WMBusT1Decoder::decode(raw, &table_out, 1);
+    bool reference_ok = wmbus_host::decode_3of6_bit_serial(raw, &reference_out, 1);
+    ASSERT_EQ(table_ok, reference_ok) << "chips 0x" << std::hex << chips;
+    if (table_ok) {
+      ASSERT_EQ(table_out, reference_out) << "chips 0x" << std::hex << chips;
+    }
+  }
+}
+
+TEST(T1Decoder, RoundTripsRandomData) {
+  std::mt19937 rng(6);
+  uint8_t data[255];
+  uint8_t raw[WMBusT1Decoder::encoded_size(sizeof(data))];
+  uint8_t table_out[sizeof(data)];
+  uint8_t reference_out[sizeof(data)];
+  for (int round = 0; round < 500; round++) {
+    uint16_t count = static_cast<uint16_t>(rng() % sizeof(data) + 1);
+    for (uint16_t i = 0; i < count; i++) {
+      data[i] = static_cast<uint8_t>(rng());
+    }
+    wmbus_host::encode_3of6(data, count, raw);
+    ASSERT_TRUE(WMBusT1Decoder::decode(raw, table_out, count));
+    ASSERT_TRUE(wmbus_host::decode_3of6_bit_serial(raw, reference_out, count));
+    ASSERT_EQ(memcmp(table_out, data, count), 0) << "count " << count;
+    ASSERT_EQ(memcmp(reference_out, data, count), 0) << "count " << count;
+  }
+}
+
+TEST(T1Decoder, FrameSizeCountsBlockCrcs) {
+  EXPECT_EQ(WMBusT1Decoder::frame_size(9), 12);       // First block only
+  EXPECT_EQ(WMBusT1Decoder::frame_size(10), 15);      // One byte in the second block
+  EXPECT_EQ(WMBusT1Decoder::frame_size(25), 30);      // Second block full
+  EXPECT_EQ(WMBusT1Decoder::frame_size(26), 33);      // Third block started
+  EXPECT_EQ(WMBusT1Decoder::encoded_size(2), 3);
+  EXPECT_EQ(WMBusT1Decoder::encoded_size(3), 5);
+}
+
+class T1FrameA : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // The C1 test telegram without its trailing CRC, as T1 data
+    wmbus_host::TestReading reading;
+    reading.long_frame = true;
+    uint8_t c1[MAX_PACKET_SIZE + 1];
+    wmbus_host::build_telegram(c1, wmbus_host::TEST_METER_ID, 0x21, reading);
+    this->l_field_ = static_cast<uint8_t>(c1[0] - CRC_SIZE);
+    memcpy(this->data_, c1, this->l_field_ + 1);
+    this->data_[0] = this->l_field_;
+    wmbus_host::build_frame_a(this->data_, this->frame_);
+  }
+
+  uint8_t l_field_;
+  uint8_t data_[MAX_PACKET_SIZE + 1];
+  uint8_t frame_[WMBusT1Decoder::frame_size(MAX_PACKET_SIZE)];
+};
+
+TEST_F(T1FrameA, RepacksIntoC1Layout) {
+  uint8_t packet[MAX_PACKET_SIZE + 1];
+  ASSERT_TRUE(WMBusT1Decoder::check_frame_a(this->frame_, packet, sizeof(packet)));
+
+  // [L+2][C]...[CRC CRC]: data unchanged, one CRC over everything before it
+  uint8_t length = packet[0];
+  EXPECT_EQ(length, this->l_field_ + CRC_SIZE);
+  EXPECT_EQ(memcmp(&packet[1], &this->data_[1], this->l_field_), 0);
+  uint16_t crc = (packet[length - 1] << 8) | packet[length];
+  EXPECT_EQ(wmbus_host::crc_bit_serial(packet, length - 1), crc);
+}
+
+TEST_F(T1FrameA, DecodesFromChips) {
+  uint16_t size = WMBusT1Decoder::frame_size(this->l_field_);
+  uint8_t raw[WMBusT1Decoder::encoded_size(sizeof(this->frame_))];
+  wmbus_host::encode_3of6(this->frame_, size, raw);
+  uint8_t decoded[sizeof(this->frame_)];
+  ASSERT_TRUE(WMBusT1Decoder::decode(raw, decoded, size));
+  EXPECT_EQ(memcmp(decoded, this->frame_, size), 0);
+  uint8_t packet[MAX_PACKET_SIZE + 1];
+  EXPECT_TRUE(WMBusT1Decoder::check_frame_a(decoded, packet, sizeof(packet)));
+}
+
+TEST_F(T1FrameA, RejectsCorruptBlocks) {
+  uint8_t packet[MAX_PACKET_SIZE + 1];
+  uint16_t size = WMBusT1Decoder::frame_size(this->l_field_);
+  for (uint16_t i = 1; i < size; i++) {
+    uint8_t frame[sizeof(this->frame_)];
+    memcpy(frame, this->frame_, size);
+    frame[i] ^= 0x01;
+    EXPECT_FALSE(WMBusT1Decoder::check_frame_a(frame, packet, sizeof(packet))) << "flipped byte " << i;
+  }
+}
+
+TEST_F(T1FrameA, RejectsShortAndOversizedTelegrams) {
+  uint8_t packet[MAX_PACKET_SIZE + 1];
+  EXPECT_FALSE(WMBusT1Decoder::check_frame_a(this->frame_, packet, this->l_field_ + 2));
+
+  uint8_t short_frame[16] = {8};
+  EXPECT_FALSE(WMBusT1Decoder::check_frame_a(short_frame, packet, sizeof(packet)));
+}
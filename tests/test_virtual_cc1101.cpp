@@ -0,0 +1,445 @@
+#include "cc1101_radio.h"
+#include "sim_platform.h"
+#include "virtual_cc1101.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace esphome::multical21_wmbus;
+using wmbus_host::SimClock;
+using wmbus_host::VirtualCC1101;
+
+namespace {
+
+constexpr uint8_t PARTNUM = 0x30;
+constexpr uint8_t VERSION = 0x31;
+constexpr uint8_t LENGTH_FIXED = 0x00;
+constexpr uint8_t LENGTH_VARIABLE = 0x01;
+constexpr uint8_t LENGTH_INFINITE = 0x02;
+constexpr uint8_t GDO_SYNC_TO_END = 0x06;
+constexpr uint8_t GDO_HIGH_IMPEDANCE = 0x2E;
+
+/**
+ * The simulated chip on its own clock, driven over CC1101Bus the way
+ * CC1101Radio drives it (SPI bytes take no time here)
+ */
+class VirtualCC1101Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    this->clock.set_source(&this->radio);
+    this->radio.set_gdo_callback([this](uint8_t gdo, bool level) { this->edges.push_back({gdo, level}); });
+  }
+
+  void strobe(uint8_t strobe) {
+    this->radio.cc1101_select();
+    this->radio.cc1101_write_byte(strobe);
+    this->radio.cc1101_deselect();
+  }
+
+  void write(uint8_t reg, uint8_t value) {
+    this->radio.cc1101_select();
+    this->radio.cc1101_write_byte(reg);
+    this->radio.cc1101_write_byte(value);
+    this->radio.cc1101_deselect();
+  }
+
+  void write_burst(uint8_t reg, const uint8_t *values, size_t count) {
+    this->radio.cc1101_select();
+    this->radio.cc1101_write_byte(reg | CC1101_WRITE_BURST);
+    this->radio.cc1101_write_array(values, count);
+    this->radio.cc1101_deselect();
+  }
+
+  uint8_t read(uint8_t reg) {
+    this->radio.cc1101_select();
+    this->radio.cc1101_write_byte(reg | CC1101_READ_SINGLE);
+    uint8_t value = this->radio.cc1101_read_byte();
+    this->radio.cc1101_deselect();
+    return value;
+  }
+
+  void read_burst(uint8_t reg, uint8_t *values, size_t count) {
+    this->radio.cc1101_select();
+    this->radio.cc1101_write_byte(reg | CC1101_READ_BURST);
+    this->radio.cc1101_read_array(values, count);
+    this->radio.cc1101_deselect();
+  }
+
+  uint8_t status(uint8_t reg) {
+    uint8_t value;
+    this->read_burst(reg, &value, 1);
+    return value;
+  }
+
+  void advance_us(uint64_t us) { this->clock.advance_by(us * 1000); }
+
+  /// GDO functions as the component's default profile has them, receiver in RX
+  void enter_rx(uint8_t pktctrl0, uint8_t mcsm1 = 0x00) {
+    write(CC1101_IOCFG2, GDO_HIGH_IMPEDANCE);
+    write(CC1101_IOCFG0, GDO_SYNC_TO_END);
+    write(CC1101_PKTCTRL0, pktctrl0);
+    write(CC1101_MCSM1, mcsm1);
+    strobe(CC1101_SRX);
+    advance_us(1000);
+    ASSERT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RX);
+    this->edges.clear();
+  }
+
+  /// Frame whose sync word ends in `in_us`, payload bytes counting up from 1
+  uint64_t transmit_in(uint64_t in_us, size_t length) {
+    std::vector<uint8_t> bytes(length);
+    for (size_t i = 0; i < length; i++) {
+      bytes[i] = static_cast<uint8_t>(i + 1);
+    }
+    uint64_t sync_end_ns = this->clock.now_ns() + in_us * 1000;
+    this->radio.transmit(sync_end_ns, bytes.data(), static_cast<uint16_t>(length), -60);
+    return sync_end_ns;
+  }
+
+  struct Edge {
+    uint8_t gdo;
+    bool level;
+  };
+
+  SimClock clock;
+  VirtualCC1101 radio{clock};
+  std::vector<Edge> edges;
+};
+
+/**
+ * CC1101Radio driving the simulated chip on the platform clock its
+ * micros()/delay() calls run on. reboot() starts a new driver on the same
+ * chip, as an ESP32 reboot does (the chip keeps power and registers).
+ */
+class RadioOnVirtualChipTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    wmbus_host::sim_reset();
+    wmbus_host::sim_clock().set_source(&this->chip);
+    this->reboot();
+  }
+
+  void TearDown() override { wmbus_host::sim_clock().set_source(nullptr); }
+
+  void reboot() {
+    this->radio = std::make_unique<CC1101Radio>();
+    this->radio->init(&this->chip);
+  }
+
+  /// Tick the radio as loop() would until it is receiving
+  bool run_until_rx(uint32_t limit_ms = 200) {
+    for (uint32_t us = 0; us < limit_ms * 1000 && !this->radio->is_receiving(); us += 100) {
+      wmbus_host::sim_clock().advance_by(100000);
+      this->radio->tick();
+    }
+    return this->radio->is_receiving();
+  }
+
+  uint32_t resets() const { return this->chip.get_strobe_count(CC1101_SRES); }
+
+  VirtualCC1101 chip{wmbus_host::sim_clock()};
+  std::unique_ptr<CC1101Radio> radio;
+};
+
+}  // namespace
+
+TEST_F(VirtualCC1101Test, ResetValuesAndBurstAccess) {
+  uint8_t registers[CC1101_CONFIG_REGISTER_COUNT];
+  read_burst(0x00, registers, sizeof(registers));
+  EXPECT_EQ(registers[CC1101_IOCFG2], 0x29);
+  EXPECT_EQ(registers[CC1101_IOCFG0], 0x3F);
+  EXPECT_EQ(registers[CC1101_FIFOTHR], 0x07);
+  EXPECT_EQ(registers[CC1101_PKTCTRL0], 0x45);
+  EXPECT_EQ(registers[CC1101_TEST2 + 2], 0x0B);
+  EXPECT_EQ(status(PARTNUM), 0x00);
+  EXPECT_EQ(status(VERSION), 0x14);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+
+  const uint8_t iocfg[3] = {0x2E, 0x2E, 0x06};
+  write_burst(CC1101_IOCFG2, iocfg, sizeof(iocfg));
+  EXPECT_EQ(read(CC1101_IOCFG2), 0x2E);
+  EXPECT_EQ(read(CC1101_IOCFG0), 0x06);
+
+  // SRES puts every register back, and the chip ignores SPI until it is done
+  strobe(CC1101_SRES);
+  write(CC1101_IOCFG0, 0x06);
+  EXPECT_EQ(read(CC1101_IOCFG0), 0xFF);
+  advance_us(VirtualCC1101::RESET_BUSY_NS / 1000);
+  EXPECT_EQ(read(CC1101_IOCFG0), 0x3F);
+}
+
+TEST_F(VirtualCC1101Test, RxEntryTakesCalibrationOrSettlingTime) {
+  write(CC1101_MCSM0, 0x18);  // Calibrate on IDLE -> RX
+  strobe(CC1101_SRX);
+  EXPECT_EQ(status(CC1101_MARCSTATE), VirtualCC1101::MARCSTATE_STARTCAL);
+  advance_us(798);
+  EXPECT_NE(status(CC1101_MARCSTATE), MARCSTATE_RX);
+  advance_us(2);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RX);
+  EXPECT_EQ(read(CC1101_FSCAL3) & 0x0F, 0x09);
+
+  strobe(CC1101_SIDLE);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+  write(CC1101_MCSM0, 0x08);  // Cached calibration: no FS_AUTOCAL
+  strobe(CC1101_SRX);
+  EXPECT_EQ(status(CC1101_MARCSTATE), VirtualCC1101::MARCSTATE_FS_LOCK);
+  advance_us(89);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RX);
+
+  strobe(CC1101_SIDLE);
+  strobe(CC1101_SCAL);
+  advance_us(700);
+  EXPECT_EQ(status(CC1101_MARCSTATE), VirtualCC1101::MARCSTATE_STARTCAL);
+  advance_us(12);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+}
+
+TEST_F(VirtualCC1101Test, FlushIsOnlyTakenInIdleOrOverflow) {
+  enter_rx(LENGTH_INFINITE);
+  transmit_in(500, 20);
+  advance_us(500 + 10 * 80);
+  uint8_t count = status(CC1101_RXBYTES);
+  EXPECT_GT(count, 0);
+
+  strobe(CC1101_SFRX);
+  EXPECT_EQ(radio.get_ignored_strobe_count(), 1u);
+  EXPECT_GE(status(CC1101_RXBYTES), count);
+
+  strobe(CC1101_SIDLE);
+  EXPECT_GT(status(CC1101_RXBYTES), 0);  // SIDLE keeps the FIFO
+  strobe(CC1101_SFRX);
+  EXPECT_EQ(status(CC1101_RXBYTES), 0);
+}
+
+TEST_F(VirtualCC1101Test, OverflowSetsTheRxbytesBitAndEndsThePacket) {
+  enter_rx(LENGTH_INFINITE);
+  transmit_in(500, 40);
+  advance_us(500);
+  ASSERT_EQ(edges.size(), 1u);
+  EXPECT_TRUE(edges[0].level);  // GDO0 (0x06) rises at sync
+
+  // Infinite length: noise after the frame until the FIFO is full
+  advance_us(64 * 80);
+  EXPECT_EQ(status(CC1101_RXBYTES), 64);
+  advance_us(80);
+  EXPECT_EQ(status(CC1101_RXBYTES), 0x80 | 64);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RXFIFO_OVERFLOW);
+  EXPECT_EQ(radio.get_overflow_count(), 1u);
+  ASSERT_EQ(edges.size(), 2u);
+  EXPECT_EQ(edges[1].gdo, 0);
+  EXPECT_FALSE(edges[1].level);  // ... and falls on overflow
+
+  uint8_t fifo[64];
+  read_burst(CC1101_RXFIFO, fifo, sizeof(fifo));
+  EXPECT_EQ(fifo[0], 1);
+  EXPECT_EQ(fifo[39], 40);
+  strobe(CC1101_SFRX);
+  EXPECT_EQ(status(CC1101_RXBYTES), 0);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+}
+
+TEST_F(VirtualCC1101Test, ReadingTheFifoEmptyMidPacketDuplicatesTheLastByte) {
+  enter_rx(LENGTH_INFINITE);
+  transmit_in(500, 40);
+  advance_us(500 + 4 * 80);
+  uint8_t fifo[5];
+  read_burst(CC1101_RXFIFO, fifo, sizeof(fifo));
+  EXPECT_EQ(fifo[3], 4);
+  EXPECT_EQ(fifo[4], 4);  // Read empty: the last byte again
+  EXPECT_EQ(radio.get_errata_duplicate_count(), 2u);
+  EXPECT_EQ(status(CC1101_RXBYTES), 1);
+
+  radio.set_errata(false);
+  advance_us(80);
+  read_burst(CC1101_RXFIFO, fifo, 2);
+  EXPECT_EQ(fifo[0], 4);
+  EXPECT_EQ(fifo[1], 5);
+  EXPECT_EQ(status(CC1101_RXBYTES), 0);
+}
+
+TEST_F(VirtualCC1101Test, VariableLengthAppendsStatusAndFollowsRxoff) {
+  write(CC1101_PKTCTRL1, PKTCTRL1_APPEND_STATUS);
+  enter_rx(LENGTH_VARIABLE);
+  const uint8_t frame[6] = {5, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+  radio.transmit(clock.now_ns() + 500000, frame, sizeof(frame), -60);
+  advance_us(500 + 6 * 80);
+  ASSERT_EQ(status(CC1101_RXBYTES), 8);
+  uint8_t fifo[8];
+  read_burst(CC1101_RXFIFO, fifo, sizeof(fifo));
+  EXPECT_EQ(fifo[5], 0xA5);
+  EXPECT_EQ(static_cast<int8_t>(fifo[6]), (-60 + 74) * 2);  // RSSI at sync
+  EXPECT_TRUE(fifo[7] & LQI_CRC_OK);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);  // RXOFF_MODE: IDLE
+
+  strobe(CC1101_SFRX);
+  enter_rx(LENGTH_VARIABLE, MCSM1_RXOFF_STAY_IN_RX);
+  radio.transmit(clock.now_ns() + 500000, frame, sizeof(frame), -60);
+  advance_us(500 + 6 * 80);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RX);
+}
+
+TEST_F(VirtualCC1101Test, FixedLengthWrittenMidPacketEndsIt) {
+  enter_rx(LENGTH_INFINITE);
+  transmit_in(500, 40);
+  advance_us(500 + 10 * 80);
+  const uint8_t length[3] = {20, 0x00, LENGTH_FIXED};
+  write_burst(CC1101_PKTLEN, length, sizeof(length));
+  advance_us(9 * 80);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_RX);
+  advance_us(80);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+  EXPECT_EQ(status(CC1101_RXBYTES), 20);
+  EXPECT_FALSE(radio.get_gdo_level(0));
+}
+
+TEST_F(VirtualCC1101Test, ThresholdSignalsFollowTheFifo) {
+  enter_rx(LENGTH_INFINITE);
+  write(CC1101_FIFOTHR, FIFOTHR_RX_32_BYTES);
+  write(CC1101_IOCFG2, 0x00);  // Threshold
+  write(CC1101_IOCFG0, 0x41);  // Threshold or end of packet, inverted
+  edges.clear();
+  transmit_in(500, 60);
+  advance_us(500 + 31 * 80);
+  EXPECT_TRUE(edges.empty());
+  advance_us(80);
+  ASSERT_EQ(edges.size(), 2u);
+  EXPECT_FALSE(radio.get_gdo_level(0));
+  EXPECT_TRUE(radio.get_gdo_level(2));
+
+  // Below the threshold GDO2 drops, but 0x01 holds until the FIFO is empty
+  uint8_t fifo[31];
+  read_burst(CC1101_RXFIFO, fifo, 8);
+  EXPECT_FALSE(radio.get_gdo_level(2));
+  EXPECT_FALSE(radio.get_gdo_level(0));
+  radio.set_errata(false);
+  read_burst(CC1101_RXFIFO, fifo, 24);
+  EXPECT_TRUE(radio.get_gdo_level(0));
+}
+
+TEST_F(VirtualCC1101Test, ClockOutputRunsUntilIocfgIsRewritten) {
+  // Power-on and after SRES: GDO0 is CLK_XOSC/192
+  advance_us(100);
+  uint32_t edges_per_100_us = radio.get_clock_edge_count();
+  EXPECT_GE(edges_per_100_us, 26u);
+  EXPECT_LE(edges_per_100_us, 28u);
+
+  write(CC1101_IOCFG0, GDO_SYNC_TO_END);
+  advance_us(100);
+  EXPECT_EQ(radio.get_clock_edge_count(), edges_per_100_us);
+
+  strobe(CC1101_SRES);
+  advance_us(10);
+  EXPECT_GT(radio.get_clock_edge_count(), edges_per_100_us);
+}
+
+TEST_F(VirtualCC1101Test, SyncTooSoonAfterRxEntryIsMissed) {
+  enter_rx(LENGTH_INFINITE);
+  strobe(CC1101_SIDLE);
+  strobe(CC1101_SRX);
+  // In RX 88.4 us from now, but the sync word ends too soon after that
+  transmit_in(150, 40);
+  advance_us(2000);
+  EXPECT_EQ(radio.get_late_rx_count(), 1u);
+  EXPECT_EQ(radio.get_sync_count(), 0u);
+
+  // Sync words while not in RX are missed
+  strobe(CC1101_SIDLE);
+  transmit_in(100, 40);
+  advance_us(500);
+  strobe(CC1101_SRX);
+  advance_us(1000);
+  EXPECT_EQ(radio.get_missed_count(), 1u);
+  EXPECT_EQ(radio.get_sync_count(), 0u);
+}
+
+TEST_F(VirtualCC1101Test, SleepLosesTestRegistersAndWakesOnSelect) {
+  write(CC1101_TEST2, 0x81);
+  strobe(CC1101_SPWD);
+  EXPECT_EQ(radio.get_marcstate(), VirtualCC1101::MARCSTATE_SLEEP);
+  EXPECT_EQ(radio.get_register(CC1101_TEST2), 0x88);
+
+  // CSn low starts the crystal; nothing is answered until it has settled
+  radio.cc1101_select();
+  radio.cc1101_deselect();
+  advance_us(100);
+  EXPECT_EQ(radio.get_marcstate(), VirtualCC1101::MARCSTATE_SLEEP);
+  advance_us(50);
+  EXPECT_EQ(status(CC1101_MARCSTATE), MARCSTATE_IDLE);
+}
+
+TEST_F(RadioOnVirtualChipTest, ProfileHashMissConfiguresFromScratch) {
+  // Power-on register values: no profile
+  EXPECT_FALSE(radio->begin());
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_FALSE(radio->is_fast_boot());
+  EXPECT_EQ(resets(), 1u);
+  EXPECT_EQ(radio->get_last_recovery_kind(), RecoveryKind::COLD);
+  EXPECT_TRUE(radio->has_calibration_cache());
+  EXPECT_NE(chip.get_register(CC1101_IOCFG0), 0x3F);
+}
+
+TEST_F(RadioOnVirtualChipTest, ProfileHashHitSkipsTheReset) {
+  radio->begin();
+  ASSERT_TRUE(run_until_rx());
+  uint8_t fscal1 = chip.get_register(CC1101_FSCAL1);
+
+  // Reboot with the chip configured: calibration results differ from the
+  // profile's start values and the calibration registers are masked out
+  // of the hash, so this is a hit
+  chip.upset_register(CC1101_FSCAL1, fscal1 ^ 0x05);
+  reboot();
+  EXPECT_TRUE(radio->begin());
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_TRUE(radio->is_fast_boot());
+  EXPECT_EQ(resets(), 1u);
+  EXPECT_TRUE(radio->has_calibration_cache());
+
+  // Any other register changed: configured from scratch again
+  chip.upset_register(CC1101_FREQ0, chip.get_register(CC1101_FREQ0) ^ 0x01);
+  reboot();
+  EXPECT_FALSE(radio->begin());
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_FALSE(radio->is_fast_boot());
+  EXPECT_EQ(resets(), 2u);
+}
+
+TEST_F(RadioOnVirtualChipTest, CorruptedRegisterIsRestoredWarm) {
+  radio->begin();
+  ASSERT_TRUE(run_until_rx());
+  uint8_t freq0 = chip.get_register(CC1101_FREQ0);
+  EXPECT_TRUE(radio->verify_registers());
+
+  chip.upset_register(CC1101_FREQ0, freq0 ^ 0x01);
+  EXPECT_FALSE(radio->verify_registers());
+  EXPECT_EQ(radio->get_register_mismatch_count(), 1u);
+  radio->recover();
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_EQ(radio->get_last_recovery_kind(), RecoveryKind::WARM);
+  EXPECT_EQ(radio->get_warm_recovery_count(), 1u);
+  EXPECT_EQ(resets(), 1u);
+  EXPECT_EQ(chip.get_register(CC1101_FREQ0), freq0);
+
+  // Auto-calibration is back on after the warm restart's first IDLE
+  radio->start_rx();
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_TRUE(radio->verify_registers());
+}
+
+TEST_F(RadioOnVirtualChipTest, WarmRestartVerifyMismatchFallsBackToAReset) {
+  radio->begin();
+  ASSERT_TRUE(run_until_rx());
+  uint8_t freq0 = chip.get_register(CC1101_FREQ0);
+
+  // The warm restart's profile write does not reach FREQ0, so its read-back
+  // does not match and the radio is reset and configured from scratch
+  chip.upset_register(CC1101_FREQ0, freq0 ^ 0x01);
+  chip.drop_writes(CC1101_FREQ0, 1);
+  radio->recover();
+  ASSERT_TRUE(run_until_rx());
+  EXPECT_EQ(radio->get_verify_failure_count(), 1u);
+  EXPECT_EQ(radio->get_warm_recovery_count(), 0u);
+  EXPECT_EQ(radio->get_last_recovery_kind(), RecoveryKind::COLD);
+  EXPECT_EQ(resets(), 2u);
+  EXPECT_EQ(chip.get_register(CC1101_FREQ0), freq0);
+  EXPECT_TRUE(radio->verify_registers());
+}
@@ -0,0 +1,140 @@
+#include "wmbus_watchdog.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+constexpr uint32_t TICK_MS = HEALTH_CHECK_INTERVAL_MS;
+constexpr uint32_t START_MS = 5000;
+
+/// Times (ms since START_MS) at which check() asked for action on a silent radio
+std::vector<uint32_t> silent_actions(WMBusWatchdog &watchdog, WatchdogAction action, uint32_t duration_ms) {
+  std::vector<uint32_t> at;
+  for (uint32_t t = TICK_MS; t <= duration_ms; t += TICK_MS) {
+    if (watchdog.check(START_MS + t) == action) {
+      at.push_back(t);
+    }
+  }
+  return at;
+}
+
+}  // namespace
+
+TEST(Watchdog, SilenceWindowFollowsTheIntervalWithinLimits) {
+  WMBusWatchdog watchdog;
+  EXPECT_EQ(watchdog.get_silence_window_ms(), WATCHDOG_DEFAULT_SILENCE_MS);
+
+  watchdog.set_expected_interval(16000);
+  EXPECT_EQ(watchdog.get_silence_window_ms(), 16000u * WATCHDOG_SILENCE_FACTOR);
+
+  // A fast meter does not shorten the window below one supervision tick
+  watchdog.set_expected_interval(1000);
+  EXPECT_EQ(watchdog.get_silence_window_ms(), WATCHDOG_MIN_SILENCE_MS);
+
+  // A slow one does not stretch it beyond the fixed receive timeout
+  watchdog.set_expected_interval(60000);
+  EXPECT_EQ(watchdog.get_silence_window_ms(), WATCHDOG_DEFAULT_SILENCE_MS);
+  EXPECT_EQ(WATCHDOG_DEFAULT_SILENCE_MS * WATCHDOG_RECOVER_FACTOR, RECEIVE_TIMEOUT_MS);
+
+  // Forgetting the interval goes back to the default
+  watchdog.set_expected_interval(16000);
+  watchdog.set_expected_interval(0);
+  EXPECT_EQ(watchdog.get_silence_window_ms(), WATCHDOG_DEFAULT_SILENCE_MS);
+}
+
+TEST(Watchdog, QuietWhileTelegramsArrive) {
+  WMBusWatchdog watchdog;
+  watchdog.start(START_MS);
+  watchdog.set_expected_interval(16000);
+  uint32_t next_telegram_ms = START_MS + 16000;
+  for (uint32_t now = START_MS + TICK_MS; now < START_MS + 3600000; now += TICK_MS) {
+    while (next_telegram_ms <= now) {
+      watchdog.feed(next_telegram_ms);
+      next_telegram_ms += 16000;
+    }
+    EXPECT_EQ(watchdog.check(now), WatchdogAction::NONE) << now;
+  }
+  EXPECT_EQ(watchdog.get_probe_count(), 0u);
+  EXPECT_EQ(watchdog.get_recovery_count(), 0u);
+}
+
+TEST(Watchdog, ProbesOncePerWindowThenRecovers) {
+  WMBusWatchdog watchdog;
+  watchdog.start(START_MS);
+  watchdog.set_expected_interval(16000);  // 48 s window, recovery after 192 s
+
+  std::vector<uint32_t> probes;
+  std::vector<uint32_t> recoveries;
+  for (uint32_t t = TICK_MS; t <= 200000; t += TICK_MS) {
+    WatchdogAction action = watchdog.check(START_MS + t);
+    if (action == WatchdogAction::PROBE) {
+      probes.push_back(t);
+    } else if (action == WatchdogAction::RECOVER) {
+      recoveries.push_back(t);
+    }
+  }
+  // Ticks are 10 s apart, so each fires on the first tick past its threshold
+  EXPECT_EQ(probes, (std::vector<uint32_t>{50000, 100000, 150000}));
+  EXPECT_EQ(recoveries, (std::vector<uint32_t>{200000}));
+  EXPECT_EQ(watchdog.get_consecutive_recoveries(), 1u);
+  EXPECT_EQ(watchdog.get_quiet_ms(START_MS + 200000), 0u);
+}
+
+TEST(Watchdog, FruitlessRecoveriesBackOffUntilATelegramArrives) {
+  WMBusWatchdog watchdog;
+  watchdog.start(START_MS);
+  watchdog.set_expected_interval(1000);  // Minimum window: 10 s, recovery after 40 s
+
+  // 40 s, then 80, 160 and 320 s after each previous one; capped from then on
+  std::vector<uint32_t> recoveries = silent_actions(watchdog, WatchdogAction::RECOVER, 1600000);
+  std::vector<uint32_t> expected = {40000, 120000, 280000, 600000, 920000, 1240000, 1560000};
+  EXPECT_EQ(recoveries, expected);
+  EXPECT_EQ(watchdog.get_consecutive_recoveries(), WATCHDOG_MAX_BACKOFF);
+
+  // One telegram resets the backoff
+  watchdog.feed(START_MS + 1600000);
+  EXPECT_EQ(watchdog.get_consecutive_recoveries(), 0u);
+  bool recovered = false;
+  for (uint32_t t = 1600000 + TICK_MS; t <= 1640000; t += TICK_MS) {
+    recovered = watchdog.check(START_MS + t) == WatchdogAction::RECOVER;
+  }
+  EXPECT_TRUE(recovered);  // 40 s again, not 320 s
+}
+
+TEST(Watchdog, CountsTheStatusReadsItSkipped) {
+  WMBusWatchdog watchdog;
+  watchdog.start(START_MS);
+  watchdog.set_expected_interval(16000);
+  EXPECT_EQ(watchdog.get_spi_transactions_saved_per_hour(START_MS), 0.0f);
+
+  // One hour of 10 s ticks with a telegram every 16 s: every tick skipped
+  uint32_t next_telegram_ms = START_MS + 16000;
+  uint32_t ticks = 0;
+  for (uint32_t now = START_MS + TICK_MS; now <= START_MS + 3600000; now += TICK_MS) {
+    while (next_telegram_ms <= now) {
+      watchdog.feed(next_telegram_ms);
+      next_telegram_ms += 16000;
+    }
+    watchdog.check(now);
+    ticks++;
+  }
+  EXPECT_EQ(ticks, 360u);
+  EXPECT_EQ(watchdog.get_spi_transactions_saved(), ticks * WMBusWatchdog::SPI_TRANSACTIONS_PER_PROBE);
+  EXPECT_FLOAT_EQ(watchdog.get_spi_transactions_saved_per_hour(START_MS + 3600000),
+                  ticks * WMBusWatchdog::SPI_TRANSACTIONS_PER_PROBE);
+
+  // Probes and recoveries are not savings
+  uint32_t saved = watchdog.get_spi_transactions_saved();
+  uint32_t now = START_MS + 3600000;
+  std::vector<uint32_t> acted;
+  for (uint32_t t = TICK_MS; t <= 200000; t += TICK_MS) {
+    if (watchdog.check(now + t) != WatchdogAction::NONE) {
+      acted.push_back(t);
+    }
+  }
+  EXPECT_EQ(acted.size(), 4u);  // Three probes and the recovery
+  uint32_t skipped = 200000 / TICK_MS - static_cast<uint32_t>(acted.size());
+  EXPECT_EQ(watchdog.get_spi_transactions_saved() - saved, skipped * WMBusWatchdog::SPI_TRANSACTIONS_PER_PROBE);
+}
@@ -0,0 +1,86 @@
+#include "alloc_counter.h"
+#include "test_telegram.h"
+#include "wmbus_crypto.h"
+#include "wmbus_packet_buffer.h"
+#include "wmbus_packet_parser.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace esphome::multical21_wmbus;
+
+namespace {
+
+// Receive path of loop() for one telegram, minus the sensors: ring hand-over,
+// CRC, decryption (precomputed keystream or full CTR), parsing, status text
+bool process(WMBusPacketBuffer<> &ring, WMBusCrypto &crypto, WMBusPacketParser &parser, const uint8_t *frame,
+             size_t size) {
+  PacketBuffer *slot = ring.reserve();
+  if (slot == nullptr) {
+    return false;
+  }
+  memcpy(slot->data, frame, size);
+  ring.commit(static_cast<uint16_t>(size), 0);
+
+  const PacketBuffer *packet = ring.peek();
+  uint8_t length = packet->data[0];
+  uint16_t crc = (packet->data[length - 1] << 8) | packet->data[length];
+  bool ok = WMBusCrypto::calculate_crc(packet->data, length - 1) == crc;
+  uint8_t plaintext[MAX_PACKET_SIZE];
+  uint8_t plaintext_length = 0;
+  ok = ok && crypto.decrypt_packet(packet->data, length, plaintext, plaintext_length);
+  WMBusMeterData data = parser.parse(plaintext, plaintext_length);
+  ok = ok && data.valid;
+  char status[WMBusPacketParser::STATUS_STRING_SIZE];
+  WMBusPacketParser::format_status(data.info_codes, status);
+  crypto.predict_next(packet->data);
+  crypto.precompute_keystream();
+  ring.release();
+  return ok;
+}
+
+}  // namespace
+
+TEST(ZeroAlloc, TelegramPathDoesNotTouchTheHeap) {
+  WMBusPacketBuffer<> ring;
+  WMBusCrypto crypto;
+  crypto.set_key(wmbus_host::TEST_KEY);
+  WMBusPacketParser parser;
+
+  // Compact and long frames, every info code the parser names plus an
+  // unknown one, consecutive access numbers (keystream hits) and jumps (misses)
+  uint8_t frames[8][MAX_PACKET_SIZE + 1];
+  size_t sizes[8];
+  const uint8_t info_codes[8] = {0x00, 0x01, 0x02, 0x04, 0x08, 0x05, 0x00, 0x00};
+  for (int i = 0; i < 8; i++) {
+    wmbus_host::TestReading reading;
+    reading.long_frame = i % 2 == 1;
+    reading.info_codes = info_codes[i];
+    uint8_t access_number = static_cast<uint8_t>(i < 6 ? i : 40 + 10 * i);
+    sizes[i] = wmbus_host::build_telegram(frames[i], wmbus_host::TEST_METER_ID, access_number, reading);
+  }
+
+  // Warm-up pass, so one-time initialisation is not counted
+  ASSERT_TRUE(process(ring, crypto, parser, frames[0], sizes[0]));
+
+  uint64_t before = wmbus_host::allocation_count();
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 8; i++) {
+      ASSERT_TRUE(process(ring, crypto, parser, frames[i], sizes[i]));
+    }
+  }
+  uint64_t allocations = wmbus_host::allocation_count() - before;
+
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_GT(crypto.get_keystream_hits(), 0u);
+  EXPECT_GT(crypto.get_keystream_misses(), 0u);
+}
+
+TEST(ZeroAlloc, CounterSeesAllocations) {
+  // Guards against the counter not being linked in, which would make the
+  // test above pass vacuously
+  static int *volatile value;  // Keeps the compiler from eliding the pair
+  uint64_t before = wmbus_host::allocation_count();
+  value = new int(1);
+  delete value;
+  EXPECT_EQ(wmbus_host::allocation_count() - before, 1u);
+}